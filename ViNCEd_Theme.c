@@ -7,13 +7,17 @@
  *
  * Compatible with Workbench 2.x/3.x systems using AmigaDOS conventions.
  *
- * Template: THEMEFILE,USE/S,SAVE/S,RESET/S,CHECK/S,LOAD/S,NOLOAD/S,ANSI/S,NOANSI/S
+ * Template: THEMEFILE,USE/S,SAVE/S,RESET/S,CHECK/S,LOAD/S,NOLOAD/S,ANSI/S,NOANSI/S,
+ *           VIEW/S,THEMES/M,TODIR/K,NOCACHE/S,FORCE/S,STATS/S,DIFF/S,LIVE/S,
+ *           INDEX/K,THEMEDIR/K,METRIC/K
  *
  * Input format support:
  *   - 16-bit hex (0x1234) - passed through as-is
  *   - 8-bit hex (0x12) - converted to 16-bit (0x1212)
  *   - Integer 0-255 - converted to 16-bit hex
- *   - Float 0.0-1.0 - converted to 16-bit hex
+ *   - Decimal 0.0-1.0 - rounded exactly to 16-bit hex
+ *   - Percentage 0%-100% - rounded exactly to 16-bit hex
+ *   - Whole color #RRGGBB or 12-bit 0xRGB in place of r,g,b
  *
  * Parsing logic:
  *   1. Find first CURSORCOLOR= line (ignoring leading whitespace)
@@ -31,33 +35,73 @@
 #include <exec/memory.h>
 #include <dos/dos.h>
 #include <dos/rdargs.h>
+#include <dos/dosasl.h>
+#include <devices/timer.h>
 #include <clib/exec_protos.h>
 #include <clib/dos_protos.h>
+#include <clib/timer_protos.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include "amiga_color_window.h"
+#include "theme_stats.h"
+#ifdef HOST_MMAP
+#include "host_shim.h"            /* host_map_file, see host/Makefile */
+#endif
 
 /* Program information */
 #define PROG_NAME "ViNCEd_Theme"
 #define PROG_VERSION "1.2"
 #define PROG_DATE "23.6.2025"
 
-/* AmigaDOS version string for 'version' command */
-static char version[] = "\0$VER: " PROG_NAME " " PROG_VERSION " (" PROG_DATE ") ViNCEd Theme Manager";
+/* AmigaDOS version string for 'version' command, global so it is kept */
+char version[] = "\0$VER: " PROG_NAME " " PROG_VERSION " (" PROG_DATE ") ViNCEd Theme Manager";
 
 /* ReadArgs template */
-#define TEMPLATE "THEMEFILE,USE/S,SAVE/S,RESET/S,CHECK/S,LOAD/S,NOLOAD/S,ANSI/S,NOANSI/S,VIEW/S"
+#define TEMPLATE "THEMEFILE,USE/S,SAVE/S,RESET/S,CHECK/S,LOAD/S,NOLOAD/S,ANSI/S,NOANSI/S,VIEW/S,THEMES/M,TODIR/K,NOCACHE/S,FORCE/S,STATS/S,DIFF/S,LIVE/S,INDEX/K,THEMEDIR/K,METRIC/K"
 
-/* Maximum line length for preference files */
-#define MAX_LINE_LENGTH 512
 /* Maximum number of color entries we expect (CURSORCOLOR + 16 COLOR lines) */
 #define MAX_COLOR_ENTRIES 17
 /* Required number of COLOR lines (excluding CURSORCOLOR) */
 #define REQUIRED_COLOR_LINES 16
 /* Buffer size for file operations */
 #define BUFFER_SIZE 8192
+/* Size of a canonical color line: CURSORCOLOR=NOLOAD,NOANSI,0x0000,0x0000,0x0000 */
+#define CANONICAL_LINE_SIZE 48
+/* Maximum number of comma separated values after COLOR= */
+#define MAX_COLOR_FIELDS 10
+/* Buffer size for paths expanded from patterns */
+#define MAX_PATH_LENGTH 256
+#define MAX_PREFS_TARGETS 2       /* ENV: and ENVARC: */
+
+/* update_prefs_files flags */
+#define UPDATE_FORCE 0x01         /* Write even if the file holds the colors */
+#define UPDATE_DIFF 0x02          /* Show the entries that change first */
+#define UPDATE_DRY_RUN 0x04       /* Do not write anything */
+
+/* Longest live sequence: ESC ] 4 ; nn ; rgb:xxxx/xxxx/xxxx BEL */
+#define LIVE_SEQUENCE_SIZE 32
+#define LIVE_BUFFER_SIZE (MAX_COLOR_ENTRIES * LIVE_SEQUENCE_SIZE)
+
+/* Compiled theme cache identification ("VTC" + version) */
+#define CACHE_MAGIC 0x56544301
+#define CACHE_VERSION 1
+/* Suffix appended to a theme file name for its compiled cache */
+#define CACHE_SUFFIX ".vtc"
+
+/* load_theme cache flags */
+#define CACHE_READ 0x01           /* Use a current compiled cache or index */
+#define CACHE_WRITE 0x02          /* Rebuild a missing or stale compiled cache */
+
+/* Theme library index identification ("VTI" + version) */
+#define INDEX_MAGIC 0x56544901
+#define INDEX_VERSION 3
+/* Name of the index file inside a theme directory */
+#define INDEX_NAME "ViNCEd_Theme.index"
+#define INDEX_NAME_SIZE 32        /* Longest indexed theme name plus NUL */
+#define INDEX_NONE 0xFFFF         /* End of a hash chain */
+#define INDEX_MIN_BUCKETS 16
 
 /* ReadArgs indices */
 enum
@@ -72,6 +116,16 @@ enum
   ARG_ANSI,
   ARG_NOANSI,
   ARG_VIEW,
+  ARG_THEMES,
+  ARG_TODIR,
+  ARG_NOCACHE,
+  ARG_FORCE,
+  ARG_STATS,
+  ARG_DIFF,
+  ARG_LIVE,
+  ARG_INDEX,
+  ARG_THEMEDIR,
+  ARG_METRIC,
   ARG_COUNT
 };
 
@@ -86,13 +140,55 @@ typedef struct ColorOverrides
   BOOL use_ansi;          /* TRUE for ANSI, FALSE for NOANSI (when override_ansi is TRUE) */
 } ColorOverrides;
 
+/* ColorRecord flag bits */
+#define COLOR_FLAG_LOAD 0x01      /* LOAD rather than NOLOAD */
+#define COLOR_FLAG_ANSI 0x02      /* ANSI rather than NOANSI */
+
+/**
+ * Structure to hold one parsed color, as stored in the theme cache
+ */
+typedef struct ColorRecord
+{
+  UBYTE flags;                    /* COLOR_FLAG_LOAD and COLOR_FLAG_ANSI bits */
+  UBYTE pad;                      /* Keeps the channels word aligned */
+  UWORD red;                      /* 16-bit red channel */
+  UWORD green;                    /* 16-bit green channel */
+  UWORD blue;                     /* 16-bit blue channel */
+} ColorRecord;
+
+/**
+ * Compiled theme cache file: one fixed-size record read with a single Read
+ */
+typedef struct CompiledTheme
+{
+  ULONG magic;                    /* CACHE_MAGIC */
+  UWORD version;                  /* CACHE_VERSION */
+  UWORD entry_count;              /* Always MAX_COLOR_ENTRIES */
+  ULONG checksum;                 /* Checksum of everything after this field */
+  struct DateStamp source_date;   /* Date of the theme file it was built from */
+  ColorRecord cursor;             /* CURSORCOLOR entry */
+  ColorRecord colors[REQUIRED_COLOR_LINES]; /* COLOR entries */
+} CompiledTheme;
+
+/**
+ * Kinds of lines recognized in theme and preference files
+ */
+typedef enum LineKind
+{
+  LINE_OTHER = 0,                 /* Anything else, copied through unchanged */
+  LINE_CURSORCOLOR,               /* CURSORCOLOR= entry */
+  LINE_COLOR,                     /* COLOR= entry */
+  LINE_COLORS_MARKER              /* ;Colors: section marker */
+} LineKind;
+
 /**
- * Structure to hold a single color preference line
+ * Structure to hold a single parsed color preference entry
+ * The ViNCEd text form is produced only when a file is written.
  */
 typedef struct ColorEntry
 {
-  UBYTE *line;                    /* Complete line text */
-  struct ColorEntry *next;        /* Next entry in linked list */
+  LineKind kind;                  /* LINE_CURSORCOLOR or LINE_COLOR */
+  ColorRecord color;              /* Flags and 16-bit channels */
 } ColorEntry;
 
 /**
@@ -100,987 +196,3754 @@ typedef struct ColorEntry
  */
 typedef struct ColorList
 {
-  ColorEntry *first;              /* First color entry */
-  ColorEntry *last;               /* Last color entry for efficient appending */
-  ULONG count;                    /* Number of entries */
+  ColorEntry *entries;            /* Block of MAX_COLOR_ENTRIES entries, or NULL */
+  ULONG count;                    /* Number of entries in use */
 } ColorList;
 
 /**
- * Convert a string to uppercase in-place for case-insensitive comparison
- *
- * @param str String to convert to uppercase
+ * Why load_text_file could not load a file
  */
-VOID str_to_upper(UBYTE *str)
+typedef enum TextStatus
 {
-  if (!str) return;
-
-  while (*str)
-  {
-    *str = toupper(*str);
-    str++;
-  }
-}
+  TEXT_LOADED = 0,                /* Whole file is in memory */
+  TEXT_MISSING,                   /* File does not exist */
+  TEXT_OPEN_FAILED,               /* File exists but could not be opened */
+  TEXT_NO_MEMORY,                 /* Buffer could not be allocated */
+  TEXT_READ_FAILED                /* Read failed or returned a short count */
+} TextStatus;
 
 /**
- * Check if a line starts with a given prefix, ignoring leading whitespace
- *
- * @param line Line to check (may have leading whitespace)
- * @param prefix Prefix to look for
- * @return TRUE if line starts with prefix after whitespace, FALSE otherwise
+ * Whole file loaded into memory and split into lines in place
  */
-BOOL line_starts_with(const UBYTE *line, const UBYTE *prefix)
+typedef struct TextFile
 {
-  const UBYTE *start;
-  UBYTE temp_line[MAX_LINE_LENGTH];
-  UBYTE temp_prefix[256];
-  ULONG prefix_len;
+  UBYTE *buffer;                  /* File contents followed by a NUL */
+  ULONG size;                     /* Number of bytes read */
+  ULONG alloc_size;               /* Size of the allocated buffer */
+  UBYTE *next;                    /* Start of the next line to return */
+  TextStatus status;              /* Outcome of load_text_file */
+  LONG io_error;                  /* IoErr() of a failed Open or Read */
+  BOOL mapped;                    /* Buffer is a host file mapping, not alloc_mem */
+} TextFile;
 
-  if (!line || !prefix) return FALSE;
+/**
+ * One color line of a preferences file to overwrite in place
+ */
+typedef struct PrefsPatch
+{
+  ULONG offset;                   /* Offset of the line in the file */
+  const ColorEntry *entry;        /* Entry to write over it */
+} PrefsPatch;
 
-  /* Skip leading whitespace and tabs */
-  start = line;
-  while (*start && (*start == ' ' || *start == '\t'))
-  {
-    start++;
-  }
+/**
+ * New colors arranged the way they replace lines of a preferences file
+ */
+typedef struct PrefsColors
+{
+  const ColorEntry *cursor;       /* Replacement for CURSORCOLOR lines, or NULL */
+  const ColorEntry *colors[REQUIRED_COLOR_LINES]; /* Replacements for COLOR lines */
+  ULONG color_count;              /* Number of entries in colors */
+} PrefsColors;
 
-  /* Make local uppercase copies for comparison */
-  strncpy(temp_line, start, sizeof(temp_line) - 1);
-  temp_line[sizeof(temp_line) - 1] = '\0';
-  str_to_upper(temp_line);
+/**
+ * One preferences file to update, with its loaded contents and plan
+ */
+typedef struct PrefsTarget
+{
+  const UBYTE *path;              /* Path of the preferences file */
+  TextFile text;                  /* Current contents, if have_text */
+  BOOL have_text;                 /* TRUE if the file exists and was loaded */
+  BOOL in_place;                  /* TRUE if it can be patched in place */
+  BOOL unchanged;                 /* TRUE if it already holds the colors */
+  PrefsPatch patches[MAX_COLOR_ENTRIES]; /* Lines to patch when in_place */
+  ULONG patch_count;              /* Number of patches */
+  TextFile output;                /* Rebuilt contents, once generated */
+  ULONG rewritten;                /* Color lines in output */
+} PrefsTarget;
 
-  strncpy(temp_prefix, prefix, sizeof(temp_prefix) - 1);
-  temp_prefix[sizeof(temp_prefix) - 1] = '\0';
-  str_to_upper(temp_prefix);
+/**
+ * Timing and status of one file converted in a batch run
+ */
+typedef struct BatchResult
+{
+  UBYTE name[108];                /* File name without path */
+  ULONG micros;                   /* Time taken to read, convert and write */
+  BOOL success;                   /* TRUE if the file was converted */
+  struct BatchResult *next;       /* Next result in run order */
+} BatchResult;
 
-  prefix_len = strlen(temp_prefix);
-  return (BOOL)(strncmp(temp_line, temp_prefix, prefix_len) == 0);
-}
+/**
+ * State shared by all files of a batch run
+ */
+typedef struct BatchRun
+{
+  ColorList colors;               /* ColorList reused for every file */
+  TextFile text;                  /* Parse buffer reused for every file */
+  ColorOverrides *overrides;      /* Optional color overrides */
+  const UBYTE *to_dir;            /* Output directory */
+  BatchResult *first;             /* Per-file results in run order */
+  BatchResult *last;              /* Last result for efficient appending */
+  ULONG file_count;               /* Number of files processed */
+  ULONG failed_count;             /* Number of files that failed */
+  ULONG unmatched_count;          /* Number of names that matched no file */
+  BOOL out_of_memory;             /* TRUE once a result could not be allocated */
+} BatchRun;
 
 /**
- * Check if a string starts with a given prefix (case-insensitive)
- *
- * @param str String to check
- * @param prefix Prefix to look for
- * @return TRUE if string starts with prefix, FALSE otherwise
+ * Theme library index file header
+ * Followed by bucket_count UWORD hash buckets and entry_count IndexEntry
+ * records; each bucket holds the first entry of its chain or INDEX_NONE.
  */
-BOOL starts_with(const UBYTE *str, const UBYTE *prefix)
+typedef struct IndexHeader
 {
-  UBYTE temp_str[MAX_LINE_LENGTH];
-  UBYTE temp_prefix[256];
+  ULONG magic;                    /* INDEX_MAGIC */
+  UWORD version;                  /* INDEX_VERSION */
+  UWORD bucket_count;             /* Power of two */
+  ULONG entry_count;              /* Number of entries */
+  ULONG checksum;                 /* Checksum of everything after the header */
+} IndexHeader;
 
-  if (!str || !prefix) return FALSE;
+/**
+ * One pre-parsed theme of a library index
+ */
+typedef struct IndexEntry
+{
+  UBYTE name[INDEX_NAME_SIZE];    /* Theme file name */
+  struct DateStamp date;          /* Date of the theme file when indexed */
+  ULONG content_hash;             /* FNV-1a hash of the theme file's bytes */
+  UWORD next;                     /* Next entry in the hash chain */
+  UWORD pad;                      /* Keeps the records long aligned */
+  ColorRecord cursor;             /* CURSORCOLOR entry */
+  ColorRecord colors[REQUIRED_COLOR_LINES]; /* COLOR entries */
+} IndexEntry;
 
-  /* Make local uppercase copies for comparison */
-  strncpy(temp_str, str, sizeof(temp_str) - 1);
-  temp_str[sizeof(temp_str) - 1] = '\0';
-  str_to_upper(temp_str);
+/**
+ * Theme library index loaded into memory with a single Read
+ */
+typedef struct ThemeIndex
+{
+  TextFile file;                  /* Whole index file */
+  IndexHeader *header;            /* Header at the start of file */
+  UWORD *buckets;                 /* Hash buckets */
+  IndexEntry *entries;            /* Entries */
+} ThemeIndex;
 
-  strncpy(temp_prefix, prefix, sizeof(temp_prefix) - 1);
-  temp_prefix[sizeof(temp_prefix) - 1] = '\0';
-  str_to_upper(temp_prefix);
+/**
+ * Themes collected for the gallery view
+ */
+typedef struct GalleryList
+{
+  GalleryTheme *themes;           /* Loaded themes in command line order */
+  ULONG count;                    /* Number of loaded themes */
+  ULONG capacity;                 /* Number of themes the array can hold */
+} GalleryList;
+
+/* AllocMem calls made and released through alloc_mem and free_mem */
+static ULONG alloc_count = 0;
+static ULONG free_count = 0;
+static ULONG heap_in_use = 0;
+static ULONG peak_heap = 0;
+
+/* I/O counters and phase times reported by STATS */
+static ULONG lines_read = 0;
+static ULONG lines_rewritten = 0;
+static ULONG bytes_written = 0;
+static PhaseTime phase_times[MAX_STATS_PHASES];
+static ULONG phase_count = 0;
+static ULONG phases_dropped = 0;
+static ULONG dropped_micros = 0;
+static struct EClockVal phase_start;
+
+/*
+ * GUI library bases, defined here so the startup code does not open them.
+ * The windows in amiga_color_window.c open all four. They live in the root because the window code is an
+ * overlay (see ViNCEd_Theme.lnk) and the root may not refer to its data.
+ */
+struct GfxBase *GfxBase = NULL;               /* graphics.library V39 */
+struct IntuitionBase *IntuitionBase = NULL;   /* intuition.library V39 */
+struct Library *DiskfontBase = NULL;          /* diskfont.library, optional */
+struct Library *IFFParseBase = NULL;          /* iffparse.library, optional */
 
-  return (BOOL)(strncmp(temp_str, temp_prefix, strlen(temp_prefix)) == 0);
-}
+/* timer.device state for EClock timing */
+struct Device *TimerBase = NULL;
+static struct MsgPort *timer_port = NULL;
+static struct timerequest *timer_request = NULL;
+static ULONG eclock_rate = 0;
 
 /**
- * Convert various input formats to 16-bit RGB hex value
+ * Match an uppercase prefix against a string without copying it
  *
- * @param input Input string containing color value
- * @return 16-bit RGB value (0x0000-0xFFFF)
+ * @param str String to check
+ * @param upper_prefix Prefix to look for, already in uppercase
+ * @return Length of the prefix if it matched (case-insensitive), 0 otherwise
  */
-UWORD convert_to_16bit_rgb(const UBYTE *input)
+ULONG match_prefix(const UBYTE *str, const char *upper_prefix)
 {
-  UBYTE clean_input[32];
-  UBYTE *ptr;
-  ULONG value;
-
-  if (!input) return 0;
+  const char *p = upper_prefix;
 
-  /* Remove whitespace and copy to work buffer */
-  ptr = clean_input;
-  while (*input && ptr < clean_input + sizeof(clean_input) - 1)
+  while (*p)
   {
-    if (!isspace(*input))
-    {
-      *ptr++ = *input;
-    }
-    input++;
+    if (toupper(*str) != *p) return 0;
+    str++;
+    p++;
   }
-  *ptr = '\0';
 
-  /* Check for hex prefix */
-  if (starts_with(clean_input, "0x") || starts_with(clean_input, "0X"))
-  {
-    value = strtoul(clean_input + 2, NULL, 16);
+  return (ULONG)(p - upper_prefix);
+}
 
-    /* If it's an 8-bit hex value (0x00-0xFF), expand to 16-bit */
-    if (value <= 0xFF)
-    {
-      return (UWORD)((value << 8) | value);
-    }
-    else
-    {
-      /* Already 16-bit, use as-is */
-      return (UWORD)(value & 0xFFFF);
-    }
-  }
+/**
+ * Check if a string starts with a given prefix (case-insensitive)
+ *
+ * @param str String to check
+ * @param prefix Prefix to look for, in uppercase
+ * @return TRUE if string starts with prefix, FALSE otherwise
+ */
+BOOL starts_with(const UBYTE *str, const char *prefix)
+{
+  if (!str || !prefix) return FALSE;
 
-  /* Check if it contains a decimal point (floating point) */
-  if (strchr(clean_input, '.'))
-  {
-    /* Simple integer-only floating point parsing for 0.0-1.0 range */
-    char *dot_pos = strchr(clean_input, '.');
-    ULONG int_part = 0;
-    ULONG frac_part = 0;
-    ULONG divisor = 1;
-    char *frac_start = dot_pos + 1;
-    char *p = frac_start;
+  return (BOOL)(match_prefix(str, prefix) > 0);
+}
 
-    /* Get integer part */
-    if (dot_pos > (char *)clean_input) {
-      int_part = atol((char *)clean_input);
-    }
+/**
+ * Check if a string ends with a given suffix (case-insensitive)
+ *
+ * @param str String to check
+ * @param suffix Suffix to look for
+ * @return TRUE if string ends with suffix, FALSE otherwise
+ */
+BOOL has_suffix(const UBYTE *str, const char *suffix)
+{
+  ULONG str_len = strlen((const char *)str);
+  ULONG suffix_len = strlen(suffix);
 
-    /* Get fractional part and divisor */
-    while (*p && (*p >= '0' && *p <= '9')) {
-      frac_part = frac_part * 10 + (*p - '0');
-      divisor *= 10;
-      p++;
-    }
+  if (str_len < suffix_len) return FALSE;
 
-    /* Convert to 16-bit value */
-    if (int_part >= 1) {
-      return 0xFFFF;  /* 1.0 or greater */
-    } else {
-      /* Calculate fractional value * 65535 */
-      value = (frac_part * 65535UL) / divisor;
-      return (UWORD)value;
-    }
+  str += str_len - suffix_len;
+  while (*suffix)
+  {
+    if (toupper(*str) != toupper(*suffix)) return FALSE;
+    str++;
+    suffix++;
   }
 
-  /* Integer 0-255 */
-  value = atol(clean_input);
-  if (value > 255) value = 255;
-
-  /* Convert 8-bit to 16-bit by duplicating high byte */
-  return (UWORD)((value << 8) | value);
+  return TRUE;
 }
 
 /**
- * Parse a color line and convert RGB values to ViNCEd format
- * Handles both simple format (COLOR=r,g,b) and complex format (COLOR=prefix1,prefix2,r,g,b)
- * Now supports overriding LOAD/NOLOAD and ANSI/NOANSI flags
+ * Classify a theme or preference line in a single pass, in place
+ * Leading whitespace is ignored for COLOR= and CURSORCOLOR= lines; the
+ * ;Colors: marker must start in the first column.
  *
- * @param input_line Original color line from theme file
- * @param output_line Buffer to store converted line
- * @param max_output Maximum size of output buffer
- * @param overrides Pointer to override flags (can be NULL)
- * @return TRUE on success, FALSE on failure
+ * @param line Line to classify
+ * @param value_offset Receives the offset of the text after '=' (can be NULL)
+ * @return Kind of line
  */
-BOOL convert_color_line(const UBYTE *input_line, UBYTE *output_line, ULONG max_output, ColorOverrides *overrides)
+LineKind classify_line(const UBYTE *line, ULONG *value_offset)
 {
-  UBYTE work_line[MAX_LINE_LENGTH];
-  UBYTE *equals_pos;
-  UBYTE *start_pos;
-  UBYTE prefix_part[256];
-  UBYTE r_str[32], g_str[32], b_str[32];
-  UBYTE *comma_positions[10];
-  UWORD r_val, g_val, b_val;
-  ULONG comma_count = 0;
-  UBYTE *ptr;
-  UBYTE load_flag[32] = "NOLOAD";
-  UBYTE ansi_flag[32] = "NOANSI";
-
-  if (!input_line || !output_line || max_output < 1) return FALSE;
-
-  /* Copy input to work buffer */
-  strncpy(work_line, input_line, sizeof(work_line) - 1);
-  work_line[sizeof(work_line) - 1] = '\0';
+  const UBYTE *start;
+  ULONG matched;
 
-  /* Find the equals sign */
-  equals_pos = strchr(work_line, '=');
-  if (!equals_pos) return FALSE;
+  if (!line) return LINE_OTHER;
 
-  /* Find all comma positions after equals */
-  ptr = equals_pos + 1;
-  while (*ptr && comma_count < 10)
+  if (*line == ';')
   {
-    if (*ptr == ',')
+    matched = match_prefix(line, ";COLORS:");
+    if (matched)
     {
-      comma_positions[comma_count] = ptr;
-      comma_count++;
+      if (value_offset) *value_offset = matched;
+      return LINE_COLORS_MARKER;
     }
-    ptr++;
+    return LINE_OTHER;
   }
 
-  /* Need at least 2 commas for RGB triplet */
-  if (comma_count < 2) return FALSE;
-
-  /* Extract prefix (everything up to and including equals) */
-  *equals_pos = '\0';
-  strcpy(prefix_part, work_line);
-  strcat(prefix_part, "=");
-
-  start_pos = equals_pos + 1;
-
-  if (comma_count == 2)
+  /* Skip leading whitespace and tabs */
+  start = line;
+  while (*start == ' ' || *start == '\t')
   {
-    /* Simple format: COLOR=r,g,b */
-    *comma_positions[0] = '\0';
-    *comma_positions[1] = '\0';
-
-    strcpy(r_str, start_pos);
-    strcpy(g_str, comma_positions[0] + 1);
-    strcpy(b_str, comma_positions[1] + 1);
-
-    /* Use default flags or overrides */
-    if (overrides)
-    {
-      if (overrides->override_load)
-      {
-        strcpy(load_flag, overrides->use_load ? "LOAD" : "NOLOAD");
-      }
-      if (overrides->override_ansi)
-      {
-        strcpy(ansi_flag, overrides->use_ansi ? "ANSI" : "NOANSI");
-      }
-    }
+    start++;
   }
-  else if (comma_count == 4)
-  {
-    /* ViNCEd format: COLOR=NOLOAD,ANSI,r,g,b */
-    /* RGB values are after comma positions 1, 2, and 3 */
-    *comma_positions[0] = '\0';
-    *comma_positions[1] = '\0';
-    *comma_positions[2] = '\0';
-    *comma_positions[3] = '\0';
 
-    /* Extract the original flags */
-    strcpy(load_flag, start_pos);
-    strcpy(ansi_flag, comma_positions[0] + 1);
+  if (toupper(*start) != 'C') return LINE_OTHER;
 
-    /* Apply overrides if specified */
-    if (overrides)
-    {
-      if (overrides->override_load)
-      {
-        strcpy(load_flag, overrides->use_load ? "LOAD" : "NOLOAD");
-      }
-      if (overrides->override_ansi)
+  /* Both keywords begin with 'C', the second letter tells them apart */
+  switch (toupper(start[1]))
+  {
+    case 'U':
+      matched = match_prefix(start, "CURSORCOLOR=");
+      if (matched)
       {
-        strcpy(ansi_flag, overrides->use_ansi ? "ANSI" : "NOANSI");
+        if (value_offset) *value_offset = (ULONG)(start - line) + matched;
+        return LINE_CURSORCOLOR;
       }
-    }
-
-    strcpy(r_str, comma_positions[1] + 1);
-    strcpy(g_str, comma_positions[2] + 1);
-    strcpy(b_str, comma_positions[3] + 1);
-  }
-  else
-  {
-    /* Other formats - take last 3 values as RGB */
-    ULONG rgb_start = comma_count - 2;
-
-    *comma_positions[rgb_start] = '\0';
-    *comma_positions[rgb_start + 1] = '\0';
-
-    strcpy(r_str, comma_positions[rgb_start - 1] + 1);
-    strcpy(g_str, comma_positions[rgb_start] + 1);
-    strcpy(b_str, comma_positions[rgb_start + 1] + 1);
-
-    /* For other formats, we need to parse the existing flags if present */
-    if (comma_count >= 4)
-    {
-      /* Assume first two values are LOAD/NOLOAD and ANSI/NOANSI */
-      *comma_positions[0] = '\0';
-      *comma_positions[1] = '\0';
-
-      strcpy(load_flag, start_pos);
-      strcpy(ansi_flag, comma_positions[0] + 1);
+      break;
 
-      /* Apply overrides if specified */
-      if (overrides)
+    case 'O':
+      matched = match_prefix(start, "COLOR=");
+      if (matched)
       {
-        if (overrides->override_load)
-        {
-          strcpy(load_flag, overrides->use_load ? "LOAD" : "NOLOAD");
-        }
-        if (overrides->override_ansi)
-        {
-          strcpy(ansi_flag, overrides->use_ansi ? "ANSI" : "NOANSI");
-        }
+        if (value_offset) *value_offset = (ULONG)(start - line) + matched;
+        return LINE_COLOR;
       }
-    }
+      break;
   }
 
-  /* Remove trailing whitespace and newlines from blue component */
-  {
-    UBYTE *end = b_str + strlen(b_str) - 1;
-    while (end >= b_str && (*end == '\n' || *end == '\r' || isspace(*end)))
-    {
-      *end-- = '\0';
-    }
-  }
+  return LINE_OTHER;
+}
 
-  /* Convert to 16-bit RGB */
-  r_val = convert_to_16bit_rgb(r_str);
-  g_val = convert_to_16bit_rgb(g_str);
-  b_val = convert_to_16bit_rgb(b_str);
+/* Character classes used by the color value parser */
+#define CC_SPACE    0x01          /* Space, tab, CR or LF */
+#define CC_DIGIT    0x02          /* 0-9 */
+#define CC_HEX      0x04          /* 0-9, A-F, a-f */
+#define CC_X        0x08          /* x or X of a hex prefix */
+#define CC_DOT      0x10          /* Decimal point */
+#define CC_HASH     0x20          /* # of a #RRGGBB triplet */
+#define CC_PERCENT  0x40          /* % suffix */
+#define CC_DEC      (CC_DIGIT | CC_HEX)
 
-  /* Build output line using sprintf for SAS/C compatibility */
-  sprintf(output_line, "%s%s,%s,0x%04x,0x%04x,0x%04x",
-          prefix_part, load_flag, ansi_flag, r_val, g_val, b_val);
+/* Class of a character; everything outside 7-bit ASCII has no class */
+#define CHAR_CLASS(c) ((UBYTE)(c) < 128 ? char_class[(UBYTE)(c)] : 0)
 
-  return TRUE;
-}
+static const UBYTE char_class[128] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0,
+  0, CC_SPACE, CC_SPACE, 0, 0, CC_SPACE, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  CC_SPACE, 0, 0, CC_HASH, 0, CC_PERCENT, 0, 0,
+  0, 0, 0, 0, 0, 0, CC_DOT, 0,
+  CC_DEC, CC_DEC, CC_DEC, CC_DEC, CC_DEC, CC_DEC, CC_DEC, CC_DEC,
+  CC_DEC, CC_DEC, 0, 0, 0, 0, 0, 0,
+  0, CC_HEX, CC_HEX, CC_HEX, CC_HEX, CC_HEX, CC_HEX, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  CC_X, 0, 0, 0, 0, 0, 0, 0,
+  0, CC_HEX, CC_HEX, CC_HEX, CC_HEX, CC_HEX, CC_HEX, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  CC_X, 0, 0, 0, 0, 0, 0, 0
+};
 
 /**
- * Initialize a ColorList structure
+ * Get the value of a character already known to be a hex digit
  *
- * @param list Pointer to ColorList to initialize
+ * @param c Hex digit character
+ * @return Value 0-15
  */
-VOID init_color_list(ColorList *list)
+ULONG hex_digit_value(UBYTE c)
 {
-  if (!list) return;
-
-  list->first = NULL;
-  list->last = NULL;
-  list->count = 0;
+  if (CHAR_CLASS(c) & CC_DIGIT) return (ULONG)(c - '0');
+  return (ULONG)(toupper(c) - 'A' + 10);
 }
 
 /**
- * Add a color entry to the list
+ * Round a decimal value in the range 0.0-1.0 to a 16-bit channel
+ * The value is int_digits.frac_digits divided by 10^shift. The digit string
+ * is multiplied by 65535 from the least significant digit up, so rounding is
+ * exact no matter how many digits are given.
  *
- * @param list ColorList to add entry to
- * @param line_text Text of the color line to add
- * @return TRUE on success, FALSE on failure
+ * @param int_digits Digits before the decimal point
+ * @param int_count Number of digits before the decimal point
+ * @param frac_digits Digits after the decimal point
+ * @param frac_count Number of digits after the decimal point
+ * @param shift Power of ten to divide by (0 for fractions, 2 for percentages)
+ * @param value Receives the 16-bit value (0x0000-0xFFFF)
+ * @return TRUE on success, FALSE if the value is above 1.0
  */
-BOOL add_color_entry(ColorList *list, const UBYTE *line_text)
+BOOL round_decimal_to_16bit(const UBYTE *int_digits, ULONG int_count,
+                            const UBYTE *frac_digits, ULONG frac_count,
+                            ULONG shift, UWORD *value)
 {
-  ColorEntry *entry;
-  ULONG line_len;
-
-  if (!list || !line_text) return FALSE;
-
-  entry = AllocMem(sizeof(ColorEntry), MEMF_CLEAR);
-  if (!entry) return FALSE;
+  ULONG carry = 0;
+  ULONG first_digit = 0;
+  ULONG product;
+  ULONG i;
 
-  line_len = strlen(line_text) + 1;
-  entry->line = AllocMem(line_len, MEMF_CLEAR);
-  if (!entry->line)
+  /* Ignore leading zeros; anything left above the shifted point is >= 1.0 */
+  while (int_count > 0 && *int_digits == '0')
   {
-    FreeMem(entry, sizeof(ColorEntry));
-    return FALSE;
+    int_digits++;
+    int_count--;
+  }
+  if (int_count > shift)
+  {
+    /* Of those only exactly 1.0 is in range */
+    if (int_count > shift + 1 || int_digits[0] != '1') return FALSE;
+    for (i = 1; i < int_count; i++)
+    {
+      if (int_digits[i] != '0') return FALSE;
+    }
+    for (i = 0; i < frac_count; i++)
+    {
+      if (frac_digits[i] != '0') return FALSE;
+    }
+    *value = 0xFFFF;
+    return TRUE;
   }
 
-  strcpy(entry->line, line_text);
-  entry->next = NULL;
-
-  if (list->last)
+  /* Fraction digits, least significant first */
+  for (i = frac_count; i > 0; i--)
   {
-    list->last->next = entry;
-    list->last = entry;
+    product = (ULONG)(frac_digits[i - 1] - '0') * 65535UL + carry;
+    first_digit = product % 10;
+    carry = product / 10;
   }
-  else
+
+  /* Integer digits that were shifted below the point, zero padded */
+  for (i = 0; i < shift; i++)
   {
-    list->first = entry;
-    list->last = entry;
+    product = carry;
+    if (i < int_count)
+    {
+      product += (ULONG)(int_digits[int_count - 1 - i] - '0') * 65535UL;
+    }
+    first_digit = product % 10;
+    carry = product / 10;
   }
 
-  list->count++;
+  /* carry holds the integer part of value * 65535, first_digit the tenths */
+  if (first_digit >= 5) carry++;
+
+  *value = (UWORD)carry;
   return TRUE;
 }
 
 /**
- * Free all memory used by a ColorList
+ * Parse a single color component in one pass
  *
- * @param list ColorList to free
+ * Accepted forms:
+ *   0x12       - 8-bit hex (1-2 digits, expanded to 0x1212)
+ *   0x1234     - 16-bit hex (3-4 digits, passed through)
+ *   255        - Integer 0-255 (expanded to 16-bit)
+ *   0.5        - Decimal 0.0-1.0, any number of digits
+ *   50%        - Percentage 0-100, optionally with decimals
+ *
+ * A value outside its range is an error at the first character of the
+ * number, the same as a malformed one.
+ *
+ * @param text Start of the component (need not be NUL terminated)
+ * @param length Number of characters in the component
+ * @param value Receives the 16-bit value
+ * @param error_pos Receives the offset of the offending character on error
+ * @return TRUE on success, FALSE on a parse or range error
  */
-VOID free_color_list(ColorList *list)
+BOOL parse_color_component(const UBYTE *text, ULONG length, UWORD *value, ULONG *error_pos)
 {
-  ColorEntry *current, *next;
+  const UBYTE *p = text;
+  const UBYTE *end = text + length;
+  const UBYTE *int_start, *frac_start = NULL;
+  ULONG int_count, frac_count = 0;
+  ULONG digits = 0;
+  ULONG result = 0;
 
-  if (!list) return;
+  /* Leading whitespace */
+  while (p < end && (CHAR_CLASS(*p) & CC_SPACE)) p++;
+
+  /* Trailing whitespace, including any line ending */
+  while (end > p && (CHAR_CLASS(end[-1]) & CC_SPACE)) end--;
+
+  if (p == end)
+  {
+    *error_pos = (ULONG)(p - text);
+    return FALSE;
+  }
 
-  current = list->first;
-  while (current)
+  /* Hex: 0x followed by 1-4 hex digits */
+  if (*p == '0' && p + 1 < end && (CHAR_CLASS(p[1]) & CC_X))
   {
-    next = current->next;
-    if (current->line)
+    p += 2;
+    while (p < end && (CHAR_CLASS(*p) & CC_HEX) && digits < 4)
     {
-      FreeMem(current->line, strlen(current->line) + 1);
+      result = (result << 4) | hex_digit_value(*p);
+      digits++;
+      p++;
+    }
+    if (digits == 0 || p != end)
+    {
+      *error_pos = (ULONG)(p - text);
+      return FALSE;
     }
-    FreeMem(current, sizeof(ColorEntry));
-    current = next;
-  }
 
-  init_color_list(list);
-}
+    /* Up to two digits is an 8-bit value, expand it to 16-bit */
+    *value = (UWORD)(digits <= 2 ? (result << 8) | result : result);
+    return TRUE;
+  }
 
-/**
- * Generate default color entries (CURSORCOLOR + 16 COLOR lines)
- *
- * @param colors ColorList to populate with default entries
- * @param overrides Optional color overrides to apply
- * @return TRUE on success, FALSE on failure
- */
-BOOL generate_default_colors(ColorList *colors, ColorOverrides *overrides)
-{
-  ULONG i;
-  UBYTE color_line[MAX_LINE_LENGTH];
-  UBYTE *load_flag = "NOLOAD";
-  UBYTE *ansi_flag = "NOANSI";
+  /* Integer, decimal or percentage */
+  int_start = p;
+  while (p < end && (CHAR_CLASS(*p) & CC_DIGIT))
+  {
+    if (result <= 255) result = result * 10 + (*p - '0');
+    p++;
+  }
+  int_count = (ULONG)(p - int_start);
 
-  if (!colors) return FALSE;
+  if (p < end && (CHAR_CLASS(*p) & CC_DOT))
+  {
+    p++;
+    frac_start = p;
+    while (p < end && (CHAR_CLASS(*p) & CC_DIGIT)) p++;
+    frac_count = (ULONG)(p - frac_start);
+  }
 
-  init_color_list(colors);
+  if (int_count == 0 && frac_count == 0)
+  {
+    *error_pos = (ULONG)(p - text);
+    return FALSE;
+  }
 
-  /* Apply overrides if specified */
-  if (overrides)
+  if (p < end && (CHAR_CLASS(*p) & CC_PERCENT))
   {
-    if (overrides->override_load)
+    p++;
+    if (p != end)
     {
-      load_flag = overrides->use_load ? "LOAD" : "NOLOAD";
+      *error_pos = (ULONG)(p - text);
+      return FALSE;
     }
-    if (overrides->override_ansi)
+    if (!round_decimal_to_16bit(int_start, int_count, frac_start, frac_count, 2, value))
     {
-      ansi_flag = overrides->use_ansi ? "ANSI" : "NOANSI";
+      *error_pos = (ULONG)(int_start - text);
+      return FALSE;
     }
+    return TRUE;
   }
 
-  /* Add default cursor color */
-  sprintf(color_line, "CURSORCOLOR=%s,%s,0x0000,0x0000,0x0000", load_flag, ansi_flag);
-  if (!add_color_entry(colors, color_line))
+  if (p != end)
   {
+    *error_pos = (ULONG)(p - text);
     return FALSE;
   }
 
-  /* Add 16 default color entries */
-  for (i = 0; i < REQUIRED_COLOR_LINES; i++)
+  if (frac_start)
   {
-    sprintf(color_line, "COLOR=%s,%s,0x0000,0x0000,0x0000", load_flag, ansi_flag);
-    if (!add_color_entry(colors, color_line))
+    if (!round_decimal_to_16bit(int_start, int_count, frac_start, frac_count, 0, value))
     {
-      free_color_list(colors);
+      *error_pos = (ULONG)(int_start - text);
       return FALSE;
     }
+    return TRUE;
   }
 
-  Printf("Generated %ld default color entries\n", colors->count);
+  /* Integer 0-255 */
+  if (result > 255)
+  {
+    *error_pos = (ULONG)(int_start - text);
+    return FALSE;
+  }
+  *value = (UWORD)((result << 8) | result);
   return TRUE;
 }
 
 /**
- * Display color entries with RGB values for checking
+ * Parse a whole color given as a single value
  *
- * @param colors ColorList containing color entries to display
+ * Accepted forms:
+ *   #RRGGBB    - 8 bits per channel
+ *   0xRGB      - 4 bits per channel (12-bit Amiga style)
+ *
+ * @param text Start of the value (need not be NUL terminated)
+ * @param length Number of characters in the value
+ * @param rgb Receives the red, green and blue 16-bit values
+ * @param error_pos Receives the offset of the offending character on error
+ * @return TRUE on success, FALSE on a parse error
  */
-VOID display_color_check(ColorList *colors)
+BOOL parse_color_triplet(const UBYTE *text, ULONG length, UWORD *rgb, ULONG *error_pos)
 {
-  ColorEntry *entry;
-  ULONG line_num = 0;
-
-  if (!colors) return;
+  const UBYTE *p = text;
+  const UBYTE *end = text + length;
+  ULONG digits_per_channel;
+  ULONG channel, i, value;
 
-  Printf("=== COLOR CHECK - %ld entries to be written ===\n", colors->count);
+  while (p < end && (CHAR_CLASS(*p) & CC_SPACE)) p++;
+  while (end > p && (CHAR_CLASS(end[-1]) & CC_SPACE)) end--;
 
-  entry = colors->first;
-  while (entry)
+  if (p < end && (CHAR_CLASS(*p) & CC_HASH))
   {
-    UBYTE *line = entry->line;
-    UBYTE *equals_pos;
-    UWORD r_val, g_val, b_val;
-    ULONG r_8bit, g_8bit, b_8bit;
-
-    line_num++;
+    p++;
+    digits_per_channel = 2;
+  }
+  else if (end - p > 2 && *p == '0' && (CHAR_CLASS(p[1]) & CC_X))
+  {
+    p += 2;
+    digits_per_channel = 1;
+  }
+  else
+  {
+    *error_pos = (ULONG)(p - text);
+    return FALSE;
+  }
 
-    /* Extract the hex values to show RGB equivalents */
-    equals_pos = strchr(line, '=');
-    if (equals_pos)
+  for (channel = 0; channel < 3; channel++)
+  {
+    value = 0;
+    for (i = 0; i < digits_per_channel; i++)
     {
-      /* Find the three hex values (0x****) */
-      UBYTE *hex1 = strstr(equals_pos, "0x");
-      if (hex1)
-      {
-        UBYTE *hex2 = strstr(hex1 + 1, "0x");
-        if (hex2)
-        {
-          UBYTE *hex3 = strstr(hex2 + 1, "0x");
-          if (hex3)
-          {
-            /* Parse the hex values */
-            r_val = (UWORD)strtoul(hex1 + 2, NULL, 16);
-            g_val = (UWORD)strtoul(hex2 + 2, NULL, 16);
-            b_val = (UWORD)strtoul(hex3 + 2, NULL, 16);
-
-            /* Convert 16-bit to 8-bit for display */
-            r_8bit = (r_val >> 8) & 0xFF;
-            g_8bit = (g_val >> 8) & 0xFF;
-            b_8bit = (b_val >> 8) & 0xFF;
-
-            Printf("%2ld: %s RGB(%ld,%ld,%ld)\n",
-                   line_num, line, r_8bit, g_8bit, b_8bit);
-          }
-          else
-          {
-            Printf("%2ld: %s (parse error)\n", line_num, line);
-          }
-        }
-        else
-        {
-          Printf("%2ld: %s (parse error)\n", line_num, line);
-        }
-      }
-      else
+      if (p == end || !(CHAR_CLASS(*p) & CC_HEX))
       {
-        Printf("%2ld: %s (no hex values)\n", line_num, line);
+        *error_pos = (ULONG)(p - text);
+        return FALSE;
       }
-    }
-    else
-    {
-      Printf("%2ld: %s (malformed)\n", line_num, line);
+      value = (value << 4) | hex_digit_value(*p);
+      p++;
     }
 
-    entry = entry->next;
+    /* Replicate the digits to fill 16 bits */
+    rgb[channel] = (UWORD)(digits_per_channel == 1 ? value * 0x1111 : value * 0x0101);
   }
 
-  Printf("=== END COLOR CHECK ===\n\n");
+  if (p != end)
+  {
+    *error_pos = (ULONG)(p - text);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * Parse a LOAD/NOLOAD or ANSI/NOANSI flag field (case-insensitive)
+ *
+ * @param text Start of the field (need not be NUL terminated)
+ * @param length Number of characters in the field
+ * @param keyword Flag keyword in uppercase, without the NO prefix
+ * @param flag Receives TRUE for the keyword, FALSE for its NO form
+ * @param error_pos Receives the offset of the offending character on error
+ * @return TRUE on success, FALSE if the field is neither form
+ */
+BOOL parse_flag_field(const UBYTE *text, ULONG length, const char *keyword,
+                      BOOL *flag, ULONG *error_pos)
+{
+  const UBYTE *p = text;
+  const UBYTE *end = text + length;
+  ULONG matched;
+  BOOL negated = FALSE;
+
+  while (p < end && (CHAR_CLASS(*p) & CC_SPACE)) p++;
+  while (end > p && (CHAR_CLASS(end[-1]) & CC_SPACE)) end--;
+
+  if (end - p > 2 && match_prefix(p, "NO"))
+  {
+    negated = TRUE;
+    p += 2;
+  }
+
+  matched = match_prefix(p, keyword);
+  if (!matched || p + matched != end)
+  {
+    *error_pos = (ULONG)(p - text);
+    return FALSE;
+  }
+
+  *flag = (BOOL)!negated;
+  return TRUE;
+}
+
+/**
+ * Force the LOAD/NOLOAD and ANSI/NOANSI flags of a color if requested
+ *
+ * @param record Color to update
+ * @param overrides Pointer to override flags (can be NULL)
+ */
+VOID apply_overrides(ColorRecord *record, ColorOverrides *overrides)
+{
+  if (!overrides) return;
+
+  if (overrides->override_load)
+  {
+    record->flags = (UBYTE)(overrides->use_load ?
+                            record->flags | COLOR_FLAG_LOAD :
+                            record->flags & ~COLOR_FLAG_LOAD);
+  }
+  if (overrides->override_ansi)
+  {
+    record->flags = (UBYTE)(overrides->use_ansi ?
+                            record->flags | COLOR_FLAG_ANSI :
+                            record->flags & ~COLOR_FLAG_ANSI);
+  }
+}
+
+/**
+ * Parse a color line into its kind, flags and 16-bit channels
+ *
+ * Accepted value layouts after CURSORCOLOR= or COLOR=:
+ *   r,g,b
+ *   LOAD,ANSI,r,g,b
+ *   #RRGGBB or 0xRGB
+ *   LOAD,ANSI,#RRGGBB or LOAD,ANSI,0xRGB
+ * Other layouts with three or more values use the last three as RGB, and
+ * the first two as flags when there are at least five. LOAD/NOLOAD and
+ * ANSI/NOANSI default to NOLOAD,NOANSI and can be overridden.
+ *
+ * @param input_line Color line from a theme or preferences file
+ * @param kind Receives LINE_CURSORCOLOR or LINE_COLOR
+ * @param record Receives the parsed flags and channels
+ * @param overrides Pointer to override flags (can be NULL)
+ * @param error_pos Receives the column of a parse error (can be NULL)
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL parse_color_line(const UBYTE *input_line, LineKind *kind, ColorRecord *record,
+                      ColorOverrides *overrides, ULONG *error_pos)
+{
+  const UBYTE *field_start[MAX_COLOR_FIELDS];
+  ULONG field_length[MAX_COLOR_FIELDS];
+  ULONG field_count = 0;
+  ULONG value_offset;
+  ULONG rgb_field;
+  ULONG pos = 0;
+  const UBYTE *p;
+  UWORD rgb[3];
+  BOOL use_load = FALSE;
+  BOOL use_ansi = FALSE;
+  BOOL has_flags;
+  BOOL ok = TRUE;
+  ULONG i;
+
+  if (!input_line || !kind || !record) return FALSE;
+
+  *kind = classify_line(input_line, &value_offset);
+  if (*kind != LINE_CURSORCOLOR && *kind != LINE_COLOR)
+  {
+    if (error_pos) *error_pos = 0;
+    return FALSE;
+  }
+
+  /* Split the value part at commas */
+  p = input_line + value_offset;
+  for (;;)
+  {
+    if (field_count == MAX_COLOR_FIELDS)
+    {
+      if (error_pos) *error_pos = (ULONG)(p - input_line);
+      return FALSE;
+    }
+
+    field_start[field_count] = p;
+    while (*p && *p != ',') p++;
+    field_length[field_count] = (ULONG)(p - field_start[field_count]);
+    field_count++;
+
+    if (*p != ',') break;
+    p++;
+  }
+
+  /* A single value, or two flags and a single value, is a whole triplet */
+  if (field_count == 1 ||
+      (field_count == 3 && (CHAR_CLASS(*field_start[2]) & CC_HASH)) ||
+      (field_count == 3 && parse_flag_field(field_start[0], field_length[0], "LOAD", &use_load, &pos)))
+  {
+    has_flags = (BOOL)(field_count == 3);
+    rgb_field = field_count - 1;
+    ok = parse_color_triplet(field_start[rgb_field], field_length[rgb_field], rgb, &pos);
+  }
+  else if (field_count >= 3)
+  {
+    has_flags = (BOOL)(field_count >= 5);
+    rgb_field = field_count - 3;
+    for (i = 0; i < 3 && ok; i++)
+    {
+      ok = parse_color_component(field_start[rgb_field + i], field_length[rgb_field + i],
+                                 &rgb[i], &pos);
+    }
+    if (!ok) rgb_field += i - 1;
+  }
+  else
+  {
+    /* Two values can be neither an RGB triplet nor a single color */
+    if (error_pos) *error_pos = (ULONG)(p - input_line);
+    return FALSE;
+  }
+
+  if (ok && has_flags)
+  {
+    ok = parse_flag_field(field_start[0], field_length[0], "LOAD", &use_load, &pos);
+    rgb_field = 0;
+    if (ok)
+    {
+      ok = parse_flag_field(field_start[1], field_length[1], "ANSI", &use_ansi, &pos);
+      rgb_field = 1;
+    }
+  }
+
+  if (!ok)
+  {
+    if (error_pos) *error_pos = (ULONG)(field_start[rgb_field] - input_line) + pos;
+    return FALSE;
+  }
+
+  record->flags = (UBYTE)((use_load ? COLOR_FLAG_LOAD : 0) | (use_ansi ? COLOR_FLAG_ANSI : 0));
+  record->pad = 0;
+  record->red = rgb[0];
+  record->green = rgb[1];
+  record->blue = rgb[2];
+
+  apply_overrides(record, overrides);
+  return TRUE;
+}
+
+/**
+ * Format a parsed color as a canonical ViNCEd line
+ *
+ * @param kind LINE_CURSORCOLOR or LINE_COLOR
+ * @param record Flags and channels to write
+ * @param output_line Buffer of at least CANONICAL_LINE_SIZE bytes
+ */
+VOID format_color_line(LineKind kind, const ColorRecord *record, UBYTE *output_line)
+{
+  /* Build output line using sprintf for SAS/C compatibility */
+  sprintf((char *)output_line, "%s%s,%s,0x%04x,0x%04x,0x%04x",
+          kind == LINE_CURSORCOLOR ? "CURSORCOLOR=" : "COLOR=",
+          (record->flags & COLOR_FLAG_LOAD) ? "LOAD" : "NOLOAD",
+          (record->flags & COLOR_FLAG_ANSI) ? "ANSI" : "NOANSI",
+          record->red, record->green, record->blue);
+}
+
+/**
+ * Allocate memory with AllocMem and count the allocation
+ *
+ * @param size Number of bytes to allocate
+ * @param flags AllocMem requirements
+ * @return Allocated memory or NULL
+ */
+APTR alloc_mem(ULONG size, ULONG flags)
+{
+  APTR mem = AllocMem(size, flags);
+
+  if (mem)
+  {
+    alloc_count++;
+    heap_in_use += size;
+    if (heap_in_use > peak_heap) peak_heap = heap_in_use;
+  }
+  return mem;
+}
+
+/**
+ * Free memory from alloc_mem and count the release
+ *
+ * @param mem Memory to free
+ * @param size Size passed to alloc_mem
+ */
+VOID free_mem(APTR mem, ULONG size)
+{
+  FreeMem(mem, size);
+  free_count++;
+  heap_in_use -= size;
+}
+
+/**
+ * Open timer.device so elapsed times can be read from the EClock
+ *
+ * @return TRUE if the EClock is available, FALSE otherwise
+ */
+BOOL open_timer(VOID)
+{
+  struct EClockVal now;
+
+  if (TimerBase) return TRUE;
+
+  timer_port = CreateMsgPort();
+  if (!timer_port) return FALSE;
+
+  timer_request = (struct timerequest *)CreateIORequest(timer_port, sizeof(struct timerequest));
+  if (timer_request && OpenDevice(TIMERNAME, UNIT_ECLOCK, (struct IORequest *)timer_request, 0) == 0)
+  {
+    TimerBase = timer_request->tr_node.io_Device;
+    eclock_rate = ReadEClock(&now);
+    return TRUE;
+  }
+
+  if (timer_request) DeleteIORequest((struct IORequest *)timer_request);
+  DeleteMsgPort(timer_port);
+  timer_request = NULL;
+  timer_port = NULL;
+  return FALSE;
+}
+
+/**
+ * Close timer.device if open_timer succeeded
+ */
+VOID close_timer(VOID)
+{
+  if (TimerBase)
+  {
+    CloseDevice((struct IORequest *)timer_request);
+    TimerBase = NULL;
+  }
+  if (timer_request) DeleteIORequest((struct IORequest *)timer_request);
+  if (timer_port) DeleteMsgPort(timer_port);
+  timer_request = NULL;
+  timer_port = NULL;
+  eclock_rate = 0;
+}
+
+/**
+ * Read the current EClock value, or zero if the timer is not open
+ *
+ * @param clock Receives the current EClock value
+ */
+VOID read_clock(struct EClockVal *clock)
+{
+  if (TimerBase)
+  {
+    ReadEClock(clock);
+  }
+  else
+  {
+    clock->ev_hi = 0;
+    clock->ev_lo = 0;
+  }
+}
+
+/**
+ * Convert the EClock ticks between two readings to microseconds
+ *
+ * @param start Earlier EClock reading
+ * @param end Later EClock reading
+ * @return Elapsed microseconds (0 if the timer is not open)
+ */
+ULONG clock_micros(const struct EClockVal *start, const struct EClockVal *end)
+{
+  ULONG ticks, seconds, rest;
+
+  if (!eclock_rate) return 0;
+
+  /* ev_lo wraps after more than an hour, longer spans are not expected */
+  ticks = end->ev_lo - start->ev_lo;
+  seconds = ticks / eclock_rate;
+  rest = (ticks % eclock_rate) * 1000;
+
+  /* Split the remainder so no product overflows 32 bits */
+  return seconds * 1000000 +
+         (rest / eclock_rate) * 1000 +
+         ((rest % eclock_rate) * 1000) / eclock_rate;
+}
+
+/**
+ * Start timing a phase for STATS
+ */
+VOID start_phase(VOID)
+{
+  read_clock(&phase_start);
+}
+
+/**
+ * Record the time since start_phase and start timing the next phase
+ *
+ * @param name Name of the finished phase
+ */
+VOID end_phase(const char *name)
+{
+  struct EClockVal now;
+
+  read_clock(&now);
+  if (phase_count < MAX_STATS_PHASES)
+  {
+    phase_times[phase_count].name = name;
+    phase_times[phase_count].micros = clock_micros(&phase_start, &now);
+    phase_count++;
+  }
+  else
+  {
+    phases_dropped++;
+    dropped_micros += clock_micros(&phase_start, &now);
+  }
+  phase_start = now;
+}
+
+/**
+ * Copy the counters and phase times collected so far
+ *
+ * @param stats RunStats to fill; phases points into the live table
+ */
+VOID get_run_stats(RunStats *stats)
+{
+  stats->lines_read = lines_read;
+  stats->lines_rewritten = lines_rewritten;
+  stats->bytes_written = bytes_written;
+  stats->alloc_count = alloc_count;
+  stats->free_count = free_count;
+  stats->heap_in_use = heap_in_use;
+  stats->peak_heap = peak_heap;
+  stats->phases = phase_times;
+  stats->phase_count = phase_count;
+  stats->phases_dropped = phases_dropped;
+  stats->dropped_micros = dropped_micros;
+}
+
+/**
+ * Print the phase times and counters collected for STATS
+ */
+VOID report_stats(VOID)
+{
+  ULONG total = 0;
+  ULONG i;
+
+  Printf("=== STATS ===\n");
+  if (eclock_rate)
+  {
+    for (i = 0; i < phase_count; i++)
+    {
+      total += phase_times[i].micros;
+      Printf("%-24s %6ld.%03ld ms\n", phase_times[i].name,
+             phase_times[i].micros / 1000, phase_times[i].micros % 1000);
+    }
+    if (phases_dropped)
+    {
+      total += dropped_micros;
+      Printf("%-24s %6ld.%03ld ms (%ld phase(s))\n", "Other phases",
+             dropped_micros / 1000, dropped_micros % 1000, phases_dropped);
+    }
+    Printf("%-24s %6ld.%03ld ms\n", "Total", total / 1000, total % 1000);
+  }
+  else
+  {
+    Printf("Phase times unavailable (timer.device could not be opened)\n");
+  }
+  Printf("Lines: %ld read, %ld rewritten; %ld bytes written\n",
+         lines_read, lines_rewritten, bytes_written);
+  Printf("Memory: %ld allocation(s), %ld release(s), peak %ld bytes\n",
+         alloc_count, free_count, peak_heap);
+  Printf("=== END STATS ===\n\n");
+}
+
+/**
+ * Initialize a ColorList structure
+ * The entry block is allocated by the first add_color_entry.
+ *
+ * @param list Pointer to ColorList to initialize
+ */
+VOID init_color_list(ColorList *list)
+{
+  if (!list) return;
+
+  list->entries = NULL;
+  list->count = 0;
+}
+
+/**
+ * Empty a ColorList but keep its entry block for reuse
+ *
+ * @param list ColorList to empty
+ */
+VOID clear_color_list(ColorList *list)
+{
+  if (!list) return;
+
+  list->count = 0;
+}
+
+/**
+ * Add a color entry to the list
+ * Entries live inline in one block, so a whole theme costs one allocation.
+ *
+ * @param list ColorList to add entry to
+ * @param kind LINE_CURSORCOLOR or LINE_COLOR
+ * @param color Parsed flags and channels of the entry
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL add_color_entry(ColorList *list, LineKind kind, const ColorRecord *color)
+{
+  ColorEntry *entry;
+
+  if (!list || !color) return FALSE;
+
+  if (list->count >= MAX_COLOR_ENTRIES) return FALSE;
+
+  if (!list->entries)
+  {
+    list->entries = alloc_mem(MAX_COLOR_ENTRIES * sizeof(ColorEntry), MEMF_CLEAR);
+    if (!list->entries) return FALSE;
+  }
+
+  entry = &list->entries[list->count];
+  entry->kind = kind;
+  entry->color = *color;
+  list->count++;
+  return TRUE;
+}
+
+/**
+ * Add a black default entry with the LOAD/ANSI overrides applied
+ *
+ * @param list ColorList to add entry to
+ * @param kind LINE_CURSORCOLOR or LINE_COLOR
+ * @param overrides Optional color overrides to apply
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL add_default_entry(ColorList *list, LineKind kind, ColorOverrides *overrides)
+{
+  ColorRecord color;
+
+  memset(&color, 0, sizeof(color));
+  apply_overrides(&color, overrides);
+
+  return add_color_entry(list, kind, &color);
+}
+
+/**
+ * Free all memory used by a ColorList
+ *
+ * @param list ColorList to free
+ */
+VOID free_color_list(ColorList *list)
+{
+  if (!list) return;
+
+  if (list->entries)
+  {
+    free_mem(list->entries, MAX_COLOR_ENTRIES * sizeof(ColorEntry));
+  }
+
+  init_color_list(list);
+}
+
+/**
+ * Generate default color entries (CURSORCOLOR + 16 COLOR lines)
+ *
+ * @param colors ColorList to populate with default entries
+ * @param overrides Optional color overrides to apply
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL generate_default_colors(ColorList *colors, ColorOverrides *overrides)
+{
+  ULONG i;
+
+  if (!colors) return FALSE;
+
+  clear_color_list(colors);
+
+  /* Add default cursor color */
+  if (!add_default_entry(colors, LINE_CURSORCOLOR, overrides))
+  {
+    return FALSE;
+  }
+
+  /* Add 16 default color entries */
+  for (i = 0; i < REQUIRED_COLOR_LINES; i++)
+  {
+    if (!add_default_entry(colors, LINE_COLOR, overrides))
+    {
+      free_color_list(colors);
+      return FALSE;
+    }
+  }
+
+  Printf("Generated %ld default color entries\n", colors->count);
+  return TRUE;
+}
+
+/**
+ * Display color entries with RGB values for checking
+ *
+ * @param colors ColorList containing color entries to display
+ */
+VOID display_color_check(ColorList *colors)
+{
+  UBYTE line[CANONICAL_LINE_SIZE];
+  ColorEntry *entry;
+  ULONG i;
+
+  if (!colors) return;
+
+  Printf("=== COLOR CHECK - %ld entries to be written ===\n", colors->count);
+
+  for (i = 0; i < colors->count; i++)
+  {
+    entry = &colors->entries[i];
+    format_color_line(entry->kind, &entry->color, line);
+
+    /* Show the 8-bit equivalents of the 16-bit channels */
+    Printf("%2ld: %s RGB(%ld,%ld,%ld)\n", i + 1, line,
+           (ULONG)(entry->color.red >> 8),
+           (ULONG)(entry->color.green >> 8),
+           (ULONG)(entry->color.blue >> 8));
+  }
+
+  Printf("Memory: %ld allocation(s), %ld release(s) so far\n", alloc_count, free_count);
+  Printf("=== END COLOR CHECK ===\n\n");
+}
+
+/**
+ * Free the buffer of a loaded file
+ *
+ * @param text TextFile to free
+ */
+VOID free_text_file(TextFile *text)
+{
+#ifdef HOST_MMAP
+  if (text->buffer && text->mapped)
+  {
+    host_unmap_file(text->buffer, text->alloc_size);
+    text->buffer = NULL;
+  }
+#endif
+  if (text->buffer)
+  {
+    free_mem(text->buffer, text->alloc_size);
+  }
+  text->buffer = NULL;
+  text->mapped = FALSE;
+  text->size = 0;
+  text->alloc_size = 0;
+  text->next = NULL;
+}
+
+/**
+ * Load a whole file into a TextFile, keeping the buffer it already has
+ * The buffer is only replaced when the file does not fit, so a caller
+ * that loads many files in turn allocates for the largest of them only.
+ * On failure the buffer is freed and text->status says why, as with
+ * load_text_file.
+ *
+ * @param path Path of the file to load
+ * @param text TextFile from load_text_file or reload_text_file, or freed
+ * @return TRUE on success, FALSE if the file could not be opened or read
+ */
+BOOL reload_text_file(const UBYTE *path, TextFile *text)
+{
+  struct FileInfoBlock *fib;
+  BPTR file;
+  LONG bytes_read = 0;
+  LONG known_size = -1;
+
+  text->size = 0;
+  text->next = NULL;
+  text->status = TEXT_LOADED;
+  text->io_error = 0;
+
+#ifdef HOST_MMAP
+  {
+    ULONG size, map_size;
+    UBYTE *mapping = host_map_file((const char *)path, &size, &map_size);
+
+    if (mapping)
+    {
+      free_text_file(text);
+      text->buffer = mapping;
+      text->size = size;
+      text->alloc_size = map_size;
+      text->mapped = TRUE;
+      text->next = text->buffer;
+      return TRUE;
+    }
+    if (text->mapped) free_text_file(text);
+  }
+#endif
+
+  file = Open((STRPTR)path, MODE_OLDFILE);
+  if (!file)
+  {
+    text->io_error = IoErr();
+    text->status = (text->io_error == ERROR_OBJECT_NOT_FOUND) ? TEXT_MISSING : TEXT_OPEN_FAILED;
+    return FALSE;
+  }
+
+  fib = AllocDosObject(DOS_FIB, NULL);
+  if (fib)
+  {
+    if (ExamineFH(file, fib))
+    {
+      known_size = fib->fib_Size;
+    }
+    FreeDosObject(DOS_FIB, fib);
+  }
+
+  if (known_size >= 0)
+  {
+    /* Regular file: at most one allocation and one Read, plus room for the NUL */
+    if (text->alloc_size < (ULONG)known_size + 1)
+    {
+      free_text_file(text);
+      text->alloc_size = (ULONG)known_size + 1;
+      text->buffer = alloc_mem(text->alloc_size, MEMF_ANY);
+    }
+    if (!text->buffer)
+    {
+      text->status = TEXT_NO_MEMORY;
+    }
+    else if (known_size > 0)
+    {
+      bytes_read = Read(file, text->buffer, known_size);
+      if (bytes_read != known_size)
+      {
+        text->io_error = IoErr();
+        text->status = TEXT_READ_FAILED;
+      }
+      else
+      {
+        text->size = bytes_read;
+      }
+    }
+  }
+  else
+  {
+    /* Stream of unknown size: read in chunks, doubling the buffer */
+    while (bytes_read >= 0)
+    {
+      if (text->size + BUFFER_SIZE + 1 > text->alloc_size)
+      {
+        ULONG new_size = text->alloc_size ? text->alloc_size * 2 : BUFFER_SIZE + 1;
+        UBYTE *larger = alloc_mem(new_size, MEMF_ANY);
+        if (!larger)
+        {
+          text->status = TEXT_NO_MEMORY;
+          break;
+        }
+        if (text->buffer)
+        {
+          CopyMem(text->buffer, larger, text->size);
+          free_mem(text->buffer, text->alloc_size);
+        }
+        text->buffer = larger;
+        text->alloc_size = new_size;
+      }
+
+      bytes_read = Read(file, text->buffer + text->size, BUFFER_SIZE);
+      if (bytes_read < 0)
+      {
+        text->io_error = IoErr();
+        text->status = TEXT_READ_FAILED;
+      }
+      if (bytes_read <= 0) break;
+      text->size += bytes_read;
+    }
+  }
+
+  Close(file);
+
+  if (text->status != TEXT_LOADED)
+  {
+    if (text->status == TEXT_NO_MEMORY)
+    {
+      Printf("ERROR: Out of memory reading '%s'\n", path);
+    }
+    else if (known_size >= 0)
+    {
+      Printf("ERROR: Could not read '%s' (%ld of %ld bytes, error %ld)\n", path,
+             bytes_read < 0 ? 0 : bytes_read, known_size, text->io_error);
+    }
+    else
+    {
+      Printf("ERROR: Could not read '%s' (error %ld)\n", path, text->io_error);
+    }
+    free_text_file(text);
+    return FALSE;
+  }
+
+  text->buffer[text->size] = '\0';
+  text->next = text->buffer;
+  return TRUE;
+}
+
+/**
+ * Load a whole file into memory with as few reads as possible
+ * The size comes from ExamineFH so regular files take one Read. Handlers
+ * that cannot report a size are read in BUFFER_SIZE chunks instead.
+ * On failure text->status says why; only memory and read failures are
+ * reported here, a missing or unopenable file is left to the caller.
+ * The host build with HOST_MMAP maps regular files instead, so the same
+ * line splitting runs over the file's pages; it falls back to reading.
+ *
+ * @param path Path of the file to load
+ * @param text TextFile to fill
+ * @return TRUE on success, FALSE if the file could not be opened or read
+ */
+BOOL load_text_file(const UBYTE *path, TextFile *text)
+{
+  text->buffer = NULL;
+  text->alloc_size = 0;
+  text->mapped = FALSE;
+
+  return reload_text_file(path, text);
+}
+
+/**
+ * Return the next line of a loaded file, split in place
+ * The newline is replaced by a NUL; a carriage return before it is kept.
+ *
+ * @param text TextFile loaded with load_text_file
+ * @param offset Receives the offset of the line in the file (can be NULL)
+ * @return The line, or NULL at the end of the file
+ */
+UBYTE *next_line(TextFile *text, ULONG *offset)
+{
+  UBYTE *line = text->next;
+  UBYTE *end = text->buffer + text->size;
+  UBYTE *p;
+
+  if (!line || line >= end) return NULL;
+
+  p = line;
+  while (p < end && *p != '\n') p++;
+  *p = '\0';
+  text->next = p + 1;
+
+  if (offset) *offset = (ULONG)(line - text->buffer);
+  lines_read++;
+  return line;
+}
+
+/**
+ * Read color entries from a theme file into a caller's parse buffer
+ * Uses sequential parsing: first CURSORCOLOR=, then up to 16 COLOR= lines.
+ * The buffer is loaded with reload_text_file and left for the caller to
+ * reuse or free.
+ *
+ * @param filename Path to theme file
+ * @param text Parse buffer, see reload_text_file
+ * @param colors ColorList to populate with converted theme colors
+ * @param overrides Optional color overrides to apply
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL read_theme_text(const UBYTE *filename, TextFile *text, ColorList *colors,
+                     ColorOverrides *overrides)
+{
+  UBYTE *line;
+  ColorRecord color;
+  BOOL found_cursor_color = FALSE;
+  ULONG color_count = 0;
+  ULONG parsed_count;
+  BOOL success = TRUE;
+  LineKind kind;
+  ULONG error_pos;
+
+  if (!filename || !colors) return FALSE;
+
+  if (!reload_text_file(filename, text))
+  {
+    if (text->status == TEXT_MISSING || text->status == TEXT_OPEN_FAILED)
+    {
+      Printf("ERROR: Could not open theme file '%s'\n", filename);
+    }
+    return FALSE;
+  }
+
+  clear_color_list(colors);
+
+  /* Single pass: look for CURSORCOLOR first, then COLOR lines in sequence */
+  while (success && (line = next_line(text, NULL)))
+  {
+    /* Remove trailing carriage return */
+    ULONG len = strlen((char *)line);
+    if (len > 0 && line[len - 1] == '\r')
+    {
+      line[len - 1] = '\0';
+    }
+
+    kind = classify_line(line, NULL);
+
+    /* Check if this is a cursor color line (only if we haven't found one yet) */
+    if (!found_cursor_color && kind == LINE_CURSORCOLOR)
+    {
+      if (parse_color_line(line, &kind, &color, overrides, &error_pos))
+      {
+        if (add_color_entry(colors, kind, &color))
+        {
+          found_cursor_color = TRUE;
+        }
+        else
+        {
+          Printf("ERROR: Failed to add cursor color entry\n");
+          success = FALSE;
+          break;
+        }
+      }
+      else
+      {
+        Printf("WARNING: Could not parse cursor color line at column %ld: %s\n", error_pos + 1, line);
+      }
+    }
+    /* Check if this is a color line (only after we found cursor color) */
+    else if (found_cursor_color && color_count < REQUIRED_COLOR_LINES && kind == LINE_COLOR)
+    {
+      if (parse_color_line(line, &kind, &color, overrides, &error_pos))
+      {
+        if (add_color_entry(colors, kind, &color))
+        {
+          color_count++;
+        }
+        else
+        {
+          Printf("ERROR: Failed to add color entry\n");
+          success = FALSE;
+          break;
+        }
+      }
+      else
+      {
+        Printf("WARNING: Could not parse color line at column %ld: %s\n", error_pos + 1, line);
+      }
+    }
+
+    /* Stop if we have found cursor color and all required color lines */
+    if (found_cursor_color && color_count >= REQUIRED_COLOR_LINES)
+    {
+      break;
+    }
+  }
+
+  if (!success)
+  {
+    free_color_list(colors);
+    return FALSE;
+  }
+
+  parsed_count = color_count;
+
+  /* Fill in missing entries with defaults */
+  if (!found_cursor_color)
+  {
+    /* COLOR lines are only taken after CURSORCOLOR, so the list is empty */
+    Printf("WARNING: No CURSORCOLOR found, using default\n");
+
+    if (!add_default_entry(colors, LINE_CURSORCOLOR, overrides))
+    {
+      Printf("ERROR: Failed to add default cursor color entry\n");
+      free_color_list(colors);
+      return FALSE;
+    }
+  }
+
+  /* Add default COLOR entries for any missing ones */
+  while (color_count < REQUIRED_COLOR_LINES)
+  {
+    if (!add_default_entry(colors, LINE_COLOR, overrides))
+    {
+      Printf("ERROR: Failed to add default color entry\n");
+      free_color_list(colors);
+      return FALSE;
+    }
+    color_count++;
+  }
+
+  Printf("Loaded theme: %s CURSORCOLOR, %ld COLOR entries (%ld defaults added)\n",
+         found_cursor_color ? "found" : "default",
+         color_count,
+         (found_cursor_color ? 0 : 1) + (REQUIRED_COLOR_LINES - parsed_count));
+
+  return TRUE;
 }
 
 /**
  * Read color entries from a theme file and convert to ViNCEd format
- * Uses sequential parsing: first CURSORCOLOR=, then up to 16 COLOR= lines
  *
- * @param filename Path to theme file
- * @param colors ColorList to populate with converted theme colors
- * @param overrides Optional color overrides to apply
+ * @param filename Path to theme file
+ * @param colors ColorList to populate with converted theme colors
+ * @param overrides Optional color overrides to apply
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL read_theme_file(const UBYTE *filename, ColorList *colors, ColorOverrides *overrides)
+{
+  TextFile text;
+  BOOL success;
+
+  text.buffer = NULL;
+  text.alloc_size = 0;
+  text.mapped = FALSE;
+
+  success = read_theme_text(filename, &text, colors, overrides);
+  free_text_file(&text);
+  return success;
+}
+
+/**
+ * Get the modification date of a file
+ *
+ * @param path Path of the file
+ * @param date Receives the file's datestamp
+ * @return TRUE on success, FALSE if the file could not be examined
+ */
+BOOL get_file_date(const UBYTE *path, struct DateStamp *date)
+{
+  struct FileInfoBlock *fib;
+  BPTR lock;
+  BOOL success = FALSE;
+
+  lock = Lock((STRPTR)path, ACCESS_READ);
+  if (!lock) return FALSE;
+
+  fib = AllocDosObject(DOS_FIB, NULL);
+  if (fib)
+  {
+    if (Examine(lock, fib))
+    {
+      *date = fib->fib_Date;
+      success = TRUE;
+    }
+    FreeDosObject(DOS_FIB, fib);
+  }
+
+  UnLock(lock);
+  return success;
+}
+
+/**
+ * Calculate a rotate-and-add checksum of a block of bytes
+ *
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param sum Starting value
+ * @return 32-bit checksum
+ */
+ULONG checksum_bytes(const UBYTE *data, ULONG length, ULONG sum)
+{
+  const UBYTE *end = data + length;
+
+  while (data < end)
+  {
+    /* Rotate left by 5 and add, so swapped bytes change the result */
+    sum = ((sum << 5) | (sum >> 27)) + *data++;
+  }
+
+  return sum;
+}
+
+/**
+ * Calculate the checksum of a compiled theme
+ * Covers every byte after the checksum field.
+ *
+ * @param theme Compiled theme to checksum
+ * @return 32-bit checksum
+ */
+ULONG checksum_compiled_theme(const CompiledTheme *theme)
+{
+  const UBYTE *start = (const UBYTE *)&theme->source_date;
+  const UBYTE *end = (const UBYTE *)theme + sizeof(CompiledTheme);
+
+  return checksum_bytes(start, (ULONG)(end - start), theme->magic);
+}
+
+/**
+ * Compile a ColorList produced by read_theme_file into a cache record
+ *
+ * @param colors ColorList with CURSORCOLOR first, then 16 COLOR entries
+ * @param theme Compiled theme to fill (source_date and checksum are not set)
+ * @return TRUE on success, FALSE if the list is not a complete theme
+ */
+BOOL compile_theme(ColorList *colors, CompiledTheme *theme)
+{
+  ColorEntry *entry;
+  ULONG color_index = 0;
+  ULONG i;
+  BOOL found_cursor_color = FALSE;
+
+  if (!colors || !theme) return FALSE;
+
+  memset(theme, 0, sizeof(CompiledTheme));
+  theme->magic = CACHE_MAGIC;
+  theme->version = CACHE_VERSION;
+  theme->entry_count = MAX_COLOR_ENTRIES;
+
+  for (i = 0; i < colors->count; i++)
+  {
+    entry = &colors->entries[i];
+
+    if (entry->kind == LINE_CURSORCOLOR)
+    {
+      theme->cursor = entry->color;
+      found_cursor_color = TRUE;
+    }
+    else if (color_index < REQUIRED_COLOR_LINES)
+    {
+      theme->colors[color_index++] = entry->color;
+    }
+  }
+
+  return (BOOL)(found_cursor_color && color_index == REQUIRED_COLOR_LINES);
+}
+
+/**
+ * Fill a ColorList from a compiled theme
+ *
+ * @param theme Compiled theme to expand
+ * @param colors ColorList to populate
+ * @param overrides Optional color overrides to apply
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL expand_compiled_theme(const CompiledTheme *theme, ColorList *colors, ColorOverrides *overrides)
+{
+  ColorRecord record;
+  ULONG i;
+
+  if (!theme || !colors) return FALSE;
+
+  clear_color_list(colors);
+
+  record = theme->cursor;
+  apply_overrides(&record, overrides);
+  if (!add_color_entry(colors, LINE_CURSORCOLOR, &record)) return FALSE;
+
+  for (i = 0; i < REQUIRED_COLOR_LINES; i++)
+  {
+    record = theme->colors[i];
+    apply_overrides(&record, overrides);
+    if (!add_color_entry(colors, LINE_COLOR, &record))
+    {
+      free_color_list(colors);
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+ * Read a compiled theme cache if it is valid for the given source date
+ *
+ * @param cache_path Path of the cache file
+ * @param source_date Current datestamp of the theme file
+ * @param theme Receives the compiled theme
+ * @return TRUE if the cache is present, intact and up to date
+ */
+BOOL read_theme_cache(const UBYTE *cache_path, const struct DateStamp *source_date,
+                      CompiledTheme *theme)
+{
+  BPTR file;
+  LONG bytes_read;
+
+  file = Open((STRPTR)cache_path, MODE_OLDFILE);
+  if (!file) return FALSE;
+
+  bytes_read = Read(file, theme, sizeof(CompiledTheme));
+  Close(file);
+
+  return (BOOL)(bytes_read == sizeof(CompiledTheme) &&
+                theme->magic == CACHE_MAGIC &&
+                theme->version == CACHE_VERSION &&
+                theme->entry_count == MAX_COLOR_ENTRIES &&
+                CompareDates((struct DateStamp *)source_date, &theme->source_date) == 0 &&
+                theme->checksum == checksum_compiled_theme(theme));
+}
+
+/**
+ * Write a compiled theme cache
+ * Failing to create the file is not an error: the theme may live on
+ * read-only media, in which case it is simply parsed every time.
+ *
+ * @param cache_path Path of the cache file
+ * @param theme Compiled theme to write, checksum is filled in here
+ * @return TRUE if the cache was written, FALSE otherwise
+ */
+BOOL write_theme_cache(const UBYTE *cache_path, CompiledTheme *theme)
+{
+  BPTR file;
+  BOOL success;
+
+  theme->checksum = checksum_compiled_theme(theme);
+
+  file = Open((STRPTR)cache_path, MODE_NEWFILE);
+  if (!file) return FALSE;
+
+  success = (BOOL)(Write(file, theme, sizeof(CompiledTheme)) == sizeof(CompiledTheme));
+  if (!Close(file)) success = FALSE;
+  if (success) bytes_written += sizeof(CompiledTheme);
+
+  if (!success)
+  {
+    Printf("WARNING: Could not write theme cache '%s'\n", cache_path);
+    DeleteFile((STRPTR)cache_path);
+  }
+
+  return success;
+}
+
+/**
+ * Load a theme, using its compiled cache when it is up to date
+ * The cache is "<filename>.vtc" and stores the theme without overrides.
+ * A missing or stale cache is rebuilt from the text theme file only with
+ * CACHE_WRITE, which is set for the actions that write preferences; CHECK,
+ * VIEW and the others leave the theme directory as it is.
+ *
+ * @param filename Path to theme file
+ * @param colors ColorList to populate with converted theme colors
+ * @param overrides Optional color overrides to apply
+ * @param cache_flags CACHE_ flags, 0 to always parse the text theme file
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL load_theme(const UBYTE *filename, ColorList *colors, ColorOverrides *overrides,
+                ULONG cache_flags)
+{
+  UBYTE cache_path[MAX_PATH_LENGTH];
+  struct DateStamp source_date;
+  CompiledTheme theme;
+
+  if (!filename || !colors) return FALSE;
+
+  if (!(cache_flags & CACHE_READ) ||
+      strlen((const char *)filename) + sizeof(CACHE_SUFFIX) > sizeof(cache_path) ||
+      !get_file_date(filename, &source_date))
+  {
+    return read_theme_file(filename, colors, overrides);
+  }
+
+  sprintf((char *)cache_path, "%s%s", filename, CACHE_SUFFIX);
+
+  if (read_theme_cache(cache_path, &source_date, &theme))
+  {
+    if (!expand_compiled_theme(&theme, colors, overrides)) return FALSE;
+    Printf("Loaded theme from compiled cache '%s'\n", cache_path);
+    return TRUE;
+  }
+
+  if (!(cache_flags & CACHE_WRITE))
+  {
+    return read_theme_file(filename, colors, overrides);
+  }
+
+  /* Stale or missing: parse without overrides so the cache stays neutral */
+  if (!read_theme_file(filename, colors, NULL)) return FALSE;
+
+  if (!compile_theme(colors, &theme))
+  {
+    return read_theme_file(filename, colors, overrides);
+  }
+
+  theme.source_date = source_date;
+  if (write_theme_cache(cache_path, &theme))
+  {
+    Printf("Rebuilt compiled cache '%s'\n", cache_path);
+  }
+
+  if (overrides && (overrides->override_load || overrides->override_ansi))
+  {
+    return expand_compiled_theme(&theme, colors, overrides);
+  }
+
+  return TRUE;
+}
+
+/**
+ * Write one color entry as a canonical ViNCEd line
+ *
+ * @param file Open file to write to
+ * @param entry Color entry to write
+ * @return TRUE on success, FALSE on a write error
+ */
+BOOL write_color_entry(BPTR file, const ColorEntry *entry)
+{
+  UBYTE line[CANONICAL_LINE_SIZE];
+
+  format_color_line(entry->kind, &entry->color, line);
+  if (FPuts(file, (STRPTR)line) || FPuts(file, "\n")) return FALSE;
+
+  bytes_written += strlen((char *)line) + 1;
+  return TRUE;
+}
+
+/**
+ * Write a complete ;Colors: block in canonical ViNCEd format
+ *
+ * @param file Open file to write to
+ * @param colors ColorList with CURSORCOLOR first, then the COLOR entries
+ * @return TRUE on success, FALSE on a write error
+ */
+BOOL write_color_block(BPTR file, ColorList *colors)
+{
+  ULONG i;
+
+  if (!file || !colors) return FALSE;
+
+  if (FPuts(file, ";Colors:\n")) return FALSE;
+  bytes_written += 9;
+
+  for (i = 0; i < colors->count; i++)
+  {
+    if (!write_color_entry(file, &colors->entries[i])) return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * Parse a color line of a loaded preferences file without splitting it
+ *
+ * @param line Start of the line, terminated by a newline or NUL
+ * @param length Length of the line without the newline
+ * @param kind Receives LINE_CURSORCOLOR or LINE_COLOR
+ * @param color Receives the parsed flags and channels
+ * @return TRUE on success, FALSE if the line cannot be parsed
+ */
+BOOL parse_prefs_line(const UBYTE *line, ULONG length, LineKind *kind, ColorRecord *color)
+{
+  UBYTE line_text[CANONICAL_LINE_SIZE * 2];
+
+  if (length >= sizeof(line_text)) return FALSE;
+
+  CopyMem((APTR)line, line_text, length);
+  line_text[length] = '\0';
+
+  return parse_color_line(line_text, kind, color, NULL, NULL);
+}
+
+/**
+ * Check whether a color line of a preferences file already holds an entry
+ * The line need not be in canonical form; its parsed fields are compared.
+ *
+ * @param line Start of the line, terminated by a newline or NUL
+ * @param length Length of the line without the newline
+ * @param entry Entry to compare with
+ * @return TRUE if the line holds the same kind, flags and channels
+ */
+BOOL color_line_matches(const UBYTE *line, ULONG length, const ColorEntry *entry)
+{
+  ColorRecord color;
+  LineKind kind;
+
+  if (!parse_prefs_line(line, length, &kind, &color)) return FALSE;
+
+  return (BOOL)(kind == entry->kind &&
+                color.flags == entry->color.flags &&
+                color.red == entry->color.red &&
+                color.green == entry->color.green &&
+                color.blue == entry->color.blue);
+}
+
+/**
+ * Find the color lines of a loaded preferences file that have to change
+ * Lines that already hold their new entry are left out. The file can be
+ * patched in place when every changed line keeps its byte length and no
+ * entry would have to be appended. The file is scanned without splitting it.
+ *
+ * @param text Preferences file loaded with load_text_file
+ * @param colors Replacement entries
+ * @param patches Array of MAX_COLOR_ENTRIES patches to fill
+ * @param patch_count Receives the number of patches
+ * @param unchanged Receives TRUE if the file already holds every entry
+ * @return TRUE if the file can be patched in place, FALSE otherwise
+ */
+BOOL plan_prefs_patch(TextFile *text, const PrefsColors *colors,
+                      PrefsPatch *patches, ULONG *patch_count, BOOL *unchanged)
+{
+  UBYTE line_text[CANONICAL_LINE_SIZE];
+  const UBYTE *line = text->buffer;
+  const UBYTE *end = text->buffer + text->size;
+  const UBYTE *eol;
+  const ColorEntry *entry;
+  ULONG current_color_index = 0;
+  ULONG length;
+  BOOL same_length = TRUE;
+  BOOL canonical;
+  LineKind kind;
+
+  *patch_count = 0;
+  *unchanged = FALSE;
+
+  while (line < end)
+  {
+    eol = line;
+    while (eol < end && *eol != '\n') eol++;
+
+    /* A carriage return before the newline stays in place */
+    length = (ULONG)(eol - line);
+    if (length > 0 && line[length - 1] == '\r') length--;
+    lines_read++;
+
+    entry = NULL;
+    kind = classify_line(line, NULL);
+    if (kind == LINE_CURSORCOLOR)
+    {
+      entry = colors->cursor;
+    }
+    else if (kind == LINE_COLOR)
+    {
+      if (current_color_index < colors->color_count)
+      {
+        entry = colors->colors[current_color_index];
+      }
+      current_color_index++;
+    }
+
+    if (entry)
+    {
+      format_color_line(entry->kind, &entry->color, line_text);
+      canonical = (BOOL)(strlen((char *)line_text) == length);
+
+      if (!(canonical && memcmp(line_text, line, length) == 0) &&
+          !color_line_matches(line, length, entry))
+      {
+        if (*patch_count == MAX_COLOR_ENTRIES) return FALSE;
+        if (!canonical) same_length = FALSE;
+
+        patches[*patch_count].offset = (ULONG)(line - text->buffer);
+        patches[*patch_count].entry = entry;
+        (*patch_count)++;
+      }
+    }
+
+    line = eol + 1;
+  }
+
+  if (current_color_index < colors->color_count) return FALSE;
+
+  *unchanged = (BOOL)(*patch_count == 0);
+  return same_length;
+}
+
+/**
+ * Overwrite the planned color lines of a preferences file in place
+ * The replacements are laid over the loaded copy. Each run of adjacent
+ * patched lines goes out with a single Seek and Write, so lines that
+ * already hold their colors are not written.
+ *
+ * @param prefs_path Path of the preferences file
+ * @param text Loaded copy of the file, updated with the replacements
+ * @param patches Patches from plan_prefs_patch, in file order
+ * @param patch_count Number of patches, at least one
+ * @return TRUE on success, FALSE if the file could not be patched
+ */
+BOOL patch_prefs_file(const UBYTE *prefs_path, TextFile *text,
+                      PrefsPatch *patches, ULONG patch_count)
+{
+  UBYTE line_text[CANONICAL_LINE_SIZE];
+  ULONG span_start = 0;
+  ULONG span_end = 0;
+  ULONG length;
+  LONG span_length;
+  BPTR file;
+  BOOL success = TRUE;
+  ULONG i;
+
+  file = Open((STRPTR)prefs_path, MODE_READWRITE);
+  if (!file) return FALSE;
+
+  for (i = 0; i < patch_count && success; i++)
+  {
+    format_color_line(patches[i].entry->kind, &patches[i].entry->color, line_text);
+    length = strlen((char *)line_text);
+    CopyMem(line_text, text->buffer + patches[i].offset, length);
+
+    /* Lines separated only by a line end share one span */
+    if (i == 0 || patches[i].offset > span_end + 2)
+    {
+      span_start = patches[i].offset;
+    }
+    span_end = patches[i].offset + length;
+
+    if (i + 1 == patch_count || patches[i + 1].offset > span_end + 2)
+    {
+      span_length = (LONG)(span_end - span_start);
+      success = (BOOL)(Seek(file, (LONG)span_start, OFFSET_BEGINNING) >= 0 &&
+                       Write(file, text->buffer + span_start, span_length) == span_length);
+      if (success) bytes_written += span_length;
+    }
+  }
+
+  if (!Close(file)) success = FALSE;
+
+  return success;
+}
+
+/**
+ * Arrange new colors as replacements for the lines of a preferences file
+ *
+ * @param new_colors ColorList containing new color entries
+ * @param colors Receives the cursor entry and the COLOR entries in order
+ */
+VOID organize_prefs_colors(ColorList *new_colors, PrefsColors *colors)
+{
+  const ColorEntry *color_entry;
+  ULONG i;
+
+  colors->cursor = NULL;
+  colors->color_count = 0;
+
+  /* Separate cursor color from regular colors */
+  for (i = 0; i < new_colors->count; i++)
+  {
+    color_entry = &new_colors->entries[i];
+    if (color_entry->kind == LINE_CURSORCOLOR)
+    {
+      colors->cursor = color_entry;
+    }
+    else if (color_entry->kind == LINE_COLOR && colors->color_count < REQUIRED_COLOR_LINES)
+    {
+      colors->colors[colors->color_count++] = color_entry;
+    }
+  }
+}
+
+/**
+ * Append bytes to an output buffer, growing it when needed
+ *
+ * @param out Output buffer
+ * @param data Bytes to append
+ * @param length Number of bytes
+ * @return TRUE on success, FALSE if out of memory
+ */
+BOOL append_text(TextFile *out, const void *data, ULONG length)
+{
+  if (out->size + length > out->alloc_size)
+  {
+    ULONG new_size = out->alloc_size * 2;
+    UBYTE *larger;
+
+    if (new_size < out->size + length) new_size = out->size + length;
+
+    larger = alloc_mem(new_size, MEMF_ANY);
+    if (!larger) return FALSE;
+    if (out->buffer)
+    {
+      CopyMem(out->buffer, larger, out->size);
+      free_mem(out->buffer, out->alloc_size);
+    }
+    out->buffer = larger;
+    out->alloc_size = new_size;
+  }
+
+  CopyMem((APTR)data, out->buffer + out->size, length);
+  out->size += length;
+  return TRUE;
+}
+
+/**
+ * Append one color entry to an output buffer as a canonical ViNCEd line
+ *
+ * @param out Output buffer
+ * @param entry Color entry to append
+ * @return TRUE on success, FALSE if out of memory
+ */
+BOOL append_color_entry(TextFile *out, const ColorEntry *entry)
+{
+  UBYTE line[CANONICAL_LINE_SIZE];
+
+  format_color_line(entry->kind, &entry->color, line);
+  return (BOOL)(append_text(out, line, strlen((const char *)line)) && append_text(out, "\n", 1));
+}
+
+/**
+ * Check whether a text ends in a newline, which rebuilt files keep as it is
+ *
+ * @param text Loaded text
+ * @return TRUE if the last byte is a newline
+ */
+BOOL ends_in_newline(const TextFile *text)
+{
+  return (BOOL)(text->size > 0 && text->buffer[text->size - 1] == '\n');
+}
+
+/**
+ * Check whether two preferences files would be rebuilt to the same output
+ * That is the case when they differ at most in the color lines that get
+ * replaced; both files are scanned without splitting them.
+ *
+ * @param first First target
+ * @param second Second target
+ * @param colors Replacement entries
+ * @return TRUE if rebuilding either file gives the same bytes
+ */
+BOOL same_prefs_layout(PrefsTarget *first, PrefsTarget *second, const PrefsColors *colors)
+{
+  const UBYTE *line_a, *line_b;
+  const UBYTE *end_a, *end_b;
+  const UBYTE *eol_a, *eol_b;
+  ULONG current_color_index = 0;
+  BOOL replaced;
+  LineKind kind;
+
+  if (!first->have_text || !second->have_text)
+  {
+    return (BOOL)(!first->have_text && !second->have_text);
+  }
+  if (ends_in_newline(&first->text) != ends_in_newline(&second->text)) return FALSE;
+
+  line_a = first->text.buffer;
+  end_a = line_a + first->text.size;
+  line_b = second->text.buffer;
+  end_b = line_b + second->text.size;
+
+  while (line_a < end_a && line_b < end_b)
+  {
+    eol_a = line_a;
+    while (eol_a < end_a && *eol_a != '\n') eol_a++;
+    eol_b = line_b;
+    while (eol_b < end_b && *eol_b != '\n') eol_b++;
+
+    kind = classify_line(line_a, NULL);
+    if (classify_line(line_b, NULL) != kind) return FALSE;
+
+    replaced = FALSE;
+    if (kind == LINE_CURSORCOLOR)
+    {
+      replaced = (BOOL)(colors->cursor != NULL);
+    }
+    else if (kind == LINE_COLOR)
+    {
+      replaced = (BOOL)(current_color_index < colors->color_count);
+      current_color_index++;
+    }
+
+    /* Lines that are copied through must match byte for byte */
+    if (!replaced &&
+        (eol_a - line_a != eol_b - line_b ||
+         memcmp(line_a, line_b, (size_t)(eol_a - line_a)) != 0))
+    {
+      return FALSE;
+    }
+
+    line_a = eol_a + 1;
+    line_b = eol_b + 1;
+  }
+
+  return (BOOL)(line_a >= end_a && line_b >= end_b);
+}
+
+/**
+ * Build the new contents of a preferences file in memory
+ * Replaces existing color lines in their current positions and adds new
+ * ones if missing. The loaded file is scanned without splitting it, and
+ * the output ends in a newline only if the file did.
+ *
+ * @param target Target whose output is built from its loaded contents
+ * @param colors Replacement entries
+ * @return TRUE on success, FALSE if out of memory
+ */
+BOOL build_prefs_output(PrefsTarget *target, const PrefsColors *colors)
+{
+  TextFile *out = &target->output;
+  const UBYTE *line;
+  const UBYTE *end;
+  const UBYTE *eol;
+  ULONG current_color_index = 0;
+  BOOL found_colors_section = FALSE;
+  BOOL ok = TRUE;
+  LineKind kind;
+
+  /* Room for the old file plus a full color block avoids regrowing */
+  out->size = 0;
+  target->rewritten = 0;
+  out->alloc_size = (target->have_text ? target->text.size : 0) +
+                    (MAX_COLOR_ENTRIES + 1) * CANONICAL_LINE_SIZE;
+  out->buffer = alloc_mem(out->alloc_size, MEMF_ANY);
+  if (!out->buffer)
+  {
+    out->alloc_size = 0;
+    return FALSE;
+  }
+
+  if (target->have_text)
+  {
+    line = target->text.buffer;
+    end = line + target->text.size;
+
+    while (ok && line < end)
+    {
+      eol = line;
+      while (eol < end && *eol != '\n') eol++;
+
+      kind = classify_line(line, NULL);
+
+      if (kind == LINE_CURSORCOLOR && colors->cursor)
+      {
+        /* Replace existing cursor color line */
+        ok = append_color_entry(out, colors->cursor);
+        target->rewritten++;
+      }
+      else if (kind == LINE_COLOR && current_color_index < colors->color_count)
+      {
+        /* Replace existing color line */
+        ok = append_color_entry(out, colors->colors[current_color_index++]);
+        target->rewritten++;
+      }
+      else
+      {
+        if (kind == LINE_COLOR)
+        {
+          current_color_index++;
+        }
+        else if (kind == LINE_COLORS_MARKER)
+        {
+          found_colors_section = TRUE;
+        }
+
+        /* Copy all other lines unchanged */
+        ok = (BOOL)(append_text(out, line, (ULONG)(eol - line)) && append_text(out, "\n", 1));
+      }
+
+      line = eol + 1;
+    }
+  }
+  else
+  {
+    /* No existing file - create new one with all entries */
+    if (colors->cursor)
+    {
+      ok = (BOOL)(append_text(out, ";Colors:\n", 9) && append_color_entry(out, colors->cursor));
+      found_colors_section = TRUE;
+      target->rewritten++;
+    }
+  }
+
+  /* Add any remaining new color entries that weren't replacements */
+  if (ok && current_color_index < colors->color_count && !found_colors_section)
+  {
+    ok = append_text(out, ";Colors:\n", 9);
+  }
+  while (ok && current_color_index < colors->color_count)
+  {
+    ok = append_color_entry(out, colors->colors[current_color_index++]);
+    target->rewritten++;
+  }
+
+  /* Every line above was ended; keep a last line the file left open */
+  if (ok && target->have_text && target->text.size > 0 && !ends_in_newline(&target->text) &&
+      ends_in_newline(out))
+  {
+    out->size--;
+  }
+
+  if (!ok) free_text_file(out);
+  return ok;
+}
+
+/**
+ * Replace a preferences file with new contents through a temporary copy
+ *
+ * @param prefs_path Path of the preferences file
+ * @param output New contents
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL replace_prefs_file(const UBYTE *prefs_path, TextFile *output)
+{
+  UBYTE temp_path[256];
+  BPTR new_file;
+  BOOL written;
+
+  /* Create temporary file name */
+  sprintf((char *)temp_path, "%s.tmp", prefs_path);
+
+  new_file = Open((STRPTR)temp_path, MODE_NEWFILE);
+  if (!new_file)
+  {
+    Printf("ERROR: Could not create temporary file '%s'\n", temp_path);
+    return FALSE;
+  }
+
+  written = (BOOL)(Write(new_file, output->buffer, (LONG)output->size) == (LONG)output->size);
+  if (!Close(new_file)) written = FALSE;
+
+  if (!written)
+  {
+    Printf("ERROR: Could not write temporary file '%s'\n", temp_path);
+    DeleteFile((STRPTR)temp_path);
+    return FALSE;
+  }
+  bytes_written += output->size;
+
+  /* Replace original file with temporary file */
+  DeleteFile((STRPTR)prefs_path);
+  if (!Rename((STRPTR)temp_path, (STRPTR)prefs_path))
+  {
+    Printf("ERROR: Could not replace original file '%s'\n", prefs_path);
+    DeleteFile((STRPTR)temp_path);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * Integer square root, rounded down
+ *
+ * @param value Value to take the root of
+ * @return Largest root whose square does not exceed value
+ */
+ULONG isqrt(ULONG value)
+{
+  ULONG root = 0;
+  ULONG bit = 1UL << 30;
+
+  while (bit > value) bit >>= 2;
+
+  while (bit)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+/**
+ * Perceptual distance between two colors using the "redmean" weighting
+ * Works on the 8-bit channels; 0 is identical, about 765 is black to white.
+ *
+ * @param a First color
+ * @param b Second color
+ * @return Weighted Euclidean distance
+ */
+ULONG color_distance(const ColorRecord *a, const ColorRecord *b)
+{
+  LONG r1 = a->red >> 8, g1 = a->green >> 8, b1 = a->blue >> 8;
+  LONG r2 = b->red >> 8, g2 = b->green >> 8, b2 = b->blue >> 8;
+  LONG rmean = (r1 + r2) / 2;
+  LONG dr = r1 - r2, dg = g1 - g2, db = b1 - b2;
+
+  return isqrt((ULONG)((((512 + rmean) * dr * dr) >> 8) +
+                       4 * dg * dg +
+                       (((767 - rmean) * db * db) >> 8)));
+}
+
+/**
+ * Print the entries of a preferences file that differ from the new colors
+ * Slot 0 is the first CURSORCOLOR line, slots 1-16 the COLOR lines in order.
+ *
+ * @param target Loaded target, before any patch is applied
+ * @param colors New entries
+ * @return Number of slots that differ
+ */
+ULONG show_prefs_diff(PrefsTarget *target, const PrefsColors *colors)
+{
+  ColorRecord old_colors[MAX_COLOR_ENTRIES];
+  UBYTE old_state[MAX_COLOR_ENTRIES];   /* 0 missing, 1 parsed, 2 unreadable */
+  UBYTE old_text[24];
+  UBYTE slot_name[16];
+  const ColorEntry *entry;
+  const UBYTE *line;
+  const UBYTE *end;
+  const UBYTE *eol;
+  ULONG current_color_index = 0;
+  ULONG differ_count = 0;
+  ULONG slot_count = 0;
+  ULONG length;
+  ULONG slot;
+  LineKind kind;
+
+  memset(old_state, 0, sizeof(old_state));
+
+  if (target->have_text)
+  {
+    line = target->text.buffer;
+    end = line + target->text.size;
+
+    while (line < end)
+    {
+      eol = line;
+      while (eol < end && *eol != '\n') eol++;
+
+      length = (ULONG)(eol - line);
+      if (length > 0 && line[length - 1] == '\r') length--;
+
+      slot = MAX_COLOR_ENTRIES;
+      kind = classify_line(line, NULL);
+      if (kind == LINE_CURSORCOLOR && !old_state[0])
+      {
+        slot = 0;
+      }
+      else if (kind == LINE_COLOR && current_color_index < REQUIRED_COLOR_LINES)
+      {
+        slot = 1 + current_color_index++;
+      }
+
+      if (slot < MAX_COLOR_ENTRIES)
+      {
+        old_state[slot] = (UBYTE)(parse_prefs_line(line, length, &kind, &old_colors[slot]) ? 1 : 2);
+      }
+
+      line = eol + 1;
+    }
+  }
+
+  Printf("=== DIFF - %s ===\n", target->path);
+
+  for (slot = 0; slot < MAX_COLOR_ENTRIES; slot++)
+  {
+    if (slot == 0)
+    {
+      entry = colors->cursor;
+      strcpy((char *)slot_name, "CURSORCOLOR");
+    }
+    else
+    {
+      entry = (slot - 1 < colors->color_count) ? colors->colors[slot - 1] : NULL;
+      sprintf((char *)slot_name, "COLOR %ld", slot);
+    }
+    if (!entry) continue;
+    slot_count++;
+
+    if (old_state[slot] == 1 &&
+        old_colors[slot].flags == entry->color.flags &&
+        old_colors[slot].red == entry->color.red &&
+        old_colors[slot].green == entry->color.green &&
+        old_colors[slot].blue == entry->color.blue)
+    {
+      continue;
+    }
+    differ_count++;
+
+    if (old_state[slot] != 1)
+    {
+      Printf("%-12s %-17s -> RGB(%3ld,%3ld,%3ld)\n", slot_name,
+             old_state[slot] ? "(unreadable)" : "(missing)",
+             (ULONG)(entry->color.red >> 8), (ULONG)(entry->color.green >> 8),
+             (ULONG)(entry->color.blue >> 8));
+      continue;
+    }
+
+    sprintf((char *)old_text, "RGB(%3ld,%3ld,%3ld)", (ULONG)(old_colors[slot].red >> 8),
+            (ULONG)(old_colors[slot].green >> 8), (ULONG)(old_colors[slot].blue >> 8));
+    Printf("%-12s %-17s -> RGB(%3ld,%3ld,%3ld)  distance %ld\n", slot_name, old_text,
+           (ULONG)(entry->color.red >> 8), (ULONG)(entry->color.green >> 8),
+           (ULONG)(entry->color.blue >> 8), color_distance(&old_colors[slot], &entry->color));
+
+    if (old_colors[slot].flags != entry->color.flags)
+    {
+      Printf("%-12s %s,%s -> %s,%s\n", "",
+             (old_colors[slot].flags & COLOR_FLAG_LOAD) ? "LOAD" : "NOLOAD",
+             (old_colors[slot].flags & COLOR_FLAG_ANSI) ? "ANSI" : "NOANSI",
+             (entry->color.flags & COLOR_FLAG_LOAD) ? "LOAD" : "NOLOAD",
+             (entry->color.flags & COLOR_FLAG_ANSI) ? "ANSI" : "NOANSI");
+    }
+  }
+
+  Printf("%ld of %ld entries differ\n", differ_count, slot_count);
+  Printf("=== END DIFF ===\n\n");
+
+  return differ_count;
+}
+
+/**
+ * Update one ViNCEd preferences file with new color entries
+ * A file that already holds the colors is not written at all. When every
+ * replacement keeps the length of its line only those bytes are rewritten;
+ * otherwise the file is rebuilt through a temporary copy.
+ *
+ * @param target Loaded and planned target
+ * @param colors Replacement entries
+ * @param shared Output of another target with the same layout (can be NULL)
+ * @param force TRUE to write the file even if it already holds the colors
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL update_prefs_file(PrefsTarget *target, const PrefsColors *colors,
+                       PrefsTarget *shared, BOOL force)
+{
+  /* Leave the file alone when it already holds this palette */
+  if (target->unchanged && !force)
+  {
+    Printf("'%s' already holds these colors, unchanged\n", target->path);
+    return TRUE;
+  }
+
+  /* Same-length replacements are written over the old lines directly */
+  if (target->in_place && target->patch_count > 0)
+  {
+    if (patch_prefs_file(target->path, &target->text, target->patches, target->patch_count))
+    {
+      lines_rewritten += target->patch_count;
+      Printf("Successfully updated '%s' in place\n", target->path);
+      return TRUE;
+    }
+
+    /* The loaded copy holds the replacements, so rebuilding stays correct */
+    Printf("WARNING: Could not patch '%s' in place, rewriting it\n", target->path);
+  }
+
+  /* Identical files get the same output, so reuse it as one block */
+  if (shared)
+  {
+    if (!replace_prefs_file(target->path, &shared->output)) return FALSE;
+    lines_rewritten += shared->rewritten;
+    Printf("Successfully updated '%s' with the output for '%s'\n", target->path, shared->path);
+    return TRUE;
+  }
+
+  if (!build_prefs_output(target, colors))
+  {
+    Printf("ERROR: Out of memory updating '%s'\n", target->path);
+    return FALSE;
+  }
+
+  if (!replace_prefs_file(target->path, &target->output)) return FALSE;
+  lines_rewritten += target->rewritten;
+
+  Printf("Successfully updated '%s'\n", target->path);
+  return TRUE;
+}
+
+/**
+ * Update one or more ViNCEd preferences files with the same colors
+ * Each file is read once. A file whose non-color content matches one
+ * already rebuilt gets that output written as is, without a second merge.
+ * With UPDATE_DIFF the entries that change are listed before writing.
+ * A file that exists but cannot be read stops the update before anything
+ * is written; only a missing file is created new.
+ *
+ * @param paths Paths of the preferences files, in update order
+ * @param path_count Number of paths, at most MAX_PREFS_TARGETS
+ * @param new_colors ColorList containing new color entries
+ * @param flags UPDATE_FORCE, UPDATE_DIFF and UPDATE_DRY_RUN bits
+ * @return TRUE on success, FALSE on the first file that fails
+ */
+BOOL update_prefs_files(const UBYTE **paths, ULONG path_count, ColorList *new_colors, ULONG flags)
+{
+  PrefsTarget targets[MAX_PREFS_TARGETS];
+  PrefsTarget *shared;
+  PrefsColors colors;
+  BOOL success = TRUE;
+  ULONG i, j;
+
+  if (!paths || !new_colors || path_count > MAX_PREFS_TARGETS) return FALSE;
+
+  organize_prefs_colors(new_colors, &colors);
+
+  /* Read and plan every target before any of them is written */
+  for (i = 0; i < path_count; i++)
+  {
+    memset(&targets[i], 0, sizeof(PrefsTarget));
+    targets[i].path = paths[i];
+    targets[i].have_text = load_text_file(paths[i], &targets[i].text);
+    if (targets[i].have_text)
+    {
+      targets[i].in_place = plan_prefs_patch(&targets[i].text, &colors, targets[i].patches,
+                                             &targets[i].patch_count, &targets[i].unchanged);
+    }
+    else if (targets[i].text.status != TEXT_MISSING)
+    {
+      /* Only a file that does not exist yet may be created from scratch */
+      if (targets[i].text.status == TEXT_OPEN_FAILED)
+      {
+        Printf("ERROR: Could not open '%s' (error %ld)\n", paths[i], targets[i].text.io_error);
+      }
+      Printf("ERROR: Leaving %s untouched\n", paths[i]);
+      success = FALSE;
+    }
+  }
+  end_phase("Read prefs");
+
+  if ((flags & UPDATE_DIFF) && success)
+  {
+    for (i = 0; i < path_count; i++)
+    {
+      show_prefs_diff(&targets[i], &colors);
+    }
+    end_phase("Diff");
+  }
+
+  for (i = 0; i < path_count && success && !(flags & UPDATE_DRY_RUN); i++)
+  {
+    shared = NULL;
+    for (j = 0; j < i && !shared; j++)
+    {
+      if (targets[j].output.buffer && same_prefs_layout(&targets[j], &targets[i], &colors))
+      {
+        shared = &targets[j];
+      }
+    }
+
+    if (!update_prefs_file(&targets[i], &colors, shared, (BOOL)(flags & UPDATE_FORCE)))
+    {
+      Printf("ERROR: Failed to update %s\n", paths[i]);
+      success = FALSE;
+    }
+    end_phase((const char *)paths[i]);
+  }
+
+  for (i = 0; i < path_count; i++)
+  {
+    free_text_file(&targets[i].text);
+    free_text_file(&targets[i].output);
+  }
+
+  return success;
+}
+
+/**
+ * Write a theme as a canonical ViNCEd color block to a new file
+ *
+ * @param path Path of the file to create
+ * @param colors ColorList to write
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL write_theme_file(const UBYTE *path, ColorList *colors)
+{
+  BPTR file;
+  BOOL success;
+
+  file = Open((STRPTR)path, MODE_NEWFILE);
+  if (!file)
+  {
+    Printf("ERROR: Could not create '%s'\n", path);
+    return FALSE;
+  }
+
+  success = write_color_block(file, colors);
+  if (!Close(file)) success = FALSE;
+
+  if (!success)
+  {
+    Printf("ERROR: Could not write '%s'\n", path);
+  }
+
+  return success;
+}
+
+/**
+ * Convert one theme file as part of a batch run
+ *
+ * Every failure is counted in failed_count. Running out of memory also
+ * sets out_of_memory so the caller can stop the run. A file whose output
+ * path is the file itself is refused.
+ *
+ * @param batch Batch state shared by all files
+ * @param path Path of the theme file to convert
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL convert_batch_file(BatchRun *batch, const UBYTE *path)
+{
+  BatchResult *result;
+  struct EClockVal start, end;
+  UBYTE out_path[256];
+  ULONG name_len;
+  BPTR in_lock, out_lock;
+  BOOL same_file;
+
+  result = alloc_mem(sizeof(BatchResult), MEMF_CLEAR);
+  if (!result)
+  {
+    Printf("ERROR: Out of memory converting '%s'\n", path);
+    batch->file_count++;
+    batch->failed_count++;
+    batch->out_of_memory = TRUE;
+    return FALSE;
+  }
+
+  name_len = strlen(FilePart((STRPTR)path));
+  if (name_len >= sizeof(result->name)) name_len = sizeof(result->name) - 1;
+  strncpy((char *)result->name, FilePart((STRPTR)path), name_len);
+
+  if (batch->last)
+  {
+    batch->last->next = result;
+  }
+  else
+  {
+    batch->first = result;
+  }
+  batch->last = result;
+  batch->file_count++;
+
+  strncpy((char *)out_path, (const char *)batch->to_dir, sizeof(out_path) - 1);
+  out_path[sizeof(out_path) - 1] = '\0';
+  if (!AddPart((STRPTR)out_path, FilePart((STRPTR)path), sizeof(out_path)))
+  {
+    Printf("ERROR: Output path too long for '%s'\n", path);
+    batch->failed_count++;
+    return FALSE;
+  }
+
+  /* Refuse to write over the file being converted, e.g. TODIR is its directory */
+  out_lock = Lock((STRPTR)out_path, ACCESS_READ);
+  if (out_lock)
+  {
+    in_lock = Lock((STRPTR)path, ACCESS_READ);
+    same_file = (BOOL)(in_lock && SameLock(in_lock, out_lock) == LOCK_SAME);
+    if (in_lock) UnLock(in_lock);
+    UnLock(out_lock);
+    if (same_file)
+    {
+      Printf("ERROR: '%s' would overwrite its source, TODIR must be another directory\n",
+             out_path);
+      batch->failed_count++;
+      return FALSE;
+    }
+  }
+
+  read_clock(&start);
+  result->success = read_theme_text(path, &batch->text, &batch->colors, batch->overrides);
+  if (result->success)
+  {
+    result->success = write_theme_file(out_path, &batch->colors);
+  }
+  read_clock(&end);
+
+  result->micros = clock_micros(&start, &end);
+  clear_color_list(&batch->colors);
+
+  if (!result->success) batch->failed_count++;
+  return result->success;
+}
+
+/**
+ * Print the per-file timing summary of a batch run and free its results
+ *
+ * @param batch Batch state to report on
+ */
+VOID report_batch(BatchRun *batch)
+{
+  BatchResult *result, *next;
+  ULONG total = 0;
+
+  Printf("\n=== BATCH SUMMARY - %ld files ===\n", batch->file_count);
+  for (result = batch->first; result; result = next)
+  {
+    next = result->next;
+    total += result->micros;
+
+    if (eclock_rate)
+    {
+      Printf("%-32s %s %6ld.%03ld ms\n", result->name,
+             result->success ? "ok    " : "FAILED",
+             result->micros / 1000, result->micros % 1000);
+    }
+    else
+    {
+      Printf("%-32s %s\n", result->name, result->success ? "ok" : "FAILED");
+    }
+
+    free_mem(result, sizeof(BatchResult));
+  }
+
+  if (eclock_rate)
+  {
+    Printf("Total: %ld ok, %ld failed, %ld unmatched, %ld.%03ld ms\n",
+           batch->file_count - batch->failed_count, batch->failed_count,
+           batch->unmatched_count, total / 1000, total % 1000);
+  }
+  else
+  {
+    Printf("Total: %ld ok, %ld failed, %ld unmatched (timer.device unavailable)\n",
+           batch->file_count - batch->failed_count, batch->failed_count,
+           batch->unmatched_count);
+  }
+  Printf("=== END BATCH SUMMARY ===\n\n");
+
+  batch->first = NULL;
+  batch->last = NULL;
+}
+
+/**
+ * Convert every theme file matching the given names or patterns
+ * Each file is written in canonical ViNCEd format to the output directory
+ * under its own name. All files share one process, one ColorList and one
+ * set of parse buffers.
+ *
+ * @param patterns NULL terminated array of file names or AmigaDOS patterns
+ * @param to_dir Directory to write the converted themes to
+ * @param overrides Optional color overrides to apply
+ * @return TRUE if every file was converted, FALSE otherwise
+ */
+BOOL convert_theme_batch(UBYTE **patterns, const UBYTE *to_dir, ColorOverrides *overrides)
+{
+  BatchRun batch;
+  struct AnchorPath *anchor;
+  LONG error;
+  BOOL aborted = FALSE;
+  BOOL opened_timer;
+
+  if (!patterns || !to_dir) return FALSE;
+
+  anchor = alloc_mem(sizeof(struct AnchorPath) + MAX_PATH_LENGTH, MEMF_CLEAR);
+  if (!anchor)
+  {
+    Printf("ERROR: Out of memory\n");
+    return FALSE;
+  }
+
+  batch.first = NULL;
+  batch.last = NULL;
+  batch.file_count = 0;
+  batch.failed_count = 0;
+  batch.unmatched_count = 0;
+  batch.out_of_memory = FALSE;
+  batch.to_dir = to_dir;
+  batch.overrides = overrides;
+  init_color_list(&batch.colors);
+  batch.text.buffer = NULL;
+  batch.text.alloc_size = 0;
+  batch.text.mapped = FALSE;
+
+  /* STATS may already have the timer open */
+  opened_timer = (BOOL)(!TimerBase && open_timer());
+
+  for (; *patterns && !aborted; patterns++)
+  {
+    anchor->ap_BreakBits = SIGBREAKF_CTRL_C;
+    anchor->ap_Strlen = MAX_PATH_LENGTH;
+
+    for (error = MatchFirst((STRPTR)*patterns, anchor); error == 0; error = MatchNext(anchor))
+    {
+      /* Skip directories and compiled caches matched by the pattern */
+      if (anchor->ap_Info.fib_DirEntryType > 0) continue;
+      if (has_suffix((UBYTE *)anchor->ap_Info.fib_FileName, CACHE_SUFFIX)) continue;
+
+      if (!convert_batch_file(&batch, anchor->ap_Buf) && batch.out_of_memory) break;
+    }
+    MatchEnd(anchor);
+
+    if (batch.out_of_memory)
+    {
+      Printf("ERROR: Batch stopped, out of memory\n");
+      aborted = TRUE;
+    }
+    else if (error == ERROR_BREAK)
+    {
+      Printf("***Break\n");
+      aborted = TRUE;
+    }
+    else if (error != ERROR_NO_MORE_ENTRIES)
+    {
+      Printf("ERROR: No theme files match '%s'\n", *patterns);
+      batch.unmatched_count++;
+    }
+  }
+
+  report_batch(&batch);
+  Printf("Memory: %ld allocation(s), %ld release(s)\n\n", alloc_count, free_count);
+  free_color_list(&batch.colors);
+  free_text_file(&batch.text);
+  if (opened_timer) close_timer();
+  free_mem(anchor, sizeof(struct AnchorPath) + MAX_PATH_LENGTH);
+
+  return (BOOL)(!aborted && batch.failed_count == 0 && batch.unmatched_count == 0);
+}
+
+/**
+ * Hash a theme name, ignoring case like AmigaDOS file names
+ *
+ * @param name Theme name
+ * @return 32-bit FNV-1a hash of the uppercase name
+ */
+ULONG hash_theme_name(const UBYTE *name)
+{
+  ULONG hash = 2166136261UL;
+
+  while (*name)
+  {
+    hash = (hash ^ (UBYTE)toupper(*name++)) * 16777619UL;
+  }
+
+  return hash;
+}
+
+/**
+ * Hash the contents of a theme file
+ * Tells a file that was only touched from one that was edited.
+ *
+ * @param path Path of the theme file
+ * @param hash Receives the 32-bit FNV-1a hash of the file's bytes
+ * @return TRUE on success, FALSE if the file could not be read
+ */
+BOOL hash_theme_file(const UBYTE *path, ULONG *hash)
+{
+  TextFile text;
+  const UBYTE *p;
+  const UBYTE *end;
+  ULONG h = 2166136261UL;
+
+  if (!load_text_file(path, &text)) return FALSE;
+
+  end = text.buffer + text.size;
+  for (p = text.buffer; p < end; p++)
+  {
+    h = (h ^ *p) * 16777619UL;
+  }
+
+  free_text_file(&text);
+  *hash = h;
+  return TRUE;
+}
+
+/**
+ * Compare two theme names, ignoring case
+ *
+ * @param a First name
+ * @param b Second name
+ * @return TRUE if the names are equal
+ */
+BOOL same_theme_name(const UBYTE *a, const char *b)
+{
+  while (*a && toupper(*a) == toupper(*b))
+  {
+    a++;
+    b++;
+  }
+
+  return (BOOL)(*a == *b);
+}
+
+/**
+ * Build the path of the index file of a theme directory
+ *
+ * @param dir Theme directory
+ * @param path Buffer of MAX_PATH_LENGTH bytes
+ * @param name File name to add, INDEX_NAME or a theme name
+ * @return TRUE on success, FALSE if the path is too long
+ */
+BOOL theme_dir_path(const UBYTE *dir, const char *name, UBYTE *path)
+{
+  if (strlen((const char *)dir) >= MAX_PATH_LENGTH) return FALSE;
+
+  strcpy((char *)path, (const char *)dir);
+  return (BOOL)AddPart((STRPTR)path, (STRPTR)name, MAX_PATH_LENGTH);
+}
+
+/**
+ * Free a loaded theme index
+ *
+ * @param index Index to free
+ */
+VOID close_theme_index(ThemeIndex *index)
+{
+  free_text_file(&index->file);
+  index->header = NULL;
+  index->buckets = NULL;
+  index->entries = NULL;
+}
+
+/**
+ * Load and check the index of a theme directory
+ *
+ * @param dir Theme directory
+ * @param index Index to fill
+ * @return TRUE if the index exists and is intact, FALSE otherwise
+ */
+BOOL open_theme_index(const UBYTE *dir, ThemeIndex *index)
+{
+  UBYTE path[MAX_PATH_LENGTH];
+  IndexHeader *header;
+  ULONG table_size;
+
+  memset(index, 0, sizeof(ThemeIndex));
+
+  if (!theme_dir_path(dir, INDEX_NAME, path) || !load_text_file(path, &index->file))
+  {
+    return FALSE;
+  }
+
+  header = (IndexHeader *)index->file.buffer;
+  if (index->file.size < sizeof(IndexHeader) ||
+      header->magic != INDEX_MAGIC ||
+      header->version != INDEX_VERSION)
+  {
+    close_theme_index(index);
+    return FALSE;
+  }
+
+  table_size = header->bucket_count * sizeof(UWORD) + header->entry_count * sizeof(IndexEntry);
+  if (index->file.size != sizeof(IndexHeader) + table_size ||
+      header->checksum != checksum_bytes(index->file.buffer + sizeof(IndexHeader),
+                                         table_size, INDEX_MAGIC))
+  {
+    close_theme_index(index);
+    return FALSE;
+  }
+
+  index->header = header;
+  index->buckets = (UWORD *)(index->file.buffer + sizeof(IndexHeader));
+  index->entries = (IndexEntry *)(index->buckets + header->bucket_count);
+  return TRUE;
+}
+
+/**
+ * Look up a theme by name in a loaded index
+ *
+ * @param index Loaded index
+ * @param name Theme name
+ * @return Matching entry or NULL
+ */
+IndexEntry *find_index_entry(ThemeIndex *index, const UBYTE *name)
+{
+  UWORD i;
+
+  if (!index->header) return NULL;
+
+  i = index->buckets[hash_theme_name(name) & (index->header->bucket_count - 1)];
+  while (i != INDEX_NONE)
+  {
+    if (same_theme_name(index->entries[i].name, (const char *)name)) return &index->entries[i];
+    i = index->entries[i].next;
+  }
+
+  return NULL;
+}
+
+/**
+ * Write a theme library index with its hash table
+ *
+ * @param dir Theme directory
+ * @param entries Entries to write; their hash chains are filled in
+ * @param entry_count Number of entries
  * @return TRUE on success, FALSE on failure
  */
-BOOL read_theme_file(const UBYTE *filename, ColorList *colors, ColorOverrides *overrides)
+BOOL write_theme_index(const UBYTE *dir, IndexEntry *entries, ULONG entry_count)
 {
+  UBYTE path[MAX_PATH_LENGTH];
+  IndexHeader header;
+  UWORD *buckets;
+  ULONG bucket_count = INDEX_MIN_BUCKETS;
+  ULONG bucket;
+  ULONG bucket_size;
+  ULONG entry_size = entry_count * sizeof(IndexEntry);
   BPTR file;
-  UBYTE line[MAX_LINE_LENGTH];
-  UBYTE converted_line[MAX_LINE_LENGTH];
-  BOOL found_cursor_color = FALSE;
-  ULONG color_count = 0;
+  BOOL success;
+  ULONG i;
+
+  if (!theme_dir_path(dir, INDEX_NAME, path)) return FALSE;
+
+  /* Keep chains short: at least one bucket per entry */
+  while (bucket_count < entry_count) bucket_count <<= 1;
+  bucket_size = bucket_count * sizeof(UWORD);
+
+  buckets = alloc_mem(bucket_size, MEMF_ANY);
+  if (!buckets) return FALSE;
+
+  for (i = 0; i < bucket_count; i++)
+  {
+    buckets[i] = INDEX_NONE;
+  }
+
+  /* Insert in reverse so each chain lists entries in directory order */
+  for (i = entry_count; i-- > 0; )
+  {
+    bucket = hash_theme_name(entries[i].name) & (bucket_count - 1);
+    entries[i].next = buckets[bucket];
+    buckets[bucket] = (UWORD)i;
+  }
+
+  header.magic = INDEX_MAGIC;
+  header.version = INDEX_VERSION;
+  header.bucket_count = (UWORD)bucket_count;
+  header.entry_count = entry_count;
+  header.checksum = checksum_bytes((UBYTE *)entries, entry_size,
+                                   checksum_bytes((UBYTE *)buckets, bucket_size, INDEX_MAGIC));
+
+  file = Open((STRPTR)path, MODE_NEWFILE);
+  success = (BOOL)(file != 0);
+  if (file)
+  {
+    success = (BOOL)(Write(file, &header, (LONG)sizeof(header)) == (LONG)sizeof(header) &&
+                     Write(file, buckets, (LONG)bucket_size) == (LONG)bucket_size &&
+                     Write(file, entries, (LONG)entry_size) == (LONG)entry_size);
+    if (!Close(file)) success = FALSE;
+  }
+
+  if (success)
+  {
+    bytes_written += sizeof(header) + bucket_size + entry_size;
+  }
+  else
+  {
+    Printf("ERROR: Could not write index '%s'\n", path);
+    if (file) DeleteFile((STRPTR)path);
+  }
+
+  free_mem(buckets, bucket_size);
+  return success;
+}
+
+/**
+ * Scan a theme directory and write its index
+ * Themes whose datestamp matches the previous index are copied from it.
+ * Files with a new date are hashed, and only new files and files whose
+ * bytes changed are parsed.
+ *
+ * @param dir Theme directory
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL build_theme_index(const UBYTE *dir)
+{
+  UBYTE pattern[MAX_PATH_LENGTH];
+  struct AnchorPath *anchor;
+  ThemeIndex old_index;
+  ColorList colors;
+  CompiledTheme theme;
+  IndexEntry *entries = NULL;
+  IndexEntry *old_entry;
+  IndexEntry *entry;
+  ULONG capacity = 0;
+  ULONG entry_count = 0;
+  ULONG parsed_count = 0;
+  ULONG skipped_count = 0;
+  UBYTE *name;
+  ULONG hash;
+  LONG error;
   BOOL success = TRUE;
 
-  if (!filename || !colors) return FALSE;
+  if (!theme_dir_path(dir, "#?", pattern))
+  {
+    Printf("ERROR: Theme directory path too long\n");
+    return FALSE;
+  }
 
-  file = Open((STRPTR)filename, MODE_OLDFILE);
-  if (!file)
+  anchor = alloc_mem(sizeof(struct AnchorPath) + MAX_PATH_LENGTH, MEMF_CLEAR);
+  if (!anchor)
   {
-    Printf("ERROR: Could not open theme file '%s'\n", filename);
+    Printf("ERROR: Out of memory\n");
     return FALSE;
   }
+  anchor->ap_BreakBits = SIGBREAKF_CTRL_C;
+  anchor->ap_Strlen = MAX_PATH_LENGTH;
 
-  init_color_list(colors);
+  open_theme_index(dir, &old_index);
+  init_color_list(&colors);
 
-  /* Single pass: look for CURSORCOLOR first, then COLOR lines in sequence */
-  while (FGets(file, line, sizeof(line)) && success)
+  for (error = MatchFirst((STRPTR)pattern, anchor); error == 0 && success; error = MatchNext(anchor))
   {
-    /* Remove trailing newline */
-    ULONG len = strlen(line);
-    if (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+    name = (UBYTE *)anchor->ap_Info.fib_FileName;
+
+    /* Skip directories, compiled caches and the index itself */
+    if (anchor->ap_Info.fib_DirEntryType > 0) continue;
+    if (has_suffix(name, CACHE_SUFFIX) || same_theme_name(name, INDEX_NAME)) continue;
+
+    if (strlen((char *)name) >= INDEX_NAME_SIZE)
     {
-      line[len - 1] = '\0';
-      if (len > 1 && line[len - 2] == '\r')
-      {
-        line[len - 2] = '\0';
-      }
+      Printf("WARNING: Name too long to index: %s\n", name);
+      skipped_count++;
+      continue;
     }
 
-    /* Check if this is a cursor color line (only if we haven't found one yet) */
-    if (!found_cursor_color && line_starts_with(line, "CURSORCOLOR="))
+    if (entry_count == capacity)
     {
-      if (convert_color_line(line, converted_line, sizeof(converted_line), overrides))
-      {
-        if (add_color_entry(colors, converted_line))
-        {
-          found_cursor_color = TRUE;
-        }
-        else
-        {
-          Printf("ERROR: Failed to add cursor color entry\n");
-          success = FALSE;
-          break;
-        }
-      }
-      else
+      ULONG new_capacity = capacity ? capacity * 2 : 32;
+      IndexEntry *larger;
+
+      if (new_capacity >= INDEX_NONE)
       {
-        Printf("WARNING: Could not parse cursor color line: %s\n", line);
+        Printf("ERROR: Too many themes to index\n");
+        success = FALSE;
+        break;
       }
-    }
-    /* Check if this is a color line (only after we found cursor color) */
-    else if (found_cursor_color && color_count < REQUIRED_COLOR_LINES && line_starts_with(line, "COLOR="))
-    {
-      if (convert_color_line(line, converted_line, sizeof(converted_line), overrides))
+
+      larger = alloc_mem(new_capacity * sizeof(IndexEntry), MEMF_CLEAR);
+      if (!larger)
       {
-        if (add_color_entry(colors, converted_line))
-        {
-          color_count++;
-        }
-        else
-        {
-          Printf("ERROR: Failed to add color entry\n");
-          success = FALSE;
-          break;
-        }
+        Printf("ERROR: Out of memory\n");
+        success = FALSE;
+        break;
       }
-      else
+      if (entries)
       {
-        Printf("WARNING: Could not parse color line: %s\n", line);
+        CopyMem(entries, larger, entry_count * sizeof(IndexEntry));
+        free_mem(entries, capacity * sizeof(IndexEntry));
       }
+      entries = larger;
+      capacity = new_capacity;
     }
 
-    /* Stop if we have found cursor color and all required color lines */
-    if (found_cursor_color && color_count >= REQUIRED_COLOR_LINES)
+    entry = &entries[entry_count];
+
+    /* Unchanged since the last index: reuse the parsed colors */
+    old_entry = find_index_entry(&old_index, name);
+    if (old_entry && CompareDates(&old_entry->date, &anchor->ap_Info.fib_Date) == 0)
     {
-      break;
+      *entry = *old_entry;
+      entry_count++;
+      continue;
+    }
+
+    if (!hash_theme_file(anchor->ap_Buf, &hash))
+    {
+      Printf("WARNING: Could not index '%s'\n", name);
+      skipped_count++;
+      continue;
+    }
+
+    /* Touched but not edited: same colors, new date */
+    if (old_entry && old_entry->content_hash == hash)
+    {
+      *entry = *old_entry;
+      entry->date = anchor->ap_Info.fib_Date;
+      entry_count++;
+      continue;
+    }
+
+    /* Parse without overrides so the index stays neutral */
+    if (!read_theme_file(anchor->ap_Buf, &colors, NULL) || !compile_theme(&colors, &theme))
+    {
+      Printf("WARNING: Could not index '%s'\n", name);
+      skipped_count++;
+      continue;
     }
+
+    memset(entry, 0, sizeof(IndexEntry));
+    strcpy((char *)entry->name, (char *)name);
+    entry->date = anchor->ap_Info.fib_Date;
+    entry->content_hash = hash;
+    entry->cursor = theme.cursor;
+    CopyMem(theme.colors, entry->colors, sizeof(entry->colors));
+    entry_count++;
+    parsed_count++;
   }
+  MatchEnd(anchor);
 
-  Close(file);
+  if (error == ERROR_BREAK)
+  {
+    Printf("***Break\n");
+    success = FALSE;
+  }
 
-  if (!success)
+  close_theme_index(&old_index);
+  free_color_list(&colors);
+  free_mem(anchor, sizeof(struct AnchorPath) + MAX_PATH_LENGTH);
+
+  if (success)
   {
-    free_color_list(colors);
+    success = write_theme_index(dir, entries, entry_count);
+  }
+
+  if (success)
+  {
+    Printf("Indexed %ld theme(s) in '%s': %ld parsed, %ld unchanged, %ld skipped\n",
+           entry_count, dir, parsed_count, entry_count - parsed_count, skipped_count);
+  }
+
+  if (entries) free_mem(entries, capacity * sizeof(IndexEntry));
+  return success;
+}
+
+/**
+ * Load a theme by name through an index that is already open
+ * A current index entry is used without opening the theme file. When the
+ * file's date differs from the entry, its bytes are hashed and the entry is
+ * still used if they are unchanged; a missing or edited entry falls back to
+ * load_theme.
+ *
+ * @param index Open index of dir, or NULL to go straight to load_theme
+ * @param dir Theme directory
+ * @param name Theme name
+ * @param date Date of the theme file if already known, or NULL
+ * @param colors ColorList to populate
+ * @param overrides Optional color overrides to apply
+ * @param cache_flags CACHE_ flags for load_theme
+ * @param from_index Receives TRUE if the colors came from the index
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL load_theme_through_index(ThemeIndex *index, const UBYTE *dir, const UBYTE *name,
+                              const struct DateStamp *date, ColorList *colors,
+                              ColorOverrides *overrides, ULONG cache_flags, BOOL *from_index)
+{
+  UBYTE path[MAX_PATH_LENGTH];
+  struct DateStamp file_date;
+  IndexEntry *entry;
+  CompiledTheme theme;
+  ULONG hash;
+
+  *from_index = FALSE;
+
+  if (!theme_dir_path(dir, (const char *)name, path))
+  {
+    Printf("ERROR: Theme path too long\n");
     return FALSE;
   }
 
-  /* Fill in missing entries with defaults */
-  if (!found_cursor_color)
+  entry = index ? find_index_entry(index, name) : NULL;
+  if (entry && !date && get_file_date(path, &file_date)) date = &file_date;
+
+  if (!entry || !date ||
+      (CompareDates(date, &entry->date) != 0 &&
+       (!hash_theme_file(path, &hash) || hash != entry->content_hash)))
   {
-    /* Insert default cursor color at beginning */
-    ColorEntry *old_first = colors->first;
-    ColorEntry *cursor_entry = AllocMem(sizeof(ColorEntry), MEMF_CLEAR);
-    UBYTE default_line[MAX_LINE_LENGTH];
-    UBYTE *load_flag = "NOLOAD";
-    UBYTE *ansi_flag = "NOANSI";
+    return load_theme(path, colors, overrides, cache_flags);
+  }
 
-    Printf("WARNING: No CURSORCOLOR found, using default\n");
+  theme.cursor = entry->cursor;
+  CopyMem(entry->colors, theme.colors, sizeof(theme.colors));
+  if (!expand_compiled_theme(&theme, colors, overrides)) return FALSE;
 
-    /* Apply overrides if specified */
-    if (overrides)
-    {
-      if (overrides->override_load)
-      {
-        load_flag = overrides->use_load ? "LOAD" : "NOLOAD";
-      }
-      if (overrides->override_ansi)
-      {
-        ansi_flag = overrides->use_ansi ? "ANSI" : "NOANSI";
-      }
-    }
+  *from_index = TRUE;
+  return TRUE;
+}
 
-    if (cursor_entry)
-    {
-      ULONG line_len = strlen(default_line) + 1;
-      sprintf(default_line, "CURSORCOLOR=%s,%s,0x0000,0x0000,0x0000", load_flag, ansi_flag);
-      cursor_entry->line = AllocMem(line_len, MEMF_CLEAR);
-      if (cursor_entry->line)
-      {
-        strcpy(cursor_entry->line, default_line);
-        cursor_entry->next = old_first;
-        colors->first = cursor_entry;
-        if (!old_first)
-        {
-          colors->last = cursor_entry;
-        }
-        colors->count++;
-      }
-      else
-      {
-        FreeMem(cursor_entry, sizeof(ColorEntry));
-      }
-    }
+/**
+ * Load a theme by name from a theme directory, through its index if possible
+ *
+ * @param dir Theme directory
+ * @param name Theme name
+ * @param colors ColorList to populate
+ * @param overrides Optional color overrides to apply
+ * @param cache_flags CACHE_ flags, 0 to ignore the index and compiled caches
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL load_indexed_theme(const UBYTE *dir, const UBYTE *name, ColorList *colors,
+                        ColorOverrides *overrides, ULONG cache_flags)
+{
+  ThemeIndex index;
+  BOOL have_index = (BOOL)((cache_flags & CACHE_READ) && open_theme_index(dir, &index));
+  BOOL from_index;
+  BOOL success;
+
+  success = load_theme_through_index(have_index ? &index : NULL, dir, name, NULL,
+                                     colors, overrides, cache_flags, &from_index);
+  if (have_index) close_theme_index(&index);
+
+  if (success && from_index)
+  {
+    Printf("Loaded theme '%s' from the index of '%s'\n", name, dir);
   }
+  return success;
+}
 
-  /* Add default COLOR entries for any missing ones */
-  while (color_count < REQUIRED_COLOR_LINES)
+/**
+ * Build the control sequences that set a console's pens and cursor color
+ * Each COLOR slot n becomes OSC 4 ("ESC ] 4 ; n ; rgb:rrrr/gggg/bbbb BEL")
+ * and CURSORCOLOR becomes OSC 12, with the full 16-bit channels. The
+ * console sets its own pens, so no screen pens are touched. The output is
+ * plain bytes so it can be captured and checked on any host.
+ *
+ * @param colors ColorList with the entries to send
+ * @param buffer Buffer of at least LIVE_BUFFER_SIZE bytes
+ * @return Number of bytes placed in buffer
+ */
+ULONG build_live_sequences(const ColorList *colors, UBYTE *buffer)
+{
+  const ColorEntry *entry;
+  UBYTE *p = buffer;
+  ULONG color_index = 0;
+  ULONG i;
+
+  for (i = 0; i < colors->count; i++)
   {
-    UBYTE default_line[MAX_LINE_LENGTH];
-    UBYTE *load_flag = "NOLOAD";
-    UBYTE *ansi_flag = "NOANSI";
+    entry = &colors->entries[i];
 
-    /* Apply overrides if specified */
-    if (overrides)
+    if (entry->kind == LINE_CURSORCOLOR)
     {
-      if (overrides->override_load)
-      {
-        load_flag = overrides->use_load ? "LOAD" : "NOLOAD";
-      }
-      if (overrides->override_ansi)
-      {
-        ansi_flag = overrides->use_ansi ? "ANSI" : "NOANSI";
-      }
+      p += sprintf((char *)p, "\033]12;rgb:%04lx/%04lx/%04lx\007", (ULONG)entry->color.red,
+                   (ULONG)entry->color.green, (ULONG)entry->color.blue);
     }
-
-    sprintf(default_line, "COLOR=%s,%s,0x0000,0x0000,0x0000", load_flag, ansi_flag);
-    if (!add_color_entry(colors, default_line))
+    else if (entry->kind == LINE_COLOR && color_index < REQUIRED_COLOR_LINES)
     {
-      Printf("ERROR: Failed to add default color entry\n");
-      free_color_list(colors);
-      return FALSE;
+      p += sprintf((char *)p, "\033]4;%ld;rgb:%04lx/%04lx/%04lx\007", color_index,
+                   (ULONG)entry->color.red, (ULONG)entry->color.green,
+                   (ULONG)entry->color.blue);
+      color_index++;
     }
-    color_count++;
   }
 
-  Printf("Loaded theme: %s CURSORCOLOR, %ld COLOR entries (%ld defaults added)\n",
-         found_cursor_color ? "found" : "default",
-         color_count,
-         (found_cursor_color ? 0 : 1) + (REQUIRED_COLOR_LINES - (colors->count - (found_cursor_color ? 1 : 0))));
+  return (ULONG)(p - buffer);
+}
+
+/**
+ * Send a theme to the current console with one Write
+ *
+ * @param colors ColorList with the entries to send
+ * @return TRUE on success, FALSE if output is not a console or the write failed
+ */
+BOOL apply_live_colors(ColorList *colors)
+{
+  UBYTE buffer[LIVE_BUFFER_SIZE];
+  BPTR console = Output();
+  LONG length;
+
+  if (!console || !IsInteractive(console))
+  {
+    Printf("WARNING: LIVE needs output to a console, skipped\n");
+    return FALSE;
+  }
+
+  length = (LONG)build_live_sequences(colors, buffer);
+
+  /* Printf output is buffered, so send it first to keep the order */
+  Flush(console);
+  if (Write(console, buffer, length) != length)
+  {
+    Printf("ERROR: Could not send colors to the console\n");
+    return FALSE;
+  }
 
+  bytes_written += length;
+  Printf("Sent %ld colors to the console\n", colors->count);
   return TRUE;
 }
 
 /**
- * Update a ViNCEd preferences file with new color entries
- * Replaces existing color lines in their current positions, adds new ones if missing
+ * Display version information
+ */
+VOID show_version(VOID)
+{
+  Printf("%s %s (%s)\n", PROG_NAME, PROG_VERSION, PROG_DATE);
+  Printf("ViNCEd Theme Manager for AmigaDOS\n");
+  Printf("Converts various color formats to ViNCEd 16-bit RGB\n\n");
+}
+
+/**
+ * Convert ColorList to AnsiColor array for display
  *
- * @param prefs_path Path to preferences file to update
- * @param new_colors ColorList containing new color entries
+ * @param colors ColorList containing parsed theme colors
+ * @param ansi_colors Array of 16 AnsiColor structures to fill
  * @return TRUE on success, FALSE on failure
  */
-BOOL update_prefs_file(const UBYTE *prefs_path, ColorList *new_colors)
+BOOL convert_to_ansi_colors(ColorList *colors, AnsiColor *ansi_colors)
 {
-  BPTR old_file, new_file;
-  UBYTE line[MAX_LINE_LENGTH];
-  UBYTE temp_path[256];
-  ColorEntry *color_entry;
-  ColorEntry *cursor_color = NULL;
-  ColorEntry *color_entries[REQUIRED_COLOR_LINES];
-  ULONG color_index = 0;
-  BOOL success = FALSE;
-  BOOL found_colors_section = FALSE;
-  BOOL colors_added = FALSE;
+  ColorEntry *entry;
+  ULONG entry_index = 0;
+  int color_index = 0;
+  int i;
+
+  if (!colors || !ansi_colors) return FALSE;
+
+  /* Initialize all colors to defaults first */
+  for (i = 0; i < 16; i++) {
+    ansi_colors[i] = default_ansi_colors[i];
+  }
+
+  /* Copy COLOR entries, skipping CURSORCOLOR */
+  while (entry_index < colors->count && color_index < 16) {
+    entry = &colors->entries[entry_index++];
+
+    if (entry->kind != LINE_COLOR) {
+      continue;
+    }
+
+    /* Convert 16-bit to 8-bit */
+    ansi_colors[color_index].red = (UBYTE)(entry->color.red >> 8);
+    ansi_colors[color_index].green = (UBYTE)(entry->color.green >> 8);
+    ansi_colors[color_index].blue = (UBYTE)(entry->color.blue >> 8);
+    ansi_colors[color_index].load_flag = (BOOL)((entry->color.flags & COLOR_FLAG_LOAD) != 0);
+
+    color_index++;
+  }
+
+  return TRUE;
+}
+
+/**
+ * Check whether a theme name contains AmigaDOS wildcards
+ *
+ * @param name Theme file name or pattern
+ * @return TRUE if name is a pattern
+ */
+BOOL is_theme_pattern(const UBYTE *name)
+{
+  ULONG size;
+  UBYTE *parsed;
+  LONG wild = 0;
+
+  if (!name) return FALSE;
+
+  size = strlen((const char *)name) * 2 + 2;
+  parsed = alloc_mem(size, 0);
+  if (parsed)
+  {
+    wild = ParsePatternNoCase((STRPTR)name, (STRPTR)parsed, size);
+    free_mem(parsed, size);
+  }
+
+  return (BOOL)(wild == 1);
+}
 
-  if (!prefs_path || !new_colors) return FALSE;
+/**
+ * Add a loaded theme to the gallery, growing the array as needed
+ *
+ * @param gallery Gallery being collected
+ * @param path Path of the theme; its file part names the row
+ * @param colors Parsed colors of the theme
+ * @return TRUE on success, FALSE if out of memory
+ */
+BOOL add_gallery_theme(GalleryList *gallery, const UBYTE *path, ColorList *colors)
+{
+  GalleryTheme *theme;
 
-  /* Organize new colors: separate cursor color from regular colors */
-  color_entry = new_colors->first;
-  while (color_entry && color_index <= REQUIRED_COLOR_LINES)
+  if (gallery->count == gallery->capacity)
   {
-    if (starts_with(color_entry->line, "CURSORCOLOR="))
+    ULONG new_capacity = gallery->capacity ? gallery->capacity * 2 : 16;
+    GalleryTheme *larger;
+
+    larger = alloc_mem(new_capacity * sizeof(GalleryTheme), MEMF_CLEAR);
+    if (!larger)
     {
-      cursor_color = color_entry;
+      Printf("ERROR: Out of memory\n");
+      return FALSE;
     }
-    else if (starts_with(color_entry->line, "COLOR=") && color_index < REQUIRED_COLOR_LINES)
+    if (gallery->themes)
     {
-      color_entries[color_index] = color_entry;
-      color_index++;
+      CopyMem(gallery->themes, larger, gallery->count * sizeof(GalleryTheme));
+      free_mem(gallery->themes, gallery->capacity * sizeof(GalleryTheme));
     }
-    color_entry = color_entry->next;
+    gallery->themes = larger;
+    gallery->capacity = new_capacity;
   }
 
-  /* Create temporary file name */
-  sprintf(temp_path, "%s.tmp", prefs_path);
+  theme = &gallery->themes[gallery->count++];
+  strncpy(theme->name, FilePart((STRPTR)path), GALLERY_NAME_SIZE - 1);
+  theme->name[GALLERY_NAME_SIZE - 1] = '\0';
+
+  return convert_to_ansi_colors(colors, theme->colors);
+}
 
-  old_file = Open((STRPTR)prefs_path, MODE_OLDFILE);
-  new_file = Open(temp_path, MODE_NEWFILE);
+/**
+ * Show several themes side by side in one gallery window
+ * Every name may be an AmigaDOS pattern. With a theme directory the names
+ * are looked up in it, through its index where it is current; the index
+ * is read once for the whole gallery.
+ *
+ * @param patterns NULL terminated array of theme names or patterns
+ * @param theme_dir Theme directory, or NULL for plain paths
+ * @param overrides Optional color overrides to apply
+ * @param cache_flags CACHE_ flags, 0 to ignore the index and compiled caches
+ * @param metric Distance used to match colors to screen pens
+ * @return TRUE if every theme was shown, FALSE otherwise
+ */
+BOOL view_theme_gallery(UBYTE **patterns, const UBYTE *theme_dir,
+                        ColorOverrides *overrides, ULONG cache_flags, ColorMetric metric)
+{
+  UBYTE pattern[MAX_PATH_LENGTH];
+  struct AnchorPath *anchor;
+  GalleryList gallery;
+  ColorList colors;
+  ThemeIndex index;
+  UBYTE *name;
+  LONG error;
+  ULONG indexed_count = 0;
+  BOOL have_index = FALSE;
+  BOOL from_index = FALSE;
+  BOOL loaded;
+  BOOL aborted = FALSE;
+  BOOL success = TRUE;
 
-  if (!new_file)
+  anchor = alloc_mem(sizeof(struct AnchorPath) + MAX_PATH_LENGTH, MEMF_CLEAR);
+  if (!anchor)
   {
-    Printf("ERROR: Could not create temporary file '%s'\n", temp_path);
-    if (old_file) Close(old_file);
+    Printf("ERROR: Out of memory\n");
     return FALSE;
   }
 
-  /* Process existing file if it exists */
-  if (old_file)
-  {
-    ULONG current_color_index = 0;
+  gallery.themes = NULL;
+  gallery.count = 0;
+  gallery.capacity = 0;
+  init_color_list(&colors);
+
+  if (theme_dir && (cache_flags & CACHE_READ)) have_index = open_theme_index(theme_dir, &index);
 
-    while (FGets(old_file, line, sizeof(line)))
+  for (; *patterns && !aborted; patterns++)
+  {
+    if (theme_dir)
     {
-      /* Check for existing color lines to replace */
-      if (line_starts_with(line, "CURSORCOLOR="))
-      {
-        /* Replace existing cursor color line */
-        if (cursor_color)
-        {
-          FPuts(new_file, cursor_color->line);
-          FPuts(new_file, "\n");
-        }
-        else
-        {
-          /* Keep original if no replacement */
-          FPuts(new_file, line);
-        }
-      }
-      else if (line_starts_with(line, "COLOR="))
+      if (!theme_dir_path(theme_dir, (const char *)*patterns, pattern))
       {
-        /* Replace existing color line if we have a replacement */
-        if (current_color_index < color_index && color_entries[current_color_index])
-        {
-          FPuts(new_file, color_entries[current_color_index]->line);
-          FPuts(new_file, "\n");
-        }
-        else
-        {
-          /* Keep original if no replacement */
-          FPuts(new_file, line);
-        }
-        current_color_index++;
+        Printf("ERROR: Theme path too long\n");
+        aborted = TRUE;
+        success = FALSE;
+        break;
       }
-      else if (starts_with(line, ";Colors:"))
+    }
+    else
+    {
+      strncpy((char *)pattern, (const char *)*patterns, sizeof(pattern) - 1);
+      pattern[sizeof(pattern) - 1] = '\0';
+    }
+
+    anchor->ap_BreakBits = SIGBREAKF_CTRL_C;
+    anchor->ap_Strlen = MAX_PATH_LENGTH;
+
+    for (error = MatchFirst((STRPTR)pattern, anchor); error == 0; error = MatchNext(anchor))
+    {
+      name = (UBYTE *)anchor->ap_Info.fib_FileName;
+
+      /* Skip directories, compiled caches and theme indexes */
+      if (anchor->ap_Info.fib_DirEntryType > 0) continue;
+      if (has_suffix(name, CACHE_SUFFIX) || same_theme_name(name, INDEX_NAME)) continue;
+
+      if (theme_dir)
       {
-        /* Keep colors section marker */
-        found_colors_section = TRUE;
-        FPuts(new_file, line);
+        /* MatchNext already has the date the index entry is checked against */
+        loaded = load_theme_through_index(have_index ? &index : NULL, theme_dir, name,
+                                          &anchor->ap_Info.fib_Date, &colors, overrides,
+                                          cache_flags, &from_index);
+        if (loaded && from_index) indexed_count++;
       }
       else
       {
-        /* Copy all other lines unchanged */
-        FPuts(new_file, line);
+        loaded = load_theme(anchor->ap_Buf, &colors, overrides, cache_flags);
       }
-    }
-    Close(old_file);
 
-    /* Add any remaining new color entries that weren't replacements */
-    if (current_color_index < color_index)
-    {
-      if (!found_colors_section)
+      if (!loaded)
       {
-        FPuts(new_file, ";Colors:\n");
+        Printf("WARNING: Leaving '%s' out of the gallery\n", name);
+        success = FALSE;
       }
-
-      /* Add remaining color entries */
-      while (current_color_index < color_index && color_entries[current_color_index])
+      else if (!add_gallery_theme(&gallery, anchor->ap_Buf, &colors))
       {
-        FPuts(new_file, color_entries[current_color_index]->line);
-        FPuts(new_file, "\n");
-        current_color_index++;
+        aborted = TRUE;
+        success = FALSE;
+        break;
       }
-      colors_added = TRUE;
     }
-  }
-  else
-  {
-    /* No existing file - create new one with all entries */
-    FPuts(new_file, ";Colors:\n");
+    MatchEnd(anchor);
 
-    /* Add cursor color */
-    if (cursor_color)
+    if (error == ERROR_BREAK)
     {
-      FPuts(new_file, cursor_color->line);
-      FPuts(new_file, "\n");
+      Printf("***Break\n");
+      aborted = TRUE;
+      success = FALSE;
     }
-
-    /* Add all color entries */
-    color_index = 0;
-    while (color_index < REQUIRED_COLOR_LINES && color_entries[color_index])
+    else if (error != 0 && error != ERROR_NO_MORE_ENTRIES)
     {
-      FPuts(new_file, color_entries[color_index]->line);
-      FPuts(new_file, "\n");
-      color_index++;
+      Printf("ERROR: No theme files match '%s'\n", *patterns);
+      success = FALSE;
     }
-    colors_added = TRUE;
   }
 
-  Close(new_file);
+  if (have_index) close_theme_index(&index);
+  free_color_list(&colors);
+  free_mem(anchor, sizeof(struct AnchorPath) + MAX_PATH_LENGTH);
 
-  /* Replace original file with temporary file */
-  DeleteFile((STRPTR)prefs_path);
-  if (Rename(temp_path, (STRPTR)prefs_path))
+  if (indexed_count)
   {
-    success = TRUE;
-    Printf("Successfully updated '%s'\n", prefs_path);
+    Printf("Loaded %ld theme(s) from the index of '%s'\n", indexed_count, theme_dir);
   }
-  else
+
+  if (gallery.count > 0 && !aborted)
   {
-    Printf("ERROR: Could not replace original file '%s'\n", prefs_path);
-    DeleteFile(temp_path);
+    ThemeGallery *window = init_theme_gallery(gallery.themes, gallery.count, NULL, metric);
+
+    /* Setup covers the screen, pens, layout and first frame */
+    end_phase("View setup");
+
+    if (window)
+    {
+      /* Blocks until the window is closed */
+      run_theme_gallery(window);
+    }
+    else
+    {
+      Printf("Failed to initialize theme gallery\n");
+    }
+
+    /* Time spent in the window is not part of any phase */
+    start_phase();
+  }
+  else if (gallery.count == 0)
+  {
+    Printf("ERROR: No themes to show\n");
+    success = FALSE;
   }
 
+  if (gallery.themes) free_mem(gallery.themes, gallery.capacity * sizeof(GalleryTheme));
   return success;
 }
 
 /**
- * Display version information
- */
-VOID show_version(VOID)
-{
-  Printf("%s %s (%s)\n", PROG_NAME, PROG_VERSION, PROG_DATE);
-  Printf("ViNCEd Theme Manager for AmigaDOS\n");
-  Printf("Converts various color formats to ViNCEd 16-bit RGB\n\n");
-}
-
-/**
- * Convert ColorList to AnsiColor array for display
+ * Look up the color metric VIEW matches pens with
  *
- * @param colors ColorList containing parsed theme colors
- * @param ansi_colors Array of 16 AnsiColor structures to fill
- * @return TRUE on success, FALSE on failure
+ * @param name RGB, REDMEAN or LAB in any case
+ * @param metric Receives the metric
+ * @return TRUE if name is a known metric, FALSE otherwise
  */
-BOOL convert_to_ansi_colors(ColorList *colors, AnsiColor *ansi_colors)
+BOOL parse_metric(const UBYTE *name, ColorMetric *metric)
 {
-  ColorEntry *entry;
-  UBYTE *line;
-  UBYTE *equals_pos;
-  UBYTE *hex_start;
-  ULONG r_val, g_val, b_val;
-  int color_index = 0;
-  int i;
-
-  if (!colors || !ansi_colors) return FALSE;
-
-  /* Initialize all colors to defaults first */
-  for (i = 0; i < 16; i++) {
-    ansi_colors[i] = default_ansi_colors[i];
-  }
-
-  /* Parse color entries, skipping CURSORCOLOR */
-  entry = colors->first;
-  while (entry && color_index < 16) {
-    line = entry->line;
-
-    /* Skip CURSORCOLOR entries */
-    if (starts_with(line, "CURSORCOLOR=")) {
-      entry = entry->next;
-      continue;
-    }
+  /* In ColorMetric order */
+  static const char *names[] = { "RGB", "REDMEAN", "LAB" };
+  ULONG length;
+  ULONG i;
 
-    /* Process COLOR entries */
-    if (starts_with(line, "COLOR=")) {
-      equals_pos = strchr(line, '=');
-      if (equals_pos) {
-        /* Find the three hex values (0x****) */
-        hex_start = strstr(equals_pos, "0x");
-        if (hex_start) {
-          UBYTE *hex2 = strstr(hex_start + 1, "0x");
-          if (hex2) {
-            UBYTE *hex3 = strstr(hex2 + 1, "0x");
-            if (hex3) {
-              /* Parse the 16-bit hex values */
-              r_val = strtoul(hex_start + 2, NULL, 16);
-              g_val = strtoul(hex2 + 2, NULL, 16);
-              b_val = strtoul(hex3 + 2, NULL, 16);
-
-              /* Convert 16-bit to 8-bit */
-              ansi_colors[color_index].red = (r_val >> 8) & 0xFF;
-              ansi_colors[color_index].green = (g_val >> 8) & 0xFF;
-              ansi_colors[color_index].blue = (b_val >> 8) & 0xFF;
-
-              /* Check for LOAD/NOLOAD flag */
-              if (strstr(line, "LOAD")) {
-                ansi_colors[color_index].load_flag = TRUE;
-              } else {
-                ansi_colors[color_index].load_flag = FALSE;
-              }
-
-              color_index++;
-            }
-          }
-        }
-      }
+  for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+  {
+    length = match_prefix(name, names[i]);
+    if (length && name[length] == '\0')
+    {
+      *metric = (ColorMetric)i;
+      return TRUE;
     }
-
-    entry = entry->next;
   }
 
-  return TRUE;
+  return FALSE;
 }
 
 /**
@@ -1089,28 +3952,46 @@ BOOL convert_to_ansi_colors(ColorList *colors, AnsiColor *ansi_colors)
 VOID show_usage(VOID)
 {
   show_version();
-  Printf("Usage: %s [THEMEFILE] [USE] [SAVE] [RESET] [CHECK] [VIEW] [LOAD|NOLOAD] [ANSI|NOANSI]\n\n", PROG_NAME);
+  Printf("Usage: %s [THEMEFILE] [USE] [SAVE] [RESET] [CHECK] [VIEW] [DIFF] [LIVE] [LOAD|NOLOAD] [ANSI|NOANSI] [FORCE] [STATS] [METRIC <name>]\n", PROG_NAME);
+  Printf("       %s THEMEFILE [THEMES...] TODIR <dir> [LOAD|NOLOAD] [ANSI|NOANSI]\n", PROG_NAME);
+  Printf("       %s THEMEFILE [THEMES...] VIEW [THEMEDIR <dir>] [METRIC <name>]\n", PROG_NAME);
+  Printf("       %s INDEX <dir>\n\n", PROG_NAME);
   Printf("THEMEFILE    - Theme file containing COLOR/CURSORCOLOR entries\n");
   Printf("USE/S        - Apply theme to ENV:ViNCEd.prefs (current session)\n");
   Printf("SAVE/S       - Apply theme to ENVARC:ViNCEd.prefs (persistent)\n");
   Printf("RESET/S      - Use default black colors (mutually exclusive)\n");
   Printf("CHECK/S      - Show parsed color entries with RGB values\n");
-  Printf("VIEW/S       - Display colors in a graphical window\n");
+  Printf("VIEW/S       - Display colors in a graphical window, or a gallery\n");
+  Printf("               of all themes if several are given\n");
   Printf("LOAD/S       - Force all colors to use LOAD flag\n");
   Printf("NOLOAD/S     - Force all colors to use NOLOAD flag (default)\n");
   Printf("ANSI/S       - Force all colors to use ANSI flag\n");
-  Printf("NOANSI/S     - Force all colors to use NOANSI flag (default)\n\n");
+  Printf("NOANSI/S     - Force all colors to use NOANSI flag (default)\n");
+  Printf("THEMES/M     - More theme files or patterns for TODIR or VIEW\n");
+  Printf("TODIR/K      - Convert all themes to canonical form in this directory\n");
+  Printf("NOCACHE/S    - Parse the theme file, ignoring its compiled .vtc cache\n");
+  Printf("FORCE/S      - Rewrite prefs files even if they already hold the colors\n");
+  Printf("STATS/S      - Report time per phase, I/O and memory use at exit\n");
+  Printf("DIFF/S       - Show the entries that differ from the prefs file\n");
+  Printf("LIVE/S       - Send the colors and cursor color to the current console\n");
+  Printf("INDEX/K      - Index every theme in this directory for fast lookup\n");
+  Printf("THEMEDIR/K   - Look THEMEFILE up by name in this directory's index\n");
+  Printf("METRIC/K     - Pen matching for VIEW: RGB, REDMEAN (default) or LAB\n\n");
   Printf("Note: LOAD/NOLOAD are mutually exclusive, as are ANSI/NOANSI.\n");
   Printf("      If neither is specified, the value from the theme file is used.\n\n");
   Printf("Input formats supported:\n");
   Printf("  0x1234     - 16-bit hex (passed through)\n");
   Printf("  0x12       - 8-bit hex (expanded to 0x1212)\n");
   Printf("  255        - Integer 0-255 (converted to 16-bit)\n");
-  Printf("  0.5        - Float 0.0-1.0 (converted to 16-bit)\n\n");
+  Printf("  0.5        - Decimal 0.0-1.0 (converted to 16-bit)\n");
+  Printf("  50%%        - Percentage 0-100 (converted to 16-bit)\n");
+  Printf("  #RRGGBB    - Whole color in place of r,g,b\n");
+  Printf("  0xRGB      - Whole 12-bit color in place of r,g,b\n\n");
   Printf("Parsing logic:\n");
   Printf("  1. Find first CURSORCOLOR= line (ignoring leading whitespace)\n");
   Printf("  2. Find next 16 COLOR= lines (ignoring leading whitespace)\n");
-  Printf("  3. Fill missing entries with defaults\n\n");
+  Printf("  3. Fill missing entries with defaults\n");
+  Printf("  USE and SAVE keep a compiled copy in THEMEFILE.vtc, used while it is current\n\n");
   Printf("Examples:\n");
   Printf("  %s MyTheme.txt USE        Apply theme for current session\n", PROG_NAME);
   Printf("  %s MyTheme.txt SAVE       Save theme for next boot\n", PROG_NAME);
@@ -1120,6 +4001,112 @@ VOID show_usage(VOID)
   Printf("  %s RESET USE SAVE         Reset to defaults\n", PROG_NAME);
   Printf("  %s MyTheme.txt CHECK      Preview theme colors\n", PROG_NAME);
   Printf("  %s MyTheme.txt VIEW       Display theme in graphical window\n", PROG_NAME);
+  Printf("  %s Themes/#? VIEW         Compare a theme library in one window\n", PROG_NAME);
+  Printf("  %s MyTheme.txt DIFF SAVE  Show and save only the changed entries\n", PROG_NAME);
+  Printf("  %s MyTheme.txt LIVE       Try a theme in the current console\n", PROG_NAME);
+  Printf("  %s INDEX Themes           Index a theme library\n", PROG_NAME);
+  Printf("  %s Dracula THEMEDIR Themes USE  Apply an indexed theme by name\n", PROG_NAME);
+  Printf("  %s Themes/#? TODIR RAM:T  Convert a whole theme library\n", PROG_NAME);
+}
+
+/**
+ * Check the parsed arguments for invalid combinations
+ *
+ * @param args Arguments from ReadArgs
+ * @return TRUE if the arguments can be used, FALSE after reporting the error
+ */
+BOOL check_args(LONG *args)
+{
+  /* Check for mutually exclusive LOAD/NOLOAD options */
+  if (args[ARG_LOAD] && args[ARG_NOLOAD])
+  {
+    Printf("ERROR: LOAD and NOLOAD are mutually exclusive\n");
+    return FALSE;
+  }
+
+  /* Check for mutually exclusive ANSI/NOANSI options */
+  if (args[ARG_ANSI] && args[ARG_NOANSI])
+  {
+    Printf("ERROR: ANSI and NOANSI are mutually exclusive\n");
+    return FALSE;
+  }
+
+  if (args[ARG_METRIC])
+  {
+    ColorMetric metric;
+
+    if (!parse_metric((UBYTE *)args[ARG_METRIC], &metric))
+    {
+      Printf("ERROR: METRIC must be RGB, REDMEAN or LAB\n");
+      return FALSE;
+    }
+  }
+
+  /* Indexing a theme directory is a command of its own */
+  if (args[ARG_INDEX])
+  {
+    if (args[ARG_THEMEFILE] || args[ARG_RESET] || args[ARG_USE] || args[ARG_SAVE] ||
+        args[ARG_CHECK] || args[ARG_VIEW] || args[ARG_DIFF] || args[ARG_LIVE] ||
+        args[ARG_TODIR] || args[ARG_THEMEDIR])
+    {
+      Printf("ERROR: INDEX cannot be combined with a theme or other actions\n");
+      return FALSE;
+    }
+    return TRUE;
+  }
+
+  if (args[ARG_THEMEDIR] && (args[ARG_RESET] || args[ARG_TODIR]))
+  {
+    Printf("ERROR: THEMEDIR cannot be combined with RESET or TODIR\n");
+    return FALSE;
+  }
+
+  /* Check batch conversion options */
+  if (args[ARG_TODIR])
+  {
+    if (args[ARG_RESET] || args[ARG_USE] || args[ARG_SAVE] || args[ARG_CHECK] || args[ARG_VIEW] ||
+        args[ARG_DIFF] || args[ARG_LIVE])
+    {
+      Printf("ERROR: TODIR cannot be combined with RESET, USE, SAVE, CHECK, VIEW, DIFF or LIVE\n");
+      return FALSE;
+    }
+  }
+  else if (args[ARG_THEMES] || (args[ARG_VIEW] && is_theme_pattern((UBYTE *)args[ARG_THEMEFILE])))
+  {
+    if (!args[ARG_VIEW])
+    {
+      Printf("ERROR: Multiple theme files require TODIR or VIEW\n");
+      return FALSE;
+    }
+    if (args[ARG_RESET] || args[ARG_USE] || args[ARG_SAVE] || args[ARG_CHECK] ||
+        args[ARG_DIFF] || args[ARG_LIVE])
+    {
+      Printf("ERROR: A gallery of themes can only be viewed\n");
+      return FALSE;
+    }
+  }
+
+  /* Check for mutually exclusive RESET option */
+  if (args[ARG_RESET])
+  {
+    if (args[ARG_THEMEFILE])
+    {
+      Printf("ERROR: RESET and THEMEFILE are mutually exclusive\n");
+      return FALSE;
+    }
+  }
+  else
+  {
+    /* If no RESET, require THEMEFILE */
+    if (!args[ARG_THEMEFILE])
+    {
+      Printf("ERROR: THEMEFILE required (or use RESET)\n");
+      show_usage();
+      return FALSE;
+    }
+  }
+
+  return TRUE;
 }
 
 /**
@@ -1133,8 +4120,11 @@ int main(VOID)
   LONG args[ARG_COUNT] = {0};
   ColorList theme_colors;
   ColorOverrides overrides;
+  ColorMetric metric = METRIC_REDMEAN;
+  ULONG cache_flags = 0;
   BOOL success = TRUE;
-  LONG result = RETURN_OK;
+
+  init_color_list(&theme_colors);
 
   /* Parse command line arguments */
   rdargs = ReadArgs(TEMPLATE, args, NULL);
@@ -1144,18 +4134,16 @@ int main(VOID)
     return RETURN_ERROR;
   }
 
-  /* Check for mutually exclusive LOAD/NOLOAD options */
-  if (args[ARG_LOAD] && args[ARG_NOLOAD])
+  /* Only time the run when asked to, so normal runs skip timer.device */
+  if (args[ARG_STATS])
   {
-    Printf("ERROR: LOAD and NOLOAD are mutually exclusive\n");
-    FreeArgs(rdargs);
-    return RETURN_ERROR;
+    open_timer();
+    start_phase();
   }
 
-  /* Check for mutually exclusive ANSI/NOANSI options */
-  if (args[ARG_ANSI] && args[ARG_NOANSI])
+  if (!check_args(args))
   {
-    Printf("ERROR: ANSI and NOANSI are mutually exclusive\n");
+    close_timer();
     FreeArgs(rdargs);
     return RETURN_ERROR;
   }
@@ -1166,35 +4154,25 @@ int main(VOID)
   overrides.override_ansi = (BOOL)(args[ARG_ANSI] || args[ARG_NOANSI]);
   overrides.use_ansi = (BOOL)args[ARG_ANSI];
 
-  /* Check for mutually exclusive RESET option */
-  if (args[ARG_RESET])
-  {
-    if (args[ARG_THEMEFILE])
-    {
-      Printf("ERROR: RESET and THEMEFILE are mutually exclusive\n");
-      FreeArgs(rdargs);
-      return RETURN_ERROR;
-    }
-  }
-  else
-  {
-    /* If no RESET, require THEMEFILE */
-    if (!args[ARG_THEMEFILE])
-    {
-      Printf("ERROR: THEMEFILE required (or use RESET)\n");
-      show_usage();
-      FreeArgs(rdargs);
-      return RETURN_ERROR;
-    }
-  }
+  if (args[ARG_METRIC]) parse_metric((UBYTE *)args[ARG_METRIC], &metric);
 
-  /* Check if no action specified, default to USE (unless CHECK or VIEW only) */
-  if (!args[ARG_USE] && !args[ARG_SAVE] && !args[ARG_CHECK] && !args[ARG_VIEW])
+  /* Check if no action specified, default to USE (unless CHECK, VIEW, DIFF, LIVE or batch) */
+  if (!args[ARG_USE] && !args[ARG_SAVE] && !args[ARG_CHECK] && !args[ARG_VIEW] && !args[ARG_DIFF] &&
+      !args[ARG_LIVE] && !args[ARG_TODIR] && !args[ARG_INDEX])
   {
     args[ARG_USE] = TRUE;
     Printf("No action specified, defaulting to USE\n");
   }
 
+  /* Only the actions that write preferences rebuild compiled caches */
+  if (!args[ARG_NOCACHE])
+  {
+    cache_flags = CACHE_READ;
+    if (args[ARG_USE] || args[ARG_SAVE]) cache_flags |= CACHE_WRITE;
+  }
+
+  end_phase("Arguments");
+
   /* Show version info */
   show_version();
 
@@ -1213,30 +4191,97 @@ int main(VOID)
     Printf("\n");
   }
 
+  /* Index a theme directory */
+  if (args[ARG_INDEX])
+  {
+    success = build_theme_index((UBYTE *)args[ARG_INDEX]);
+    end_phase("Index");
+
+    if (args[ARG_STATS]) report_stats();
+    close_timer();
+    FreeArgs(rdargs);
+    return success ? RETURN_OK : RETURN_ERROR;
+  }
+
+  /* Convert a whole theme library, or view several themes, in one run */
+  if (args[ARG_TODIR] ||
+      (args[ARG_VIEW] && (args[ARG_THEMES] || is_theme_pattern((UBYTE *)args[ARG_THEMEFILE]))))
+  {
+    UBYTE **themes = (UBYTE **)args[ARG_THEMES];
+    UBYTE **patterns;
+    ULONG count = 1;
+    ULONG i;
+
+    while (themes && themes[count - 1]) count++;
+
+    patterns = alloc_mem((count + 1) * sizeof(UBYTE *), MEMF_CLEAR);
+    if (!patterns)
+    {
+      Printf("ERROR: Out of memory\n");
+      close_timer();
+      FreeArgs(rdargs);
+      return RETURN_ERROR;
+    }
+
+    patterns[0] = (UBYTE *)args[ARG_THEMEFILE];
+    for (i = 1; i < count; i++)
+    {
+      patterns[i] = themes[i - 1];
+    }
+
+    if (args[ARG_TODIR])
+    {
+      success = convert_theme_batch(patterns, (UBYTE *)args[ARG_TODIR], &overrides);
+      end_phase("Batch conversion");
+    }
+    else
+    {
+      success = view_theme_gallery(patterns, (UBYTE *)args[ARG_THEMEDIR], &overrides,
+                                   cache_flags, metric);
+    }
+
+    free_mem(patterns, (count + 1) * sizeof(UBYTE *));
+
+    if (args[ARG_STATS]) report_stats();
+    close_timer();
+    FreeArgs(rdargs);
+    return success ? RETURN_OK : RETURN_ERROR;
+  }
+
   /* Read theme file or generate defaults */
   if (args[ARG_RESET])
   {
     if (!generate_default_colors(&theme_colors, &overrides))
     {
       Printf("ERROR: Failed to generate default colors\n");
-      result = RETURN_ERROR;
+      success = FALSE;
+    }
+  }
+  else if (args[ARG_THEMEDIR])
+  {
+    if (!load_indexed_theme((UBYTE *)args[ARG_THEMEDIR], (UBYTE *)args[ARG_THEMEFILE],
+                            &theme_colors, &overrides, cache_flags))
+    {
+      Printf("ERROR: Failed to read theme '%s'\n", (UBYTE *)args[ARG_THEMEFILE]);
       success = FALSE;
     }
   }
   else
   {
-    if (!read_theme_file((UBYTE *)args[ARG_THEMEFILE], &theme_colors, &overrides))
+    if (!load_theme((UBYTE *)args[ARG_THEMEFILE], &theme_colors, &overrides, cache_flags))
     {
       Printf("ERROR: Failed to read theme file '%s'\n", (UBYTE *)args[ARG_THEMEFILE]);
-      result = RETURN_ERROR;
       success = FALSE;
     }
   }
 
+  end_phase("Read theme");
+
   /* Display color check if requested */
   if (success && args[ARG_CHECK])
   {
     display_color_check(&theme_colors);
+    end_phase("Check");
   }
 
   /* Display colors in window if requested */
@@ -1247,8 +4292,23 @@ int main(VOID)
     /* Convert ColorList to AnsiColor array */
     if (convert_to_ansi_colors(&theme_colors, ansi_colors))
     {
-      /* Display the color window - this will block until window is closed */
-      show_color_swatch_window(ansi_colors, NULL);
+      ColorSwatchWindow *window = init_color_swatch_window(ansi_colors, NULL, metric);
+
+      /* Setup covers the screen, pens, layout and first frame */
+      end_phase("View setup");
+
+      if (window)
+      {
+        /* Display the color window - this will block until window is closed */
+        run_color_swatch_window(window);
+      }
+      else
+      {
+        Printf("Failed to initialize color swatch window\n");
+      }
+
+      /* Time spent in the window is not part of any phase */
+      start_phase();
     }
     else
     {
@@ -1257,31 +4317,41 @@ int main(VOID)
     }
   }
 
-  /* Apply to ENV: if requested */
-  if (success && args[ARG_USE])
+  /* Load the colors into the console's screen if requested */
+  if (success && args[ARG_LIVE])
   {
-    if (!update_prefs_file("ENV:ViNCEd.prefs", &theme_colors))
-    {
-      Printf("ERROR: Failed to update ENV:ViNCEd.prefs\n");
-      success = FALSE;
-    }
+    apply_live_colors(&theme_colors);
+    end_phase("Live");
   }
 
-  /* Apply to ENVARC: if requested */
-  if (success && args[ARG_SAVE])
+  /* Apply to ENV: and/or ENVARC: if requested, reading each file once */
+  if (success && (args[ARG_USE] || args[ARG_SAVE] || args[ARG_DIFF]))
   {
-    if (!update_prefs_file("ENVARC:ViNCEd.prefs", &theme_colors))
+    const UBYTE *targets[MAX_PREFS_TARGETS];
+    ULONG target_count = 0;
+    ULONG flags = 0;
+
+    if (args[ARG_FORCE]) flags |= UPDATE_FORCE;
+    if (args[ARG_DIFF]) flags |= UPDATE_DIFF;
+
+    if (args[ARG_USE]) targets[target_count++] = (const UBYTE *)"ENV:ViNCEd.prefs";
+    if (args[ARG_SAVE]) targets[target_count++] = (const UBYTE *)"ENVARC:ViNCEd.prefs";
+
+    /* DIFF on its own compares with the current session's colors */
+    if (!target_count)
     {
-      Printf("ERROR: Failed to update ENVARC:ViNCEd.prefs\n");
-      success = FALSE;
+      targets[target_count++] = (const UBYTE *)"ENV:ViNCEd.prefs";
+      flags |= UPDATE_DRY_RUN;
     }
+
+    success = update_prefs_files(targets, target_count, &theme_colors, flags);
   }
 
   /* Clean up */
-  if (theme_colors.count > 0)
-  {
-    free_color_list(&theme_colors);
-  }
+  free_color_list(&theme_colors);
+
+  if (args[ARG_STATS]) report_stats();
+  close_timer();
 
   FreeArgs(rdargs);
 
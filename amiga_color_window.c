@@ -1,13 +1,18 @@
 #include "amiga_color_window.h"
+#include "lab_tables.h"
+#include "pen_assign.h"
 
 #include <exec/types.h>
 #include <exec/memory.h>
+#include <exec/libraries.h>
 #include <graphics/gfx.h>
+#include <graphics/gfxbase.h>
 #include <graphics/view.h>
 #include <graphics/displayinfo.h>
+#include <graphics/text.h>
 #include <intuition/intuition.h>
 #include <intuition/screens.h>
-#include <libraries/gadtools.h>
+#include <intuition/intuitionbase.h>
 #include <libraries/iffparse.h>
 #include <prefs/font.h>
 #include <devices/input.h>
@@ -15,7 +20,6 @@
 #include <proto/exec.h>
 #include <proto/graphics.h>
 #include <proto/intuition.h>
-#include <proto/gadtools.h>
 #include <proto/diskfont.h>
 #include <proto/iffparse.h>
 #include <proto/dos.h>
@@ -27,8 +31,72 @@
 #define BORDER_HEIGHT 6         ///< Custom border height in pixels
 #define BUTTON_WIDTH 80         ///< Width of buttons
 #define BUTTON_HEIGHT 20        ///< Height of buttons
-#define SWATCH_SIZE 24          ///< Size of color swatches
+#define SWATCH_SIZE 24          ///< Height of color swatches when the screen has room
 #define SWATCH_SPACING 2        ///< Spacing between swatches
+#define PEN_SEARCH_LIMIT 20000  ///< Most solver nodes per theme; keeps slow machines responsive
+#define DAMAGE_BORDER 0x0001    ///< Window border needs redrawing
+#define DAMAGE_CYCLE 0x0002     ///< Display format cycle gadget needs redrawing
+#define DAMAGE_CLOSE 0x0004     ///< Close button needs redrawing
+#define DAMAGE_SWATCHES 0x0008  ///< All swatches need redrawing
+#define DAMAGE_TABLE 0x0010     ///< Whole color table needs redrawing
+#define LAYOUT_MARGIN 16        ///< Space around the swatches and the table
+#define LAYOUT_GAP 8            ///< Space around the buttons
+#define GALLERY_SWATCH_SIZE 14  ///< Size of color swatches in a gallery row
+#define GALLERY_NAME_WIDTH 120  ///< Width of the theme name column in a gallery row
+#define KEY_CURSOR_UP 0x4C      ///< Raw key code of cursor up
+#define KEY_CURSOR_DOWN 0x4D    ///< Raw key code of cursor down
+#define KEY_WHEEL_UP 0x7A       ///< Raw key code sent by NewMouse for wheel up
+#define KEY_WHEEL_DOWN 0x7B     ///< Raw key code sent by NewMouse for wheel down
+
+// Library bases are defined in ViNCEd_Theme.c, in the root of the overlay
+// tree; open_gui_libraries opens them on demand
+extern struct GfxBase *GfxBase;
+extern struct IntuitionBase *IntuitionBase;
+extern struct Library *DiskfontBase;
+extern struct Library *IFFParseBase;
+static UWORD gui_library_users = 0;           ///< Windows that opened the libraries
+
+/**
+ * @brief Closes the GUI libraries once the last window is gone
+ */
+static void close_gui_libraries(void)
+{
+  if (gui_library_users == 0 || --gui_library_users > 0) return;
+
+  if (IFFParseBase) CloseLibrary(IFFParseBase);
+  if (DiskfontBase) CloseLibrary(DiskfontBase);
+  if (IntuitionBase) CloseLibrary((struct Library *)IntuitionBase);
+  if (GfxBase) CloseLibrary((struct Library *)GfxBase);
+
+  IFFParseBase = NULL;
+  DiskfontBase = NULL;
+  IntuitionBase = NULL;
+  GfxBase = NULL;
+}
+
+/**
+ * @brief Opens the GUI libraries for the first window
+ * Without diskfont or iffparse the screen font is used instead of the
+ * one from Font preferences.
+ * @return TRUE if graphics and intuition V39 are available
+ */
+static BOOL open_gui_libraries(void)
+{
+  if (gui_library_users++ > 0) return TRUE;
+
+  GfxBase = (struct GfxBase *)OpenLibrary("graphics.library", 39);
+  IntuitionBase = (struct IntuitionBase *)OpenLibrary("intuition.library", 39);
+  DiskfontBase = OpenLibrary("diskfont.library", 36);
+  IFFParseBase = OpenLibrary("iffparse.library", 36);
+
+  if (!GfxBase || !IntuitionBase) {
+    printf("Failed to open graphics.library and intuition.library V39\n");
+    close_gui_libraries();
+    return FALSE;
+  }
+
+  return TRUE;
+}
 
 /**
  * @brief Gets pixel aspect ratio from IControl preferences
@@ -63,6 +131,32 @@ static void get_pixel_aspect_ratio(ColorSwatchWindow *csw)
   }
 }
 
+/**
+ * @brief Adds a rectangle of the back buffer to the area waiting to be shown
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param x0 Left edge
+ * @param y0 Top edge
+ * @param x1 Right edge (inclusive)
+ * @param y1 Bottom edge (inclusive)
+ */
+static void mark_dirty(ColorSwatchWindow *csw, WORD x0, WORD y0, WORD x1, WORD y1)
+{
+  if (!csw->back_bitmap) return;
+
+  if (csw->dirty_x1 < csw->dirty_x0) {
+    csw->dirty_x0 = x0;
+    csw->dirty_y0 = y0;
+    csw->dirty_x1 = x1;
+    csw->dirty_y1 = y1;
+    return;
+  }
+
+  if (x0 < csw->dirty_x0) csw->dirty_x0 = x0;
+  if (y0 < csw->dirty_y0) csw->dirty_y0 = y0;
+  if (x1 > csw->dirty_x1) csw->dirty_x1 = x1;
+  if (y1 > csw->dirty_y1) csw->dirty_y1 = y1;
+}
+
 /**
  * @brief Draws the custom minimalist border around the window
  * @param csw Pointer to ColorSwatchWindow structure
@@ -77,6 +171,8 @@ static void draw_custom_border(ColorSwatchWindow *csw)
   WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
   WORD adj_border_height = BORDER_HEIGHT;
 
+  mark_dirty(csw, 0, 0, width - 1, height - 1);
+
   // Draw outer border (darker)
   SetAPen(rp, 2); // Dark pen
 
@@ -108,14 +204,17 @@ static void draw_custom_border(ColorSwatchWindow *csw)
  * @param csw Pointer to ColorSwatchWindow structure
  * @param button Pointer to ButtonRect structure
  * @param text Button text
+ * @param text_width Pixel width of text in the window font
  * @param pressed TRUE if button is pressed
  */
 static void draw_button(ColorSwatchWindow *csw, ButtonRect *button, 
-                       char *text, BOOL pressed)
+                       char *text, WORD text_width, BOOL pressed)
 {
   struct RastPort *rp = csw->rastport;
   WORD text_x, text_y;
-  WORD text_len;
+
+  mark_dirty(csw, button->x, button->y,
+             button->x + button->width - 1, button->y + button->height - 1);
 
   // Draw button background using proper background pen
   SetAPen(rp, 0); // Use background pen (typically white/light)
@@ -142,8 +241,7 @@ static void draw_button(ColorSwatchWindow *csw, ButtonRect *button,
   SetAPen(rp, 1); // Use foreground pen instead of pen 3
   SetFont(rp, csw->font);
   
-  text_len = TextLength(rp, text, strlen(text));
-  text_x = button->x + (button->width - text_len) / 2;
+  text_x = button->x + (button->width - text_width) / 2;
   text_y = button->y + (button->height + csw->font->tf_YSize) / 2 - 2;
   
   Move(rp, text_x, text_y);
@@ -157,18 +255,13 @@ static void draw_button(ColorSwatchWindow *csw, ButtonRect *button,
 static void draw_cycle_gadget(ColorSwatchWindow *csw)
 {
   struct RastPort *rp = csw->rastport;
-  WORD window_height = csw->window->Height;
-  WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
-  WORD gadget_y = window_height - BORDER_HEIGHT - BUTTON_HEIGHT - 8;
   char *mode_texts[] = {"RGB", "HEX", "PEN"};
   char *current_text = mode_texts[csw->cycle_mode];
-  WORD text_len, arrow_x;
-  
-  // Position cycle gadget
-  csw->rgb_button.x = adj_border_width + 8;
-  csw->rgb_button.y = gadget_y;
-  csw->rgb_button.width = BUTTON_WIDTH;
-  csw->rgb_button.height = BUTTON_HEIGHT;
+  WORD arrow_x;
+
+  mark_dirty(csw, csw->rgb_button.x, csw->rgb_button.y,
+             csw->rgb_button.x + csw->rgb_button.width - 1,
+             csw->rgb_button.y + csw->rgb_button.height - 1);
   
   // Draw gadget background using proper background pen
   SetAPen(rp, 0); // Use background pen (typically white/light)
@@ -196,11 +289,10 @@ static void draw_cycle_gadget(ColorSwatchWindow *csw)
   // Draw current mode text
   SetAPen(rp, 1); // Use foreground pen instead of pen 3
   SetFont(rp, csw->font);
-  text_len = TextLength(rp, current_text, strlen(current_text));
   
   Move(rp, csw->rgb_button.x + 4, 
        csw->rgb_button.y + (csw->rgb_button.height + csw->font->tf_YSize) / 2 - 2);
-  Text(rp, current_text, strlen(current_text));
+  Text(rp, current_text, 3);
   
   // Draw cycle arrows (indicating it's clickable)
   arrow_x = csw->rgb_button.x + csw->rgb_button.width - 12;
@@ -223,20 +315,10 @@ static void draw_cycle_gadget(ColorSwatchWindow *csw)
  */
 static void draw_bottom_buttons(ColorSwatchWindow *csw)
 {
-  WORD window_width = csw->window->Width;
-  WORD window_height = csw->window->Height;
-  WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
-  WORD button_y = window_height - BORDER_HEIGHT - BUTTON_HEIGHT - 8;
-  
-  // Position close button
-  csw->close_button.x = window_width - adj_border_width - BUTTON_WIDTH - 8;
-  csw->close_button.y = button_y;
-  csw->close_button.width = BUTTON_WIDTH;
-  csw->close_button.height = BUTTON_HEIGHT;
-  
   // Draw the cycle gadget and close button
   draw_cycle_gadget(csw);
-  draw_button(csw, &csw->close_button, "Close", csw->close_button_pressed);
+  draw_button(csw, &csw->close_button, "Close", csw->text.close_width,
+              csw->close_button_pressed);
 }
 
 /**
@@ -264,14 +346,35 @@ static BOOL point_in_button(ButtonRect *button, WORD x, WORD y)
  */
 static int point_in_swatch(ColorSwatchWindow *csw, WORD x, WORD y)
 {
-  int i;
-  for (i = 0; i < 16; i++) {
-    if (x >= csw->swatches[i].x && x < csw->swatches[i].x + csw->swatches[i].width &&
-        y >= csw->swatches[i].y && y < csw->swatches[i].y + csw->swatches[i].height) {
-      return i;
-    }
-  }
-  return -1;
+  SwatchLayout *layout = &csw->layout;
+  WORD dx = x - layout->swatch_grid.x;
+  WORD dy = y - layout->swatch_grid.y;
+
+  if (!point_in_button(&layout->swatch_grid, x, y)) return -1;
+
+  // The spacing between swatches belongs to none of them
+  if (dx % layout->pitch_x >= layout->swatch_width ||
+      dy % layout->pitch_y >= layout->swatch_height) return -1;
+
+  return (dy / layout->pitch_y) * 8 + dx / layout->pitch_x;
+}
+
+/**
+ * @brief Tests if a point is within a row of the color table
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param x X coordinate to test
+ * @param y Y coordinate to test
+ * @return Color index (0-15) of the column hit or -1 if not in the table
+ */
+static int point_in_table(ColorSwatchWindow *csw, WORD x, WORD y)
+{
+  SwatchLayout *layout = &csw->layout;
+  int row;
+
+  if (!point_in_button(&layout->table, x, y)) return -1;
+
+  row = (y - layout->table.y) / layout->row_height;
+  return (x - layout->table.x < layout->column_width) ? row : row + 8;
 }
 
 /**
@@ -351,51 +454,317 @@ static ULONG calculate_color_distance(UBYTE r1, UBYTE g1, UBYTE b1,
 }
 
 /**
- * @brief Finds the closest available pen for a given RGB color
+ * @brief Calculates the redmean-weighted distance of two colors
+ * Weighs red and blue by how red the colors are, which tracks perceived
+ * differences far better than plain RGB for the cost of two multiplies.
+ * @param r1 Red component of first color
+ * @param g1 Green component of first color
+ * @param b1 Blue component of first color
+ * @param r2 Red component of second color
+ * @param g2 Green component of second color
+ * @param b2 Blue component of second color
+ * @return Distance value (lower = closer match)
+ */
+static ULONG calculate_redmean_distance(UBYTE r1, UBYTE g1, UBYTE b1,
+                                       UBYTE r2, UBYTE g2, UBYTE b2)
+{
+  LONG rmean = (r1 + r2) >> 1;
+  LONG dr = r1 - r2;
+  LONG dg = g1 - g2;
+  LONG db = b1 - b2;
+
+  return (ULONG)((((512 + rmean) * dr * dr) >> 8) + 4 * dg * dg +
+                 (((767 - rmean) * db * db) >> 8));
+}
+
+/**
+ * @brief Converts an sRGB color to CIE L*a*b* with integer math only
+ * @param red Red component
+ * @param green Green component
+ * @param blue Blue component
+ * @param lab Receives L*, a* and b* in 1/8 units
+ */
+static void rgb_to_lab(UBYTE red, UBYTE green, UBYTE blue, WORD *lab)
+{
+  ULONG linear[3];
+  LONG f[3];
+  ULONG t, index, fraction;
+  int i;
+
+  linear[0] = srgb_to_linear[red];
+  linear[1] = srgb_to_linear[green];
+  linear[2] = srgb_to_linear[blue];
+
+  // X, Y and Z relative to the white point, then f(t) interpolated from the
+  // table; f is too steep near black for the table steps alone
+  for (i = 0; i < 3; i++) {
+    t = (linear_to_xyz[i][0] * linear[0] + linear_to_xyz[i][1] * linear[1] +
+         linear_to_xyz[i][2] * linear[2]) >> (15 + 15 - LAB_F_BITS - 8);
+    index = t >> 8;
+    fraction = t & 0xFF;
+    if (index >= (1 << LAB_F_BITS)) {
+      f[i] = lab_f_table[1 << LAB_F_BITS];
+    }
+    else {
+      f[i] = lab_f_table[index] +
+             (((lab_f_table[index + 1] - lab_f_table[index]) * fraction + 0x80) >> 8);
+    }
+  }
+
+  lab[0] = (WORD)(((116 * 8 * f[1] + 0x4000) >> 15) - 16 * 8);
+  lab[1] = (WORD)((500 * 8 * (f[0] - f[1]) + 0x4000) >> 15);
+  lab[2] = (WORD)((200 * 8 * (f[1] - f[2]) + 0x4000) >> 15);
+}
+
+/**
+ * @brief Calculates the CIE76 distance of two colors in L*a*b*
+ * @param lab1 First color from rgb_to_lab
+ * @param lab2 Second color from rgb_to_lab
+ * @return Squared distance (lower = closer match)
+ */
+static ULONG calculate_lab_distance(const WORD *lab1, const WORD *lab2)
+{
+  LONG dl = lab1[0] - lab2[0];
+  LONG da = lab1[1] - lab2[1];
+  LONG db = lab1[2] - lab2[2];
+
+  return (ULONG)((dl * dl) + (da * da) + (db * db));
+}
+
+/**
+ * @brief Calculates the distance of two colors with the window's metric
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param rgb1 Red, green and blue of the first color
+ * @param lab1 L*a*b* of the first color (used by METRIC_LAB only)
+ * @param rgb2 Red, green and blue of the second color
+ * @param lab2 L*a*b* of the second color (used by METRIC_LAB only)
+ * @return Distance value (lower = closer match)
+ */
+static ULONG metric_distance(ColorSwatchWindow *csw, const UBYTE *rgb1, const WORD *lab1,
+                             const UBYTE *rgb2, const WORD *lab2)
+{
+  switch (csw->metric) {
+    case METRIC_REDMEAN:
+      return calculate_redmean_distance(rgb1[0], rgb1[1], rgb1[2],
+                                        rgb2[0], rgb2[1], rgb2[2]);
+
+    case METRIC_LAB:
+      return calculate_lab_distance(lab1, lab2);
+
+    default:
+      return calculate_color_distance(rgb1[0], rgb1[1], rgb1[2],
+                                      rgb2[0], rgb2[1], rgb2[2]);
+  }
+}
+
+/**
+ * @brief Converts a pen of the palette snapshot for the Lab metric
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param pen Pen to convert
+ */
+static void update_palette_lab(ColorSwatchWindow *csw, UWORD pen)
+{
+  if (csw->metric == METRIC_LAB) {
+    rgb_to_lab(csw->palette[pen][0], csw->palette[pen][1], csw->palette[pen][2],
+               csw->palette_lab[pen]);
+  }
+}
+
+/**
+ * @brief Reads all pen colors of the screen with one batched GetRGB32 call
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void snapshot_palette(ColorSwatchWindow *csw)
+{
+  struct ColorMap *cm = csw->screen->ViewPort.ColorMap;
+  ULONG *table = AllocVec(csw->available_pens * 3 * sizeof(ULONG), 0);
+  ULONG rgb_values[3];
+  UWORD pen;
+
+  if (table) {
+    GetRGB32(cm, 0, csw->available_pens, table);
+  }
+
+  for (pen = 0; pen < csw->available_pens; pen++) {
+    if (!table) {
+      // Out of memory: one pen at a time, but still only once
+      GetRGB32(cm, pen, 1, rgb_values);
+    }
+    csw->palette[pen][0] = ((table ? table[pen * 3] : rgb_values[0]) >> 24) & 0xFF;
+    csw->palette[pen][1] = ((table ? table[pen * 3 + 1] : rgb_values[1]) >> 24) & 0xFF;
+    csw->palette[pen][2] = ((table ? table[pen * 3 + 2] : rgb_values[2]) >> 24) & 0xFF;
+    update_palette_lab(csw, pen);
+  }
+
+  if (table) {
+    FreeVec(table);
+  }
+
+  csw->palette_valid = TRUE;
+}
+
+/**
+ * @brief Updates the palette snapshot after the window set or obtained a pen
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param pen Pen whose color may have changed
+ */
+static void note_pen_changed(ColorSwatchWindow *csw, UBYTE pen)
+{
+  ULONG rgb_values[3];
+
+  if (!csw->palette_valid) return;
+
+  GetRGB32(csw->screen->ViewPort.ColorMap, pen, 1, rgb_values);
+  csw->palette[pen][0] = (rgb_values[0] >> 24) & 0xFF;
+  csw->palette[pen][1] = (rgb_values[1] >> 24) & 0xFF;
+  csw->palette[pen][2] = (rgb_values[2] >> 24) & 0xFF;
+  update_palette_lab(csw, pen);
+}
+
+/**
+ * @brief Searches the palette snapshot for the pen closest to a color
  * @param csw Pointer to ColorSwatchWindow structure
  * @param red Red component to match
  * @param green Green component to match
  * @param blue Blue component to match
  * @return Best matching pen number
  */
-static UBYTE find_closest_pen(ColorSwatchWindow *csw, UBYTE red, UBYTE green, UBYTE blue)
+static UBYTE scan_palette(ColorSwatchWindow *csw, UBYTE red, UBYTE green, UBYTE blue)
 {
   UBYTE best_pen = 0;
   ULONG best_distance = 0xFFFFFFFF;
-  ULONG *rgb;
-  UBYTE pen_red, pen_green, pen_blue;
-  UBYTE pen;
   ULONG distance;
+  UBYTE rgb[3];
+  WORD lab[3];
+  UWORD pen;
+
+  rgb[0] = red;
+  rgb[1] = green;
+  rgb[2] = blue;
+  if (csw->metric == METRIC_LAB) {
+    rgb_to_lab(red, green, blue, lab);
+  }
 
   for (pen = 0; pen < csw->available_pens; pen++) {
-    ULONG rgb_values[3];
-    GetRGB32(csw->screen->ViewPort.ColorMap, pen, 1, rgb_values);
-    rgb = rgb_values;
-
-    pen_red = (rgb[0] >> 24) & 0xFF;
-    pen_green = (rgb[1] >> 24) & 0xFF;
-    pen_blue = (rgb[2] >> 24) & 0xFF;
-
-    distance = calculate_color_distance(red, green, blue,
-                                            pen_red, pen_green, pen_blue);
+    distance = metric_distance(csw, rgb, lab, csw->palette[pen], csw->palette_lab[pen]);
 
     if (distance < best_distance) {
       best_distance = distance;
-      best_pen = pen;
+      best_pen = (UBYTE)pen;
+      if (distance == 0) break;
     }
   }
 
   return best_pen;
 }
 
+/**
+ * @brief Finds the closest available pen for a given RGB color
+ * The window matches at most one pen per swatch, so the palette snapshot is
+ * scanned for the color itself; an inverse colormap of 5-bit cells costs a
+ * scan per cell and only pays off after thousands of matches.
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param red Red component to match
+ * @param green Green component to match
+ * @param blue Blue component to match
+ * @return Best matching pen number
+ */
+static UBYTE find_closest_pen(ColorSwatchWindow *csw, UBYTE red, UBYTE green, UBYTE blue)
+{
+  if (!csw->palette_valid) {
+    snapshot_palette(csw);
+  }
+
+  return scan_palette(csw, red, green, blue);
+}
+
+/**
+ * @brief Assigns pens on 8 and 16 color screens with the lowest total error
+ * Builds the cost of every color against every pen once, then lets the
+ * solver decide which of the last 8 pens of a 16 color screen to load with
+ * LOAD colors and which colors share a pen.
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void assign_constrained_pens(ColorSwatchWindow *csw)
+{
+  PenProblem *problem;
+  PenAssignment result;
+  UBYTE rgb[16][3];
+  WORD lab[16][3];
+  int c, p, l;
+
+  problem = AllocVec(sizeof(PenProblem), MEMF_CLEAR);
+  if (!problem) {
+    // Out of memory: closest match only
+    for (c = 0; c < 16; c++) {
+      csw->colors[c].assigned_pen = find_closest_pen(csw,
+        csw->colors[c].red, csw->colors[c].green, csw->colors[c].blue);
+    }
+    return;
+  }
+
+  if (!csw->palette_valid) {
+    snapshot_palette(csw);
+  }
+
+  for (c = 0; c < 16; c++) {
+    rgb[c][0] = csw->colors[c].red;
+    rgb[c][1] = csw->colors[c].green;
+    rgb[c][2] = csw->colors[c].blue;
+    if (csw->metric == METRIC_LAB) {
+      rgb_to_lab(rgb[c][0], rgb[c][1], rgb[c][2], lab[c]);
+    }
+    if (csw->colors[c].load_flag) {
+      problem->loadable |= 1 << c;
+    }
+  }
+
+  problem->pen_count = csw->available_pens;
+  for (c = 0; c < 16; c++) {
+    for (p = 0; p < problem->pen_count; p++) {
+      problem->cost[c][p] = metric_distance(csw, rgb[c], lab[c],
+                                            csw->palette[p], csw->palette_lab[p]);
+    }
+    for (l = 0; l < 16; l++) {
+      problem->load_cost[c][l] = metric_distance(csw, rgb[c], lab[c], rgb[l], lab[l]);
+    }
+  }
+
+  problem->node_limit = PEN_SEARCH_LIMIT;
+
+  // Only the last 8 pens of a 16 color screen may be reprogrammed
+  if (csw->depth == 4) {
+    for (p = 8; p < 16; p++) {
+      problem->free_pens[problem->free_count++] = (UBYTE)p;
+    }
+  }
+
+  solve_pen_assignment(problem, &result);
+
+  for (p = 0; p < problem->pen_count; p++) {
+    if (result.load[p] != ASSIGN_NO_LOAD) {
+      l = result.load[p];
+      SetRGB32(&csw->screen->ViewPort, p,
+              (csw->colors[l].red << 24) | 0x00FFFFFF,
+              (csw->colors[l].green << 24) | 0x00FFFFFF,
+              (csw->colors[l].blue << 24) | 0x00FFFFFF);
+      note_pen_changed(csw, (UBYTE)p);
+    }
+  }
+
+  for (c = 0; c < 16; c++) {
+    csw->colors[c].assigned_pen = result.pen[c];
+  }
+
+  FreeVec(problem);
+}
+
 /**
  * @brief Allocates and assigns pens based on screen capabilities
  * @param csw Pointer to ColorSwatchWindow structure
  */
 static void assign_color_pens(ColorSwatchWindow *csw)
 {
-  UBYTE load_pen_start;
-  UBYTE load_pen_count = 0;
   int i;
 
   // Determine behavior based on bit depth
@@ -413,42 +782,8 @@ static void assign_color_pens(ColorSwatchWindow *csw)
       break;
 
     case 3: // 8 colors - no loading, closest match only
-      for (i = 0; i < 16; i++) {
-        if (i < 8) {
-          csw->colors[i].assigned_pen = find_closest_pen(csw,
-            csw->colors[i].red, csw->colors[i].green, csw->colors[i].blue);
-        }
-        else {
-          // Mirror first 8 colors
-          csw->colors[i].assigned_pen = csw->colors[i - 8].assigned_pen;
-        }
-      }
-      break;
-
-    case 4: // 16 colors - 12 available for reassignment
-      load_pen_start = 8; // Last 8 pens available for loading
-
-      for (i = 0; i < 16; i++) {
-        if (csw->colors[i].load_flag && load_pen_count < 8) {
-          // Allocate a pen and set its color
-          csw->colors[i].assigned_pen = load_pen_start + load_pen_count;
-          SetRGB32(&csw->screen->ViewPort, csw->colors[i].assigned_pen,
-                  (csw->colors[i].red << 24) | 0x00FFFFFF,
-                  (csw->colors[i].green << 24) | 0x00FFFFFF,
-                  (csw->colors[i].blue << 24) | 0x00FFFFFF);
-          load_pen_count++;
-        }
-        else {
-          if (i < 8) {
-            csw->colors[i].assigned_pen = find_closest_pen(csw,
-              csw->colors[i].red, csw->colors[i].green, csw->colors[i].blue);
-          }
-          else {
-            // Mirror first 8 for bright colors
-            csw->colors[i].assigned_pen = csw->colors[i - 8].assigned_pen;
-          }
-        }
-      }
+    case 4: // 16 colors - last 8 pens available for loading
+      assign_constrained_pens(csw);
       break;
 
     default: // 5+ bit planes (32+ colors) - full loading capability
@@ -465,6 +800,7 @@ static void assign_color_pens(ColorSwatchWindow *csw)
           if (pen != -1) {
             csw->colors[i].assigned_pen = pen;
             csw->allocated_pens[i] = pen;
+            note_pen_changed(csw, (UBYTE)pen);
           }
           else {
             csw->colors[i].assigned_pen = find_closest_pen(csw,
@@ -478,6 +814,9 @@ static void assign_color_pens(ColorSwatchWindow *csw)
       }
       break;
   }
+
+  // Pen numbers are part of the cached table text
+  csw->text.valid = FALSE;
 }
 
 /**
@@ -490,7 +829,6 @@ static void open_user_font(ColorSwatchWindow *csw)
   struct IFFHandle *iff = NULL;
   struct FontPrefs fontprefs;
   BPTR fh;
-  BOOL prefs_loaded = FALSE;
 
   // Initialize defaults
   ta.ta_Name = "topaz.font";
@@ -505,7 +843,7 @@ static void open_user_font(ColorSwatchWindow *csw)
   }
   
   if (fh) {
-    iff = AllocIFF();
+    iff = IFFParseBase ? AllocIFF() : NULL;
     if (iff) {
       iff->iff_Stream = (ULONG)fh;
       InitIFFasDOS(iff);
@@ -514,15 +852,14 @@ static void open_user_font(ColorSwatchWindow *csw)
         if (PropChunk(iff, MAKE_ID('P','R','E','F'), MAKE_ID('F','O','N','T')) == 0) {
           if (ParseIFF(iff, IFFPARSE_SCAN) == 0) {
             struct StoredProperty *sp = FindProp(iff, MAKE_ID('P','R','E','F'), MAKE_ID('F','O','N','T'));
-            if (sp && sp->sp_Size >= sizeof(struct FontPrefs)) {
+            if (sp && sp->sp_Size >= (LONG)sizeof(struct FontPrefs)) {
               CopyMem(sp->sp_Data, &fontprefs, sizeof(struct FontPrefs));
               
               // Use system font preferences
-              ta.ta_Name = fontprefs.fp_Name;
+              ta.ta_Name = (STRPTR)fontprefs.fp_Name;
               ta.ta_YSize = fontprefs.fp_TextAttr.ta_YSize;
               ta.ta_Style = fontprefs.fp_TextAttr.ta_Style;
               ta.ta_Flags = fontprefs.fp_TextAttr.ta_Flags;
-              prefs_loaded = TRUE;
             }
           }
         }
@@ -534,7 +871,7 @@ static void open_user_font(ColorSwatchWindow *csw)
   }
 
   // Try to open the font
-  csw->font = OpenDiskFont(&ta);
+  csw->font = DiskfontBase ? OpenDiskFont(&ta) : NULL;
   if (!csw->font) {
     // If preferred font failed, try screen font
     csw->font = csw->screen->RastPort.Font;
@@ -544,7 +881,7 @@ static void open_user_font(ColorSwatchWindow *csw)
       ta.ta_YSize = 8;
       ta.ta_Style = 0;
       ta.ta_Flags = 0;
-      csw->font = OpenDiskFont(&ta);
+      csw->font = DiskfontBase ? OpenDiskFont(&ta) : NULL;
     }
   }
 
@@ -552,17 +889,20 @@ static void open_user_font(ColorSwatchWindow *csw)
   if (!csw->font) {
     csw->font = csw->screen->RastPort.Font;
   }
+
+  csw->text.valid = FALSE;
 }
 
 /**
- * @brief Formats color value according to current display format
+ * @brief Formats color value in a display format
  * @param csw Pointer to ColorSwatchWindow structure
  * @param color_index Index of the color to format
- * @param buffer Buffer to store formatted string
+ * @param format Display format to use
+ * @param buffer Buffer of VALUE_TEXT_SIZE characters to store formatted string
  * @param requested TRUE for requested RGB, FALSE for displayed RGB
  */
 static void format_color_value(ColorSwatchWindow *csw, int color_index,
-                              char *buffer, BOOL requested)
+                              DisplayFormat format, char *buffer, BOOL requested)
 {
   AnsiColor *color = &csw->colors[color_index];
   UBYTE r, g, b;
@@ -573,17 +913,16 @@ static void format_color_value(ColorSwatchWindow *csw, int color_index,
     b = color->blue;
   }
   else {
-    // Get actual displayed color from pen
-    ULONG rgb_values[3];
-    ULONG *rgb;
-    GetRGB32(csw->screen->ViewPort.ColorMap, color->assigned_pen, 1, rgb_values);
-    rgb = rgb_values;
-    r = (rgb[0] >> 24) & 0xFF;
-    g = (rgb[1] >> 24) & 0xFF;
-    b = (rgb[2] >> 24) & 0xFF;
+    // Get actual displayed color from the palette snapshot
+    if (!csw->palette_valid) {
+      snapshot_palette(csw);
+    }
+    r = csw->palette[color->assigned_pen][0];
+    g = csw->palette[color->assigned_pen][1];
+    b = csw->palette[color->assigned_pen][2];
   }
 
-  switch (csw->display_format) {
+  switch (format) {
     case DISPLAY_RGB:
       sprintf(buffer, "RGB(%d,%d,%d)", r, g, b);
       break;
@@ -599,128 +938,510 @@ static void format_color_value(ColorSwatchWindow *csw, int color_index,
 }
 
 /**
- * @brief Draws the color swatches in two rows of 8
+ * @brief Formats and measures all text of the color table once
+ * Called after pens are assigned; redraws then only copy from the cache.
+ * It has to be built again whenever the colors, pens or font change.
  * @param csw Pointer to ColorSwatchWindow structure
  */
-static void draw_color_swatches(ColorSwatchWindow *csw)
+static void build_text_layout(ColorSwatchWindow *csw)
 {
-  struct RastPort *rp = csw->rastport;
-  WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
-  WORD start_x = adj_border_width + 16;
-  WORD start_y = BORDER_HEIGHT + 16;
-  WORD swatch_x, swatch_y;
-  int i, row, col;
-
-  for (i = 0; i < 16; i++) {
-    row = i / 8;  // 0 for colors 0-7, 1 for colors 8-15
-    col = i % 8;  // 0-7 for position in row
-    
-    swatch_x = start_x + col * (SWATCH_SIZE + SWATCH_SPACING);
-    swatch_y = start_y + row * (SWATCH_SIZE + SWATCH_SPACING);
-    
-    // Store swatch coordinates for hit testing
-    csw->swatches[i].x = swatch_x;
-    csw->swatches[i].y = swatch_y;
-    csw->swatches[i].width = SWATCH_SIZE;
-    csw->swatches[i].height = SWATCH_SIZE;
-    csw->swatches[i].color_index = i;
-    
-    // Draw color swatch
-    SetAPen(rp, csw->colors[i].assigned_pen);
-    RectFill(rp, swatch_x, swatch_y, 
-             swatch_x + SWATCH_SIZE - 1, swatch_y + SWATCH_SIZE - 1);
-    
-    // Draw swatch border (highlight if selected)
-    if (i == csw->selected_color) {
-      SetAPen(rp, 3); // Bright pen for selection
-      
-      // Draw thick selection border
-      Move(rp, swatch_x - 2, swatch_y - 2);
-      Draw(rp, swatch_x + SWATCH_SIZE + 1, swatch_y - 2);
-      Draw(rp, swatch_x + SWATCH_SIZE + 1, swatch_y + SWATCH_SIZE + 1);
-      Draw(rp, swatch_x - 2, swatch_y + SWATCH_SIZE + 1);
-      Draw(rp, swatch_x - 2, swatch_y - 2);
-      
-      Move(rp, swatch_x - 1, swatch_y - 1);
-      Draw(rp, swatch_x + SWATCH_SIZE, swatch_y - 1);
-      Draw(rp, swatch_x + SWATCH_SIZE, swatch_y + SWATCH_SIZE);
-      Draw(rp, swatch_x - 1, swatch_y + SWATCH_SIZE);
-      Draw(rp, swatch_x - 1, swatch_y - 1);
-    } else {
-      SetAPen(rp, 2); // Normal border
-      Move(rp, swatch_x - 1, swatch_y - 1);
-      Draw(rp, swatch_x + SWATCH_SIZE, swatch_y - 1);
-      Draw(rp, swatch_x + SWATCH_SIZE, swatch_y + SWATCH_SIZE);
-      Draw(rp, swatch_x - 1, swatch_y + SWATCH_SIZE);
-      Draw(rp, swatch_x - 1, swatch_y - 1);
+  TextLayout *text = &csw->text;
+  struct RastPort rp;
+  int format, i;
+
+  // A private rastport, so the layout can be built before the window opens
+  InitRastPort(&rp);
+  SetFont(&rp, csw->font);
+
+  for (format = 0; format < DISPLAY_FORMATS; format++) {
+    for (i = 0; i < 16; i++) {
+      format_color_value(csw, i, (DisplayFormat)format, text->values[format][i], TRUE);
+      text->value_lengths[format][i] = strlen(text->values[format][i]);
+      text->value_widths[format][i] = TextLength(&rp, text->values[format][i],
+                                                 text->value_lengths[format][i]);
     }
   }
-}
 
-/**
- * @brief Draws the color information table
- * @param csw Pointer to ColorSwatchWindow structure
- */
-static void draw_color_table(ColorSwatchWindow *csw)
-{
-  struct RastPort *rp = csw->rastport;
-  WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
-  WORD table_x = adj_border_width + 16;
-  WORD table_y = BORDER_HEIGHT + 80; // Below the swatches
-  char buffer[64];
-  int i;
-  
-  SetFont(rp, csw->font);
-  SetAPen(rp, 1);
-  
-  // Draw table headers
-  Move(rp, table_x, table_y);
-  Text(rp, "Normal", 6);
-  Move(rp, table_x + 200, table_y);
-  Text(rp, "Bright", 6);
-  
-  // Draw color entries
   for (i = 0; i < 8; i++) {
-    WORD line_y = table_y + 20 + (i * 16);
-    
-    // Highlight selected color
-    if (i == (csw->selected_color % 8)) {
-      SetAPen(rp, 2);
-      RectFill(rp, table_x - 2, line_y - 10, 
-               table_x + 380, line_y + 6);
-    }
-    
-    SetAPen(rp, 1);
-    
-    // Normal color (0-7)
-    sprintf(buffer, " %d     ", i);
-    Move(rp, table_x, line_y);
-    Text(rp, buffer, strlen(buffer));
-    
-    format_color_value(csw, i, buffer, TRUE);
-    Move(rp, table_x + 40, line_y);
-    Text(rp, buffer, strlen(buffer));
-    
-    // Bright color (8-15)
-    sprintf(buffer, " %d", i);
-    Move(rp, table_x + 200, line_y);
-    Text(rp, buffer, strlen(buffer));
-    
-    format_color_value(csw, i + 8, buffer, TRUE);
-    Move(rp, table_x + 240, line_y);
-    Text(rp, buffer, strlen(buffer));
+    sprintf(text->labels[i], " %d", i);
   }
+
+  text->close_width = TextLength(&rp, "Close", 5);
+  text->valid = TRUE;
 }
 
 /**
- * @brief Handles window events and user interaction
+ * @brief Computes the rectangle of every element and the window size
+ * Everything is placed from the font metrics and the pixel aspect ratio,
+ * once before the window opens; drawing and hit tests only read the
+ * result.
  * @param csw Pointer to ColorSwatchWindow structure
- * @return TRUE to continue, FALSE to exit
+ * @param swatch_size Height of a swatch; its width follows the aspect ratio
+ * @param row_padding Space above and below the text of a table row
+ * @param margin Space around the swatches and the table
+ * @return TRUE if the window fits on the screen
  */
-static BOOL handle_events(ColorSwatchWindow *csw)
+static BOOL place_swatch_layout(ColorSwatchWindow *csw, WORD swatch_size,
+                                WORD row_padding, WORD margin)
 {
-  struct IntuiMessage *msg;
-  BOOL continue_loop = TRUE;
+  SwatchLayout *layout = &csw->layout;
+  struct TextFont *font = csw->font;
+  struct RastPort rp;
+  WORD content_width, button_width, button_height, width, x, y;
+  int i;
+
+  InitRastPort(&rp);
+  SetFont(&rp, font);
+
+  layout->border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
+
+  // Swatches are square on the display, not in pixels
+  layout->swatch_width = (swatch_size * csw->aspect_x) / csw->aspect_y;
+  if (layout->swatch_width < 4) layout->swatch_width = 4;
+  layout->swatch_height = swatch_size;
+  layout->pitch_x = layout->swatch_width + SWATCH_SPACING;
+  layout->pitch_y = layout->swatch_height + SWATCH_SPACING;
+
+  // Table columns fit the widest value any color can have
+  layout->row_height = font->tf_YSize + row_padding;
+  layout->text_offset = (layout->row_height - font->tf_YSize) / 2 + font->tf_Baseline;
+  layout->label_width = TextLength(&rp, " 0", 2) + LAYOUT_GAP * 2;
+  layout->value_width = TextLength(&rp, "RGB(255,255,255)", 16);
+  width = TextLength(&rp, "#FFFFFF", 7);
+  if (width > layout->value_width) layout->value_width = width;
+  width = TextLength(&rp, "Pen 255", 7);
+  if (width > layout->value_width) layout->value_width = width;
+  layout->value_width += LAYOUT_GAP * 2;
+  layout->column_width = layout->label_width + layout->value_width;
+
+  // Buttons fit their labels
+  button_width = BUTTON_WIDTH;
+  if (csw->text.close_width + LAYOUT_GAP * 2 > button_width) {
+    button_width = csw->text.close_width + LAYOUT_GAP * 2;
+  }
+  button_height = BUTTON_HEIGHT;
+  if (font->tf_YSize + 6 > button_height) {
+    button_height = font->tf_YSize + 6;
+  }
+
+  content_width = layout->column_width * 2;
+  if (8 * layout->pitch_x > content_width) content_width = 8 * layout->pitch_x;
+  if (button_width * 2 + LAYOUT_GAP > content_width) content_width = button_width * 2 + LAYOUT_GAP;
+
+  x = layout->border_width + margin;
+  y = BORDER_HEIGHT + margin;
+
+  // Two rows of 8 swatches
+  layout->swatch_grid.x = x;
+  layout->swatch_grid.y = y;
+  layout->swatch_grid.width = 8 * layout->pitch_x - SWATCH_SPACING;
+  layout->swatch_grid.height = 2 * layout->pitch_y - SWATCH_SPACING;
+  for (i = 0; i < 16; i++) {
+    csw->swatches[i].x = x + (i % 8) * layout->pitch_x;
+    csw->swatches[i].y = y + (i / 8) * layout->pitch_y;
+    csw->swatches[i].width = layout->swatch_width;
+    csw->swatches[i].height = layout->swatch_height;
+    csw->swatches[i].color_index = i;
+  }
+  y += layout->swatch_grid.height + margin;
+
+  // Table header and rows
+  layout->header_y = y;
+  y += layout->row_height;
+  layout->table.x = x;
+  layout->table.y = y;
+  layout->table.width = content_width;
+  layout->table.height = 8 * layout->row_height;
+  y += layout->table.height + margin;
+
+  // Cycle gadget and Close button in the bottom corners
+  layout->window_width = 2 * x + content_width;
+  layout->window_height = y + button_height + LAYOUT_GAP + BORDER_HEIGHT;
+
+  csw->rgb_button.x = layout->border_width + LAYOUT_GAP;
+  csw->rgb_button.y = y;
+  csw->rgb_button.width = button_width;
+  csw->rgb_button.height = button_height;
+
+  csw->close_button.x = layout->window_width - layout->border_width - LAYOUT_GAP - button_width;
+  csw->close_button.y = y;
+  csw->close_button.width = button_width;
+  csw->close_button.height = button_height;
+
+  return (BOOL)(layout->window_width <= csw->screen->Width &&
+                layout->window_height <= csw->screen->Height);
+}
+
+/**
+ * @brief Lays out the window as roomy as the screen allows
+ * A large font on a small screen would make the window taller than the
+ * screen, and OpenWindowTags cannot shrink it. The table rows and margins
+ * are tightened first, then the swatches are halved, and as a last resort
+ * the screen font replaces the user font.
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void compute_swatch_layout(ColorSwatchWindow *csw)
+{
+  if (place_swatch_layout(csw, SWATCH_SIZE, 8, LAYOUT_MARGIN)) return;
+  if (place_swatch_layout(csw, SWATCH_SIZE, 2, LAYOUT_GAP)) return;
+  if (place_swatch_layout(csw, SWATCH_SIZE / 2, 2, LAYOUT_GAP / 2)) return;
+
+  if (csw->font != csw->screen->RastPort.Font) {
+    CloseFont(csw->font);
+    csw->font = csw->screen->RastPort.Font;
+    build_text_layout(csw);
+    compute_swatch_layout(csw);
+  }
+}
+
+/**
+ * @brief Draws the border of one swatch, thick if it is selected
+ * The outer ring is cleared for unselected swatches so a selection that
+ * moves away leaves nothing behind.
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param index Swatch to draw (0-15)
+ */
+static void draw_swatch_border(ColorSwatchWindow *csw, int index)
+{
+  struct RastPort *rp = csw->rastport;
+  WORD swatch_x = csw->swatches[index].x;
+  WORD swatch_y = csw->swatches[index].y;
+  WORD swatch_x1 = swatch_x + csw->swatches[index].width;
+  WORD swatch_y1 = swatch_y + csw->swatches[index].height;
+
+  mark_dirty(csw, swatch_x - 2, swatch_y - 2, swatch_x1 + 1, swatch_y1 + 1);
+
+  if (index == csw->selected_color) {
+    SetAPen(rp, 3); // Bright pen for selection
+
+    // Draw thick selection border
+    Move(rp, swatch_x - 2, swatch_y - 2);
+    Draw(rp, swatch_x1 + 1, swatch_y - 2);
+    Draw(rp, swatch_x1 + 1, swatch_y1 + 1);
+    Draw(rp, swatch_x - 2, swatch_y1 + 1);
+    Draw(rp, swatch_x - 2, swatch_y - 2);
+  }
+  else {
+    SetAPen(rp, 0); // Clear the outer ring of a former selection
+    Move(rp, swatch_x - 2, swatch_y - 2);
+    Draw(rp, swatch_x1 + 1, swatch_y - 2);
+    Draw(rp, swatch_x1 + 1, swatch_y1 + 1);
+    Draw(rp, swatch_x - 2, swatch_y1 + 1);
+    Draw(rp, swatch_x - 2, swatch_y - 2);
+
+    SetAPen(rp, 2); // Normal border
+  }
+
+  Move(rp, swatch_x - 1, swatch_y - 1);
+  Draw(rp, swatch_x1, swatch_y - 1);
+  Draw(rp, swatch_x1, swatch_y1);
+  Draw(rp, swatch_x - 1, swatch_y1);
+  Draw(rp, swatch_x - 1, swatch_y - 1);
+}
+
+/**
+ * @brief Draws the color swatches in two rows of 8
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void draw_color_swatches(ColorSwatchWindow *csw)
+{
+  struct RastPort *rp = csw->rastport;
+  SwatchRect *swatch;
+  int i;
+
+  for (i = 0; i < 16; i++) {
+    swatch = &csw->swatches[i];
+
+    // Draw color swatch
+    SetAPen(rp, csw->colors[i].assigned_pen);
+    RectFill(rp, swatch->x, swatch->y,
+             swatch->x + swatch->width - 1, swatch->y + swatch->height - 1);
+    
+    draw_swatch_border(csw, i);
+  }
+}
+
+/**
+ * @brief Draws one value column of a color table row
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param color_index Color whose value to draw
+ * @param x Left edge of the column
+ * @param row_y Top of the row
+ * @param background Pen the row is filled with, or -1 if the row was just cleared
+ */
+static void draw_table_value(ColorSwatchWindow *csw, int color_index, WORD x, WORD row_y,
+                             WORD background)
+{
+  struct RastPort *rp = csw->rastport;
+  TextLayout *text = &csw->text;
+  SwatchLayout *layout = &csw->layout;
+  WORD width = text->value_widths[csw->display_format][color_index];
+  WORD bottom = row_y + layout->row_height - 1;
+
+  mark_dirty(csw, x, row_y, x + layout->value_width - 1, bottom);
+
+  // The text fills its own cells; clear what a longer value left behind
+  if (background >= 0 && width < layout->value_width) {
+    SetAPen(rp, background);
+    RectFill(rp, x + width, row_y, x + layout->value_width - 1, bottom);
+  }
+
+  SetAPen(rp, 1);
+  Move(rp, x, row_y + layout->text_offset);
+  Text(rp, text->values[csw->display_format][color_index],
+       text->value_lengths[csw->display_format][color_index]);
+}
+
+/**
+ * @brief Draws one row of the color table
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param row Row to draw (0-7), showing colors row and row + 8
+ * @param values_only TRUE to redraw only the two value columns
+ */
+static void draw_table_row(ColorSwatchWindow *csw, int row, BOOL values_only)
+{
+  struct RastPort *rp = csw->rastport;
+  SwatchLayout *layout = &csw->layout;
+  WORD row_x = layout->table.x;
+  WORD row_y = layout->table.y + row * layout->row_height;
+  UBYTE background = (row == (csw->selected_color % 8)) ? 2 : 0;
+
+  SetFont(rp, csw->font);
+  SetBPen(rp, background);
+
+  if (!values_only) {
+    mark_dirty(csw, row_x, row_y, row_x + layout->table.width - 1,
+               row_y + layout->row_height - 1);
+
+    // Highlight selected color
+    SetAPen(rp, background);
+    RectFill(rp, row_x, row_y, row_x + layout->table.width - 1,
+             row_y + layout->row_height - 1);
+
+    SetAPen(rp, 1);
+
+    // Normal color (0-7)
+    Move(rp, row_x, row_y + layout->text_offset);
+    Text(rp, csw->text.labels[row], 2);
+
+    // Bright color (8-15)
+    Move(rp, row_x + layout->column_width, row_y + layout->text_offset);
+    Text(rp, csw->text.labels[row], 2);
+  }
+
+  draw_table_value(csw, row, row_x + layout->label_width, row_y,
+                   values_only ? background : -1);
+  draw_table_value(csw, row + 8, row_x + layout->column_width + layout->label_width, row_y,
+                   values_only ? background : -1);
+
+  SetBPen(rp, 0);
+}
+
+/**
+ * @brief Draws the color information table
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void draw_color_table(ColorSwatchWindow *csw)
+{
+  struct RastPort *rp = csw->rastport;
+  SwatchLayout *layout = &csw->layout;
+  WORD header_x = layout->table.x;
+  WORD baseline = layout->header_y + layout->text_offset;
+  int i;
+  
+  SetFont(rp, csw->font);
+  SetAPen(rp, 1);
+
+  mark_dirty(csw, header_x, layout->header_y, header_x + layout->table.width - 1,
+             layout->header_y + layout->row_height - 1);
+  
+  // Draw table headers
+  Move(rp, header_x, baseline);
+  Text(rp, "Normal", 6);
+  Move(rp, header_x + layout->column_width, baseline);
+  Text(rp, "Bright", 6);
+  
+  // Draw color entries
+  for (i = 0; i < 8; i++) {
+    draw_table_row(csw, i, FALSE);
+  }
+}
+
+/**
+ * @brief Draws the whole swatch window
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void draw_swatch_window(ColorSwatchWindow *csw)
+{
+  if (!csw->text.valid) {
+    build_text_layout(csw);
+  }
+
+  draw_custom_border(csw);
+  draw_bottom_buttons(csw);
+  draw_color_swatches(csw);
+  draw_color_table(csw);
+}
+
+/**
+ * @brief Copies the part of the back buffer drawn since the last call to the window
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void show_dirty_area(ColorSwatchWindow *csw)
+{
+  if (!csw->back_bitmap || csw->dirty_x1 < csw->dirty_x0) return;
+
+  ClipBlit(&csw->back_rastport, csw->dirty_x0, csw->dirty_y0,
+           csw->window->RPort, csw->dirty_x0, csw->dirty_y0,
+           csw->dirty_x1 - csw->dirty_x0 + 1, csw->dirty_y1 - csw->dirty_y0 + 1, 0xC0);
+
+  csw->dirty_x0 = 0;
+  csw->dirty_x1 = -1;
+}
+
+/**
+ * @brief Marks the swatches and table rows a change of selection affects
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param new_color Color that becomes selected (0-15)
+ */
+static void damage_selection(ColorSwatchWindow *csw, UBYTE new_color)
+{
+  if (new_color == csw->selected_color) return;
+
+  csw->damaged_swatches |= (1 << csw->selected_color) | (1 << new_color);
+  if ((csw->selected_color % 8) != (new_color % 8)) {
+    csw->damaged_rows |= (1 << (csw->selected_color % 8)) | (1 << (new_color % 8));
+  }
+  csw->selected_color = new_color;
+}
+
+/**
+ * @brief Redraws only the parts of the window marked as damaged
+ * Events only mark damage; it is repaired once after the pending
+ * messages are handled, so a burst of clicks costs one redraw.
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void repair_damage(ColorSwatchWindow *csw)
+{
+  int i;
+
+  if (!csw->text.valid) {
+    build_text_layout(csw);
+  }
+
+  if (csw->damage & DAMAGE_BORDER) {
+    draw_custom_border(csw);
+  }
+
+  if ((csw->damage & (DAMAGE_CYCLE | DAMAGE_CLOSE)) == (DAMAGE_CYCLE | DAMAGE_CLOSE)) {
+    draw_bottom_buttons(csw);
+  }
+  else if (csw->damage & DAMAGE_CYCLE) {
+    draw_cycle_gadget(csw);
+  }
+  else if (csw->damage & DAMAGE_CLOSE) {
+    draw_button(csw, &csw->close_button, "Close", csw->text.close_width,
+                csw->close_button_pressed);
+  }
+
+  if (csw->damage & DAMAGE_SWATCHES) {
+    draw_color_swatches(csw);
+  }
+  else {
+    for (i = 0; i < 16; i++) {
+      if (csw->damaged_swatches & (1 << i)) draw_swatch_border(csw, i);
+    }
+  }
+
+  if (csw->damage & DAMAGE_TABLE) {
+    draw_color_table(csw);
+  }
+  else {
+    for (i = 0; i < 8; i++) {
+      if (csw->damaged_rows & (1 << i)) {
+        draw_table_row(csw, i, FALSE);
+      }
+      else if (csw->damaged_values & (1 << i)) {
+        draw_table_row(csw, i, TRUE);
+      }
+    }
+  }
+
+  csw->damage = 0;
+  csw->damaged_swatches = 0;
+  csw->damaged_rows = 0;
+  csw->damaged_values = 0;
+
+  show_dirty_area(csw);
+}
+
+/**
+ * @brief Starts dragging the window if a click lands on its border
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param x X coordinate of the click
+ * @param y Y coordinate of the click
+ */
+static void start_drag(ColorSwatchWindow *csw, WORD x, WORD y)
+{
+  WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
+
+  if (x < adj_border_width || x >= csw->window->Width - adj_border_width ||
+      y < BORDER_HEIGHT || y >= csw->window->Height - BORDER_HEIGHT) {
+    // Start dragging
+    csw->dragging = TRUE;
+    csw->drag_offset_x = x;
+    csw->drag_offset_y = y;
+  }
+}
+
+/**
+ * @brief Notes that the mouse moved while dragging
+ * The window is only moved by move_dragged_window, once all pending
+ * messages are handled, so a queue of mouse moves costs one layer move.
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void drag_window(ColorSwatchWindow *csw)
+{
+  if (!csw->dragging) return;
+
+  csw->drag_pending = TRUE;
+}
+
+/**
+ * @brief Moves the window under the mouse after drag_window noted a move
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void move_dragged_window(ColorSwatchWindow *csw)
+{
+  WORD new_x, new_y;
+
+  if (!csw->drag_pending) return;
+  csw->drag_pending = FALSE;
+
+  // Queued message positions are relative to wherever the window was when
+  // they were sent; the screen position of the mouse is not
+  new_x = csw->screen->MouseX - csw->drag_offset_x;
+  new_y = csw->screen->MouseY - csw->drag_offset_y;
+
+  // Keep window on screen
+  if (new_x < -csw->window->Width + 32) new_x = -csw->window->Width + 32;
+  if (new_y < -csw->window->Height + 16) new_y = -csw->window->Height + 16;
+  if (new_x > csw->screen->Width - 32) new_x = csw->screen->Width - 32;
+  if (new_y > csw->screen->Height - 16) new_y = csw->screen->Height - 16;
+
+  ChangeWindowBox(csw->window, new_x, new_y,
+                 csw->window->Width, csw->window->Height);
+}
+
+/**
+ * @brief Handles window events and user interaction
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @return TRUE to continue, FALSE to exit
+ */
+static BOOL handle_events(ColorSwatchWindow *csw)
+{
+  struct IntuiMessage *msg;
+  BOOL continue_loop = TRUE;
 
   while ((msg = (struct IntuiMessage *)GetMsg(csw->window->UserPort))) {
     switch (msg->Class) {
@@ -732,30 +1453,23 @@ static BOOL handle_events(ColorSwatchWindow *csw)
         if (msg->Code == SELECTDOWN) {
           if (point_in_button(&csw->close_button, msg->MouseX, msg->MouseY)) {
             csw->close_button_pressed = TRUE;
-            draw_bottom_buttons(csw);
+            csw->damage |= DAMAGE_CLOSE;
           }
           else if (point_in_button(&csw->rgb_button, msg->MouseX, msg->MouseY)) {
             csw->rgb_button_pressed = TRUE;
-            draw_bottom_buttons(csw);
           }
           else {
-            // Check for swatch clicks
-            int swatch_idx = point_in_swatch(csw, msg->MouseX, msg->MouseY);
-            if (swatch_idx >= 0) {
-              csw->selected_color = swatch_idx;
-              draw_color_swatches(csw);
-              draw_color_table(csw);
+            // Check for swatch and table row clicks
+            int color_idx = point_in_swatch(csw, msg->MouseX, msg->MouseY);
+            if (color_idx < 0) {
+              color_idx = point_in_table(csw, msg->MouseX, msg->MouseY);
+            }
+            if (color_idx >= 0) {
+              damage_selection(csw, (UBYTE)color_idx);
             }
             else {
               // Check if clicking on border area for dragging
-              WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
-              if (msg->MouseX < adj_border_width || msg->MouseX >= csw->window->Width - adj_border_width ||
-                  msg->MouseY < BORDER_HEIGHT || msg->MouseY >= csw->window->Height - BORDER_HEIGHT) {
-                // Start dragging
-                csw->dragging = TRUE;
-                csw->drag_offset_x = msg->MouseX;
-                csw->drag_offset_y = msg->MouseY;
-              }
+              start_drag(csw, msg->MouseX, msg->MouseY);
             }
           }
         }
@@ -765,7 +1479,7 @@ static BOOL handle_events(ColorSwatchWindow *csw)
             if (point_in_button(&csw->close_button, msg->MouseX, msg->MouseY)) {
               continue_loop = FALSE; // Close window
             }
-            draw_bottom_buttons(csw);
+            csw->damage |= DAMAGE_CLOSE;
           }
           else if (csw->rgb_button_pressed) {
             csw->rgb_button_pressed = FALSE;
@@ -773,12 +1487,13 @@ static BOOL handle_events(ColorSwatchWindow *csw)
               // Cycle through display modes
               csw->cycle_mode = (csw->cycle_mode + 1) % 3;
               csw->display_format = (DisplayFormat)csw->cycle_mode;
-              draw_color_table(csw);
+              csw->damage |= DAMAGE_CYCLE;
+              csw->damaged_values = 0xFF;
             }
-            draw_bottom_buttons(csw);
           }
           else if (csw->dragging) {
-            // Stop dragging
+            // Stop dragging where the mouse was let go
+            move_dragged_window(csw);
             csw->dragging = FALSE;
           }
         }
@@ -786,19 +1501,7 @@ static BOOL handle_events(ColorSwatchWindow *csw)
 
       case IDCMP_MOUSEMOVE:
         // Handle window dragging
-        if (csw->dragging) {
-          WORD new_x = csw->window->LeftEdge + (msg->MouseX - csw->drag_offset_x);
-          WORD new_y = csw->window->TopEdge + (msg->MouseY - csw->drag_offset_y);
-          
-          // Keep window on screen
-          if (new_x < -csw->window->Width + 32) new_x = -csw->window->Width + 32;
-          if (new_y < -csw->window->Height + 16) new_y = -csw->window->Height + 16;
-          if (new_x > csw->screen->Width - 32) new_x = csw->screen->Width - 32;
-          if (new_y > csw->screen->Height - 16) new_y = csw->screen->Height - 16;
-          
-          ChangeWindowBox(csw->window, new_x, new_y, 
-                         csw->window->Width, csw->window->Height);
-        }
+        drag_window(csw);
         break;
 
       case IDCMP_RAWKEY:
@@ -811,45 +1514,46 @@ static BOOL handle_events(ColorSwatchWindow *csw)
         else if (msg->Code == 0x14) { // T key
           csw->cycle_mode = (csw->cycle_mode + 1) % 3;
           csw->display_format = (DisplayFormat)csw->cycle_mode;
-          draw_custom_border(csw);
-          draw_bottom_buttons(csw);
-          draw_color_swatches(csw);
-          draw_color_table(csw);
+          csw->damage |= DAMAGE_CYCLE;
+          csw->damaged_values = 0xFF;
         }
         break;
 
       case IDCMP_REFRESHWINDOW:
         BeginRefresh(csw->window);
-        draw_custom_border(csw);
-        draw_bottom_buttons(csw);
-        draw_color_swatches(csw);
-        draw_color_table(csw);
+        if (csw->back_bitmap) {
+          // The back buffer always holds the whole window
+          ClipBlit(&csw->back_rastport, 0, 0, csw->window->RPort, 0, 0,
+                   csw->window->Width, csw->window->Height, 0xC0);
+        }
+        else {
+          draw_swatch_window(csw);
+        }
         EndRefresh(csw->window, TRUE);
         break;
     }
     ReplyMsg((struct Message *)msg);
   }
 
+  move_dragged_window(csw);
+
+  if (continue_loop) {
+    repair_damage(csw);
+  }
+
   return continue_loop;
 }
 
 /**
- * @brief Initializes the color swatch window
- * @param colors Array of 16 AnsiColor structures (can be NULL for defaults)
+ * @brief Opens the GUI libraries, locks the screen and reads its depth, aspect ratio and font
+ * @param csw Pointer to ColorSwatchWindow structure
  * @param screen_name Name of screen to open on (NULL for default)
- * @return Pointer to ColorSwatchWindow structure or NULL on failure
+ * @return TRUE on success, FALSE if the libraries or the screen could not be opened
  */
-ColorSwatchWindow *init_color_swatch_window(AnsiColor *colors, char *screen_name)
+static BOOL lock_swatch_screen(ColorSwatchWindow *csw, char *screen_name)
 {
-  ColorSwatchWindow *csw = AllocVec(sizeof(ColorSwatchWindow), MEMF_CLEAR);
-  if (!csw) return NULL;
-
-  // Copy colors or use defaults
-  if (colors) {
-    memcpy(csw->colors, colors, sizeof(AnsiColor) * 16);
-  }
-  else {
-    memcpy(csw->colors, default_ansi_colors, sizeof(AnsiColor) * 16);
+  if (!open_gui_libraries()) {
+    return FALSE;
   }
 
   // Open screen (or use Workbench)
@@ -861,22 +1565,14 @@ ColorSwatchWindow *init_color_swatch_window(AnsiColor *colors, char *screen_name
   }
 
   if (!csw->screen) {
-    FreeVec(csw);
-    return NULL;
+    close_gui_libraries();
+    return FALSE;
   }
 
   // Detect screen capabilities
   csw->depth = csw->screen->RastPort.BitMap->Depth;
-  csw->available_pens = 1 << csw->depth;
+  csw->available_pens = (csw->depth >= 8) ? 256 : 1 << csw->depth;
   csw->is_rtg = detect_rtg_screen(csw->screen);
-  csw->display_format = DISPLAY_RGB;
-  csw->close_button_pressed = FALSE;
-  csw->rgb_button_pressed = FALSE;
-  csw->selected_color = 0;
-  csw->cycle_mode = 0;
-  csw->dragging = FALSE;
-  csw->drag_offset_x = 0;
-  csw->drag_offset_y = 0;
 
   // Get pixel aspect ratio for proper border scaling
   get_pixel_aspect_ratio(csw);
@@ -884,100 +1580,719 @@ ColorSwatchWindow *init_color_swatch_window(AnsiColor *colors, char *screen_name
   // Open font
   open_user_font(csw);
 
-  // Assign color pens based on capabilities
-  assign_color_pens(csw);
+  return TRUE;
+}
 
-  // Calculate window dimensions with proper borders
-  {
-    WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
-    WORD window_width = 400 + (adj_border_width * 2);
-    WORD window_height = 300 + (BORDER_HEIGHT * 2);
-
-    // Open borderless draggable window
-    csw->window = OpenWindowTags(NULL,
-      WA_Left, 50,
-      WA_Top, 50,
-      WA_Width, window_width,
-      WA_Height, window_height,
-      WA_Title, NULL,  // No title bar
-      WA_Flags, WFLG_BORDERLESS | WFLG_ACTIVATE | WFLG_RMBTRAP,
-      WA_IDCMP, IDCMP_MOUSEBUTTONS | IDCMP_MOUSEMOVE | IDCMP_RAWKEY | IDCMP_REFRESHWINDOW | IDCMP_ACTIVEWINDOW,
-      WA_PubScreen, csw->screen,
-      WA_MouseQueue, 10,
-      TAG_DONE);
-  }
+/**
+ * @brief Opens the borderless draggable window on the locked screen
+ * @param csw Pointer to ColorSwatchWindow structure
+ * @param width Window width in pixels
+ * @param height Window height in pixels
+ * @return TRUE on success, FALSE if the window could not be opened
+ */
+static BOOL open_swatch_window(ColorSwatchWindow *csw, WORD width, WORD height)
+{
+  // Open borderless draggable window
+  csw->window = OpenWindowTags(NULL,
+    WA_Left, 50,
+    WA_Top, 50,
+    WA_Width, width,
+    WA_Height, height,
+    WA_Title, NULL,  // No title bar
+    WA_Flags, WFLG_BORDERLESS | WFLG_ACTIVATE | WFLG_RMBTRAP,
+    WA_IDCMP, IDCMP_MOUSEBUTTONS | IDCMP_MOUSEMOVE | IDCMP_RAWKEY | IDCMP_REFRESHWINDOW | IDCMP_ACTIVEWINDOW,
+    WA_PubScreen, csw->screen,
+    WA_MouseQueue, 10,
+    TAG_DONE);
 
   if (!csw->window) {
-    UnlockPubScreen(NULL, csw->screen);
-    FreeVec(csw);
-    return NULL;
+    return FALSE;
   }
 
   csw->rastport = csw->window->RPort;
-
-  return csw;
+  return TRUE;
 }
 
 /**
- * @brief Cleans up and closes the color swatch window
+ * @brief Allocates an off-screen copy of the window to compose frames in
+ * The bitmap is a friend of the screen's so blits to the window need no
+ * conversion. Without it everything is drawn straight into the window.
  * @param csw Pointer to ColorSwatchWindow structure
  */
-void cleanup_color_swatch_window(ColorSwatchWindow *csw)
+static void open_back_buffer(ColorSwatchWindow *csw)
 {
-  int i;
-  
-  if (!csw) return;
-
-  // Release allocated pens
-  for (i = 0; i < 16; i++) {
-    if (csw->allocated_pens[i] != 0) {
-      ReleasePen(csw->screen->ViewPort.ColorMap, csw->allocated_pens[i]);
-    }
+  csw->back_bitmap = AllocBitMap(csw->window->Width, csw->window->Height, csw->depth,
+                                 BMF_CLEAR, csw->screen->RastPort.BitMap);
+  if (!csw->back_bitmap) {
+    return;
   }
 
-  if (csw->window) {
-    CloseWindow(csw->window);
-  }
+  InitRastPort(&csw->back_rastport);
+  csw->back_rastport.BitMap = csw->back_bitmap;
+  csw->rastport = &csw->back_rastport;
+  csw->dirty_x0 = 0;
+  csw->dirty_x1 = -1;
+}
+
+/**
+ * @brief Closes the window and font, unlocks the screen, drops the palette snapshot and closes the GUI libraries
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+static void close_swatch_window(ColorSwatchWindow *csw)
+{
+  if (csw->back_bitmap) {
+    WaitBlit();
+    FreeBitMap(csw->back_bitmap);
+    csw->back_bitmap = NULL;
+  }
+
+  if (csw->window) {
+    CloseWindow(csw->window);
+    csw->window = NULL;
+  }
 
   if (csw->font && csw->font != csw->screen->RastPort.Font) {
     CloseFont(csw->font);
   }
+  csw->font = NULL;
 
   if (csw->screen) {
     UnlockPubScreen(NULL, csw->screen);
+    csw->screen = NULL;
   }
 
+  csw->palette_valid = FALSE;
+
+  close_gui_libraries();
+}
+
+/**
+ * @brief Initializes the color swatch window and draws its first frame
+ * @param colors Array of 16 AnsiColor structures (can be NULL for defaults)
+ * @param screen_name Name of screen to open on (NULL for default)
+ * @param metric Distance used to match colors to pens
+ * @return Pointer to ColorSwatchWindow structure or NULL on failure
+ */
+ColorSwatchWindow *init_color_swatch_window(AnsiColor *colors, char *screen_name,
+                                            ColorMetric metric)
+{
+  ColorSwatchWindow *csw = AllocVec(sizeof(ColorSwatchWindow), MEMF_CLEAR);
+  if (!csw) return NULL;
+
+  // Copy colors or use defaults
+  if (colors) {
+    memcpy(csw->colors, colors, sizeof(AnsiColor) * 16);
+  }
+  else {
+    memcpy(csw->colors, default_ansi_colors, sizeof(AnsiColor) * 16);
+  }
+
+  // Lock the screen and open the font
+  if (!lock_swatch_screen(csw, screen_name)) {
+    FreeVec(csw);
+    return NULL;
+  }
+
+  csw->metric = metric;
+  csw->display_format = DISPLAY_RGB;
+  csw->close_button_pressed = FALSE;
+  csw->rgb_button_pressed = FALSE;
+  csw->selected_color = 0;
+  csw->cycle_mode = 0;
+  csw->dragging = FALSE;
+  csw->drag_pending = FALSE;
+  csw->drag_offset_x = 0;
+  csw->drag_offset_y = 0;
+
+  // Assign color pens based on capabilities
+  assign_color_pens(csw);
+  build_text_layout(csw);
+
+  // Size the window to fit the layout
+  compute_swatch_layout(csw);
+  if (!open_swatch_window(csw, csw->layout.window_width, csw->layout.window_height)) {
+    cleanup_color_swatch_window(csw);
+    return NULL;
+  }
+
+  open_back_buffer(csw);
+
+  // Initial draw
+  draw_swatch_window(csw);
+  show_dirty_area(csw);
+
+  return csw;
+}
+
+/**
+ * @brief Cleans up and closes the color swatch window
+ * @param csw Pointer to ColorSwatchWindow structure
+ */
+void cleanup_color_swatch_window(ColorSwatchWindow *csw)
+{
+  int i;
+  
+  if (!csw) return;
+
+  // Release allocated pens
+  for (i = 0; i < 16; i++) {
+    if (csw->allocated_pens[i] != 0) {
+      ReleasePen(csw->screen->ViewPort.ColorMap, csw->allocated_pens[i]);
+    }
+  }
+
+  close_swatch_window(csw);
   FreeVec(csw);
 }
 
+/**
+ * @brief Runs an initialized color swatch window until it is closed, then cleans it up
+ * @param csw Pointer to ColorSwatchWindow structure from init_color_swatch_window
+ */
+void run_color_swatch_window(ColorSwatchWindow *csw)
+{
+  printf("Color Swatch Window opened.\n");
+  printf("Shortcuts: T=Toggle format, RAmiga+C=Close, LAmiga+V=Close\n");
+  printf("Depth: %d bit planes (%d colors), RTG: %s\n",
+         csw->depth, csw->available_pens, csw->is_rtg ? "Yes" : "No");
+
+  // Event loop
+  while (handle_events(csw)) {
+    WaitPort(csw->window->UserPort);
+  }
+
+  cleanup_color_swatch_window(csw);
+}
+
 /**
  * @brief Main function to display the color swatch window
  * @param colors Array of 16 AnsiColor structures
  * @param screen_name Screen to open on (NULL for Workbench)
+ * @param metric Distance used to match colors to pens
  */
-void show_color_swatch_window(AnsiColor *colors, char *screen_name)
+void show_color_swatch_window(AnsiColor *colors, char *screen_name, ColorMetric metric)
 {
-  ColorSwatchWindow *csw = init_color_swatch_window(colors, screen_name);
+  ColorSwatchWindow *csw = init_color_swatch_window(colors, screen_name, metric);
   if (!csw) {
     printf("Failed to initialize color swatch window\n");
     return;
   }
 
-  printf("Color Swatch Window opened.\n");
-  printf("Shortcuts: T=Toggle format, RAmiga+C=Close, LAmiga+V=Close\n");
-  printf("Depth: %d bit planes (%d colors), RTG: %s\n",
-         csw->depth, csw->available_pens, csw->is_rtg ? "Yes" : "No");
+  run_color_swatch_window(csw);
+}
+
+/**
+ * @brief Builds the key a color is shared under
+ * @param color Pointer to AnsiColor structure
+ * @return 0x00RRGGBB, with bit 24 set for colors that want a loaded pen
+ */
+static ULONG shared_pen_key(AnsiColor *color)
+{
+  return ((ULONG)color->red << 16) | ((ULONG)color->green << 8) | color->blue |
+         (color->load_flag ? 0x01000000 : 0);
+}
+
+/**
+ * @brief Finds the shared pen that holds a color
+ * @param gallery Pointer to ThemeGallery structure
+ * @param key Key from shared_pen_key
+ * @return Index into the pen table or -1 if the color has no pen yet
+ */
+static int find_shared_pen(ThemeGallery *gallery, ULONG key)
+{
+  int i;
+  for (i = 0; i < gallery->pen_count; i++) {
+    if (gallery->pens[i].rgb == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Gets a pen for a color, sharing it with all visible swatches of that color
+ * @param gallery Pointer to ThemeGallery structure
+ * @param color Pointer to AnsiColor structure
+ * @return Pen number to draw the color with
+ */
+static UBYTE acquire_shared_pen(ThemeGallery *gallery, AnsiColor *color)
+{
+  ColorSwatchWindow *csw = &gallery->view;
+  ULONG key = shared_pen_key(color);
+  SharedPen *shared;
+  LONG pen = -1;
+  int i;
+
+  i = find_shared_pen(gallery, key);
+  if (i >= 0) {
+    gallery->pens[i].users++;
+    return gallery->pens[i].pen;
+  }
+
+  // Only deep screens have pens to spare, as in assign_color_pens
+  if (color->load_flag && csw->depth >= 5) {
+    pen = ObtainBestPenA(csw->screen->ViewPort.ColorMap,
+      (color->red << 24) | 0x00FFFFFF,
+      (color->green << 24) | 0x00FFFFFF,
+      (color->blue << 24) | 0x00FFFFFF,
+      NULL);
+  }
+
+  // The table has room for every swatch of the visible rows
+  shared = &gallery->pens[gallery->pen_count++];
+  shared->rgb = key;
+  shared->users = 1;
+  shared->obtained = (BOOL)(pen != -1);
+  if (pen != -1) {
+    shared->pen = (UBYTE)pen;
+    note_pen_changed(csw, shared->pen);
+  }
+  else {
+    shared->pen = find_closest_pen(csw, color->red, color->green, color->blue);
+  }
+
+  return shared->pen;
+}
+
+/**
+ * @brief Drops one use of a shared pen, releasing it when no swatch is left
+ * @param gallery Pointer to ThemeGallery structure
+ * @param color Pointer to AnsiColor structure
+ */
+static void release_shared_pen(ThemeGallery *gallery, AnsiColor *color)
+{
+  int i = find_shared_pen(gallery, shared_pen_key(color));
+
+  if (i < 0 || --gallery->pens[i].users > 0) return;
+
+  if (gallery->pens[i].obtained) {
+    ReleasePen(gallery->view.screen->ViewPort.ColorMap, gallery->pens[i].pen);
+  }
+
+  // Keep the table packed
+  gallery->pens[i] = gallery->pens[--gallery->pen_count];
+}
+
+/**
+ * @brief Assigns pens to the 16 colors of a theme that scrolls into view
+ * @param gallery Pointer to ThemeGallery structure
+ * @param theme Pointer to GalleryTheme structure
+ */
+static void acquire_row_pens(ThemeGallery *gallery, GalleryTheme *theme)
+{
+  int i;
+
+  if (theme->has_pens) return;
+
+  for (i = 0; i < 16; i++) {
+    if (gallery->view.depth <= 2) {
+      // 2 and 4 color screens repeat their pens, as in assign_color_pens
+      theme->colors[i].assigned_pen = i % gallery->view.available_pens;
+    }
+    else {
+      theme->colors[i].assigned_pen = acquire_shared_pen(gallery, &theme->colors[i]);
+    }
+  }
+  theme->has_pens = TRUE;
+}
+
+/**
+ * @brief Gives back the pens of a theme that scrolls out of view
+ * @param gallery Pointer to ThemeGallery structure
+ * @param theme Pointer to GalleryTheme structure
+ */
+static void release_row_pens(ThemeGallery *gallery, GalleryTheme *theme)
+{
+  int i;
+
+  if (!theme->has_pens) return;
+
+  if (gallery->view.depth > 2) {
+    for (i = 0; i < 16; i++) {
+      release_shared_pen(gallery, &theme->colors[i]);
+    }
+  }
+  theme->has_pens = FALSE;
+}
+
+/**
+ * @brief Draws one visible row of the gallery
+ * @param gallery Pointer to ThemeGallery structure
+ * @param slot Visible row to draw (0 is the top row)
+ */
+static void draw_gallery_row(ThemeGallery *gallery, UWORD slot)
+{
+  struct RastPort *rp = gallery->view.rastport;
+  struct TextFont *font = gallery->view.font;
+  ULONG theme_index = gallery->top_row + slot;
+  WORD row_y = gallery->rows_y + slot * gallery->row_height;
+  WORD row_width = GALLERY_NAME_WIDTH + 16 * (GALLERY_SWATCH_SIZE + SWATCH_SPACING);
+  WORD swatch_x, swatch_y;
+  GalleryTheme *theme;
+  struct TextExtent extent;
+  ULONG fit;
+  int i;
+
+  // Clear the row
+  SetAPen(rp, 0);
+  RectFill(rp, gallery->rows_x, row_y,
+           gallery->rows_x + row_width - 1, row_y + gallery->row_height - 1);
+
+  if (theme_index >= gallery->theme_count) return;
+  theme = &gallery->themes[theme_index];
+
+  // Theme name, cut to the name column
+  SetAPen(rp, 1);
+  SetFont(rp, font);
+  fit = TextFit(rp, theme->name, strlen(theme->name), &extent, NULL, 1,
+                GALLERY_NAME_WIDTH - 8, font->tf_YSize + 1);
+  Move(rp, gallery->rows_x, row_y + (gallery->row_height + font->tf_YSize) / 2 - 2);
+  Text(rp, theme->name, fit);
+
+  // Swatches
+  swatch_x = gallery->rows_x + GALLERY_NAME_WIDTH;
+  swatch_y = row_y + (gallery->row_height - GALLERY_SWATCH_SIZE) / 2;
+
+  for (i = 0; i < 16; i++) {
+    SetAPen(rp, theme->colors[i].assigned_pen);
+    RectFill(rp, swatch_x, swatch_y,
+             swatch_x + GALLERY_SWATCH_SIZE - 1, swatch_y + GALLERY_SWATCH_SIZE - 1);
+
+    SetAPen(rp, 2); // Normal border
+    Move(rp, swatch_x - 1, swatch_y - 1);
+    Draw(rp, swatch_x + GALLERY_SWATCH_SIZE, swatch_y - 1);
+    Draw(rp, swatch_x + GALLERY_SWATCH_SIZE, swatch_y + GALLERY_SWATCH_SIZE);
+    Draw(rp, swatch_x - 1, swatch_y + GALLERY_SWATCH_SIZE);
+    Draw(rp, swatch_x - 1, swatch_y - 1);
+
+    swatch_x += GALLERY_SWATCH_SIZE + SWATCH_SPACING;
+  }
+}
+
+/**
+ * @brief Draws the scroll position and the Close button
+ * @param gallery Pointer to ThemeGallery structure
+ */
+static void draw_gallery_buttons(ThemeGallery *gallery)
+{
+  ColorSwatchWindow *csw = &gallery->view;
+  struct RastPort *rp = csw->rastport;
+  WORD adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
+  WORD button_y = csw->window->Height - BORDER_HEIGHT - BUTTON_HEIGHT - 8;
+  ULONG last_row = gallery->top_row + gallery->visible_rows;
+  char buffer[64];
+
+  // Position close button
+  csw->close_button.x = csw->window->Width - adj_border_width - BUTTON_WIDTH - 8;
+  csw->close_button.y = button_y;
+  csw->close_button.width = BUTTON_WIDTH;
+  csw->close_button.height = BUTTON_HEIGHT;
+
+  // Scroll position where the single view has its cycle gadget
+  SetAPen(rp, 0);
+  RectFill(rp, adj_border_width + 8, button_y,
+           csw->close_button.x - 9, button_y + BUTTON_HEIGHT - 1);
+
+  if (last_row > gallery->theme_count) last_row = gallery->theme_count;
+  sprintf(buffer, "Themes %lu-%lu of %lu", gallery->top_row + 1, last_row,
+          gallery->theme_count);
+
+  SetAPen(rp, 1);
+  SetFont(rp, csw->font);
+  Move(rp, adj_border_width + 8, button_y + (BUTTON_HEIGHT + csw->font->tf_YSize) / 2 - 2);
+  Text(rp, buffer, strlen(buffer));
+
+  draw_button(csw, &csw->close_button, "Close", csw->text.close_width,
+              csw->close_button_pressed);
+}
+
+/**
+ * @brief Draws the whole gallery window
+ * @param gallery Pointer to ThemeGallery structure
+ */
+static void draw_gallery(ThemeGallery *gallery)
+{
+  UWORD slot;
+
+  draw_custom_border(&gallery->view);
+  for (slot = 0; slot < gallery->visible_rows; slot++) {
+    draw_gallery_row(gallery, slot);
+  }
+  draw_gallery_buttons(gallery);
+}
+
+/**
+ * @brief Scrolls the gallery, drawing only the rows that come into view
+ * Rows that leave give their pens back before the new rows take theirs,
+ * and the rows that stay are moved with ScrollRaster instead of redrawn.
+ * @param gallery Pointer to ThemeGallery structure
+ * @param delta Number of rows to scroll (negative scrolls up)
+ */
+static void scroll_gallery(ThemeGallery *gallery, LONG delta)
+{
+  struct RastPort *rp = gallery->view.rastport;
+  WORD row_width = GALLERY_NAME_WIDTH + 16 * (GALLERY_SWATCH_SIZE + SWATCH_SPACING);
+  LONG max_top = (LONG)gallery->theme_count - gallery->visible_rows;
+  LONG new_top = (LONG)gallery->top_row + delta;
+  LONG first, last, row;
+
+  if (max_top < 0) max_top = 0;
+  if (new_top > max_top) new_top = max_top;
+  if (new_top < 0) new_top = 0;
+
+  delta = new_top - (LONG)gallery->top_row;
+  if (delta == 0) return;
+
+  // Release the rows that leave the view
+  for (row = gallery->top_row; row < (LONG)(gallery->top_row + gallery->visible_rows); row++) {
+    if (row < new_top || row >= new_top + gallery->visible_rows) {
+      release_row_pens(gallery, &gallery->themes[row]);
+    }
+  }
+
+  gallery->top_row = new_top;
+
+  // Move the rows that stay, then only the new rows need drawing
+  if (delta > -(LONG)gallery->visible_rows && delta < (LONG)gallery->visible_rows) {
+    SetBPen(rp, 0);
+    ScrollRaster(rp, 0, delta * gallery->row_height,
+                 gallery->rows_x, gallery->rows_y,
+                 gallery->rows_x + row_width - 1,
+                 gallery->rows_y + gallery->visible_rows * gallery->row_height - 1);
+
+    first = (delta > 0) ? gallery->visible_rows - delta : 0;
+    last = (delta > 0) ? gallery->visible_rows : -delta;
+  }
+  else {
+    first = 0;
+    last = gallery->visible_rows;
+  }
+
+  for (row = first; row < last; row++) {
+    acquire_row_pens(gallery, &gallery->themes[gallery->top_row + row]);
+    draw_gallery_row(gallery, (UWORD)row);
+  }
+
+  draw_gallery_buttons(gallery);
+}
+
+/**
+ * @brief Handles gallery window events and user interaction
+ * @param gallery Pointer to ThemeGallery structure
+ * @return TRUE to continue, FALSE to exit
+ */
+static BOOL handle_gallery_events(ThemeGallery *gallery)
+{
+  ColorSwatchWindow *csw = &gallery->view;
+  struct IntuiMessage *msg;
+  BOOL continue_loop = TRUE;
+  LONG page;
+
+  while ((msg = (struct IntuiMessage *)GetMsg(csw->window->UserPort))) {
+    switch (msg->Class) {
+      case IDCMP_CLOSEWINDOW:
+        continue_loop = FALSE;
+        break;
+
+      case IDCMP_MOUSEBUTTONS:
+        if (msg->Code == SELECTDOWN) {
+          if (point_in_button(&csw->close_button, msg->MouseX, msg->MouseY)) {
+            csw->close_button_pressed = TRUE;
+            draw_gallery_buttons(gallery);
+          }
+          else {
+            // Check if clicking on border area for dragging
+            start_drag(csw, msg->MouseX, msg->MouseY);
+          }
+        }
+        else if (msg->Code == SELECTUP) {
+          if (csw->close_button_pressed) {
+            csw->close_button_pressed = FALSE;
+            if (point_in_button(&csw->close_button, msg->MouseX, msg->MouseY)) {
+              continue_loop = FALSE; // Close window
+            }
+            draw_gallery_buttons(gallery);
+          }
+          else if (csw->dragging) {
+            // Stop dragging where the mouse was let go
+            move_dragged_window(csw);
+            csw->dragging = FALSE;
+          }
+        }
+        break;
+
+      case IDCMP_MOUSEMOVE:
+        // Handle window dragging
+        drag_window(csw);
+        break;
+
+      case IDCMP_RAWKEY:
+        // Shift scrolls a page at a time
+        page = (msg->Qualifier & (IEQUALIFIER_LSHIFT | IEQUALIFIER_RSHIFT)) ?
+               gallery->visible_rows : 1;
+
+        // Check for keyboard shortcuts
+        if (is_affirmation_shortcut(msg->Code, msg->Qualifier) ||
+            is_close_shortcut(msg->Code, msg->Qualifier)) {
+          continue_loop = FALSE;
+        }
+        else if (msg->Code == KEY_CURSOR_UP || msg->Code == KEY_WHEEL_UP) {
+          scroll_gallery(gallery, -page);
+        }
+        else if (msg->Code == KEY_CURSOR_DOWN || msg->Code == KEY_WHEEL_DOWN) {
+          scroll_gallery(gallery, page);
+        }
+        break;
+
+      case IDCMP_REFRESHWINDOW:
+        BeginRefresh(csw->window);
+        draw_gallery(gallery);
+        EndRefresh(csw->window, TRUE);
+        break;
+    }
+    ReplyMsg((struct Message *)msg);
+  }
+
+  move_dragged_window(csw);
+
+  return continue_loop;
+}
+
+/**
+ * @brief Initializes the theme gallery window and draws its first frame
+ * The themes are used in place; their assigned pens are filled in as
+ * rows come into view.
+ * @param themes Array of themes to show, one per row
+ * @param theme_count Number of themes
+ * @param screen_name Name of screen to open on (NULL for default)
+ * @param metric Distance used to match colors to pens
+ * @return Pointer to ThemeGallery structure or NULL on failure
+ */
+ThemeGallery *init_theme_gallery(GalleryTheme *themes, ULONG theme_count, char *screen_name,
+                                 ColorMetric metric)
+{
+  ThemeGallery *gallery;
+  ColorSwatchWindow *csw;
+  WORD adj_border_width;
+  WORD window_width, window_height;
+  ULONG i;
+
+  if (!themes || theme_count == 0) return NULL;
+
+  gallery = AllocVec(sizeof(ThemeGallery), MEMF_CLEAR);
+  if (!gallery) return NULL;
+
+  csw = &gallery->view;
+  csw->metric = metric;
+  gallery->themes = themes;
+  gallery->theme_count = theme_count;
+  for (i = 0; i < theme_count; i++) {
+    themes[i].has_pens = FALSE;
+  }
+
+  // Lock the screen and open the font
+  if (!lock_swatch_screen(csw, screen_name)) {
+    FreeVec(gallery);
+    return NULL;
+  }
+
+  // Measures the Close label
+  build_text_layout(csw);
+
+  // Rows are tall enough for a swatch and a line of text
+  gallery->row_height = GALLERY_SWATCH_SIZE;
+  if (csw->font->tf_YSize > gallery->row_height) {
+    gallery->row_height = csw->font->tf_YSize;
+  }
+  gallery->row_height += 4;
+
+  adj_border_width = (BORDER_WIDTH * csw->aspect_x) / csw->aspect_y;
+  gallery->rows_x = adj_border_width + 16;
+  gallery->rows_y = BORDER_HEIGHT + 12;
+  gallery->visible_rows = (theme_count < GALLERY_VISIBLE_ROWS) ?
+                          (UWORD)theme_count : GALLERY_VISIBLE_ROWS;
+
+  window_width = GALLERY_NAME_WIDTH + 16 * (GALLERY_SWATCH_SIZE + SWATCH_SPACING) +
+                 32 + (adj_border_width * 2);
+
+  // Drop rows until the window fits on the screen
+  for (;;) {
+    window_height = gallery->rows_y + gallery->visible_rows * gallery->row_height +
+                    8 + BUTTON_HEIGHT + 8 + BORDER_HEIGHT;
+    if (window_height <= csw->screen->Height || gallery->visible_rows == 1) break;
+    gallery->visible_rows--;
+  }
+
+  if (!open_swatch_window(csw, window_width, window_height)) {
+    cleanup_theme_gallery(gallery);
+    return NULL;
+  }
+
+  // Pens for the first page only; later rows get theirs when scrolled to
+  for (i = 0; i < gallery->visible_rows; i++) {
+    acquire_row_pens(gallery, &themes[i]);
+  }
 
   // Initial draw
-  draw_custom_border(csw);
-  draw_bottom_buttons(csw);
-  draw_color_swatches(csw);
-  draw_color_table(csw);
+  draw_gallery(gallery);
+
+  return gallery;
+}
+
+/**
+ * @brief Cleans up and closes the theme gallery window
+ * @param gallery Pointer to ThemeGallery structure
+ */
+void cleanup_theme_gallery(ThemeGallery *gallery)
+{
+  ULONG i;
+
+  if (!gallery) return;
+
+  // Release the pens of the visible rows
+  for (i = 0; i < gallery->theme_count; i++) {
+    release_row_pens(gallery, &gallery->themes[i]);
+  }
+
+  close_swatch_window(&gallery->view);
+  FreeVec(gallery);
+}
+
+/**
+ * @brief Runs an initialized theme gallery until it is closed, then cleans it up
+ * @param gallery Pointer to ThemeGallery structure from init_theme_gallery
+ */
+void run_theme_gallery(ThemeGallery *gallery)
+{
+  printf("Theme gallery opened with %lu themes.\n", gallery->theme_count);
+  printf("Shortcuts: Cursor/Wheel=Scroll, Shift=Page, RAmiga+C=Close, LAmiga+V=Close\n");
+  printf("Depth: %d bit planes (%d colors), RTG: %s, %d shared pens for %d rows\n",
+         gallery->view.depth, gallery->view.available_pens,
+         gallery->view.is_rtg ? "Yes" : "No", gallery->pen_count, gallery->visible_rows);
 
   // Event loop
-  while (handle_events(csw)) {
-    WaitPort(csw->window->UserPort);
+  while (handle_gallery_events(gallery)) {
+    WaitPort(gallery->view.window->UserPort);
   }
 
-  cleanup_color_swatch_window(csw);
+  cleanup_theme_gallery(gallery);
+}
+
+/**
+ * @brief Main function to display several themes as scrollable rows
+ * @param themes Array of themes to show, one per row
+ * @param theme_count Number of themes
+ * @param screen_name Screen to open on (NULL for Workbench)
+ * @param metric Distance used to match colors to pens
+ */
+void show_theme_gallery(GalleryTheme *themes, ULONG theme_count, char *screen_name,
+                        ColorMetric metric)
+{
+  ThemeGallery *gallery = init_theme_gallery(themes, theme_count, screen_name, metric);
+  if (!gallery) {
+    printf("Failed to initialize theme gallery\n");
+    return;
+  }
+
+  run_theme_gallery(gallery);
 }
@@ -25,7 +25,16 @@ typedef enum {
 } DisplayFormat;
 
 /**
- * @brief Rectangle structure for button hit testing
+ * @brief Color distance used to match colors to screen pens
+ */
+typedef enum {
+  METRIC_RGB = 0,                 ///< Squared RGB distance
+  METRIC_REDMEAN,                 ///< Redmean-weighted RGB distance
+  METRIC_LAB                      ///< CIE76 distance in L*a*b*
+} ColorMetric;
+
+/**
+ * @brief Rectangle structure for button and layout hit testing
  */
 typedef struct {
   WORD x, y, width, height;
@@ -39,17 +48,54 @@ typedef struct {
   UBYTE color_index;
 } SwatchRect;
 
+#define DISPLAY_FORMATS 3         ///< Number of DisplayFormat modes
+#define VALUE_TEXT_SIZE 20        ///< Longest formatted color value plus terminator
+
+/**
+ * @brief Strings of the color table and their pixel widths in the window font
+ */
+typedef struct {
+  char values[DISPLAY_FORMATS][16][VALUE_TEXT_SIZE]; ///< Value of each color in each format
+  UBYTE value_lengths[DISPLAY_FORMATS][16];  ///< Characters in each value
+  WORD value_widths[DISPLAY_FORMATS][16];    ///< Pixel width of each value
+  char labels[8][4];                         ///< Row labels " 0" to " 7"
+  WORD close_width;                          ///< Pixel width of the Close button label
+  BOOL valid;                                ///< FALSE once the colors, pens or font change
+} TextLayout;
+
+/**
+ * @brief Positions of everything in the swatch window, computed once from the font
+ */
+typedef struct {
+  WORD window_width, window_height; ///< Window size that fits the contents
+  WORD border_width;              ///< Side border width corrected for the pixel aspect ratio
+  WORD swatch_width, swatch_height; ///< Size of one swatch, corrected for the pixel aspect ratio
+  WORD pitch_x, pitch_y;          ///< Distance from one swatch to the next
+  ButtonRect swatch_grid;         ///< The two rows of 8 swatches
+  WORD header_y;                  ///< Top of the table header row
+  ButtonRect table;               ///< The 8 table rows, without the header
+  WORD row_height;                ///< Height of one table row
+  WORD text_offset;               ///< Baseline of row text below the top of the row
+  WORD label_width;               ///< Width of a row label column
+  WORD value_width;               ///< Width of a value column
+  WORD column_width;              ///< Label and value of the normal colors; bright ones follow
+} SwatchLayout;
+
 /**
  * @brief Main structure for the color swatch window
  */
 typedef struct {
   struct Window *window;          ///< Intuition window
   struct Screen *screen;          ///< Screen to open window on
-  struct RastPort *rastport;      ///< Window's rastport
+  struct RastPort *rastport;      ///< Rastport drawn into: the back buffer, or the window's
+  struct BitMap *back_bitmap;     ///< Off-screen copy of the window, NULL to draw directly
+  struct RastPort back_rastport;  ///< Rastport of back_bitmap
+  WORD dirty_x0, dirty_y0;        ///< Top left of the back buffer area not yet shown
+  WORD dirty_x1, dirty_y1;        ///< Bottom right of it; dirty_x1 < dirty_x0 when none
   struct TextFont *font;          ///< User-selected font
   AnsiColor colors[16];           ///< The 16 ANSI colors
   UBYTE depth;                    ///< Screen depth in bit planes
-  UBYTE available_pens;           ///< Number of pens available for assignment
+  UWORD available_pens;           ///< Number of pens available for assignment
   UBYTE allocated_pens[16];       ///< Track which pens we've allocated
   DisplayFormat display_format;   ///< Current display format
   BOOL is_rtg;                    ///< TRUE if RTG screen detected
@@ -63,8 +109,57 @@ typedef struct {
   WORD aspect_x, aspect_y;        ///< Pixel aspect ratio from IControl prefs
   BOOL dragging;                  ///< TRUE if window is being dragged
   WORD drag_offset_x, drag_offset_y; ///< Mouse offset when dragging started
+  BOOL drag_pending;              ///< TRUE if the mouse moved since the window was last moved
+  ColorMetric metric;             ///< Distance used to match colors to pens
+  UBYTE palette[256][3];          ///< Snapshot of the screen's pen colors
+  WORD palette_lab[256][3];       ///< L*a*b* of the snapshot, for METRIC_LAB
+  BOOL palette_valid;             ///< TRUE once palette holds the screen's colors
+  UWORD damage;                   ///< DAMAGE_ flags of parts waiting to be redrawn
+  UWORD damaged_swatches;         ///< Bit mask of swatches whose border needs redrawing
+  UBYTE damaged_rows;             ///< Bit mask of table rows that need redrawing
+  UBYTE damaged_values;           ///< Bit mask of table rows whose value columns need redrawing
+  TextLayout text;                ///< Formatted and measured table text
+  SwatchLayout layout;            ///< Rectangles of all window elements
 } ColorSwatchWindow;
 
+#define GALLERY_NAME_SIZE 32      ///< Longest theme name shown in a gallery row
+#define GALLERY_VISIBLE_ROWS 10   ///< Most gallery rows on screen at once
+#define GALLERY_MAX_PENS (GALLERY_VISIBLE_ROWS * 16) ///< Distinct colors the gallery can hold
+
+/**
+ * @brief One theme shown as a row of the gallery
+ */
+typedef struct {
+  char name[GALLERY_NAME_SIZE];   ///< Theme name shown at the start of the row
+  AnsiColor colors[16];           ///< The theme's 16 ANSI colors and their pens
+  BOOL has_pens;                  ///< TRUE while the row holds references to shared pens
+} GalleryTheme;
+
+/**
+ * @brief A screen pen shared by every visible swatch of the same color
+ */
+typedef struct {
+  ULONG rgb;                      ///< Color held by the pen as 0x00RRGGBB
+  UBYTE pen;                      ///< Pen number on the screen
+  BOOL obtained;                  ///< TRUE if the pen came from ObtainBestPenA
+  UWORD users;                    ///< Number of visible swatches using the pen
+} SharedPen;
+
+/**
+ * @brief Main structure for the theme gallery window
+ */
+typedef struct {
+  ColorSwatchWindow view;         ///< Window, screen and font state shared with the single view
+  GalleryTheme *themes;           ///< Themes shown in the gallery, one per row
+  ULONG theme_count;              ///< Number of themes
+  ULONG top_row;                  ///< Theme shown in the first visible row
+  UWORD visible_rows;             ///< Number of rows that fit in the window
+  WORD row_height;                ///< Height of one row in pixels
+  WORD rows_x, rows_y;            ///< Top left corner of the first row
+  SharedPen pens[GALLERY_MAX_PENS]; ///< Pens in use by the visible rows, one per distinct color
+  UWORD pen_count;                ///< Number of entries in pens
+} ThemeGallery;
+
 /**
  * @brief Default ANSI color definitions (standard 16-color palette)
  */
@@ -91,9 +186,21 @@ static const AnsiColor default_ansi_colors[16] = {
 /* Internal functions - not exposed in header */
 ColorSwatchWindow *init_color_swatch_window(
   AnsiColor *colors,
-  char *screen_name
+  char *screen_name,
+  ColorMetric metric
 );
 void cleanup_color_swatch_window(ColorSwatchWindow *csw);
-void show_color_swatch_window(AnsiColor *colors, char *screen_name);
+void run_color_swatch_window(ColorSwatchWindow *csw);
+void show_color_swatch_window(AnsiColor *colors, char *screen_name, ColorMetric metric);
+ThemeGallery *init_theme_gallery(
+  GalleryTheme *themes,
+  ULONG theme_count,
+  char *screen_name,
+  ColorMetric metric
+);
+void cleanup_theme_gallery(ThemeGallery *gallery);
+void run_theme_gallery(ThemeGallery *gallery);
+void show_theme_gallery(GalleryTheme *themes, ULONG theme_count, char *screen_name,
+                        ColorMetric metric);
 
 #endif
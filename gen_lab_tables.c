@@ -0,0 +1,99 @@
+/**
+ * Generator for lab_tables.h
+ *
+ * Writes the fixed-point tables amiga_color_window.c uses to convert 8-bit
+ * sRGB to CIE L*a*b* without floating point. Build and run it on any host
+ * with a C compiler and a math library, then replace the header:
+ *
+ *   cc -o gen_lab_tables gen_lab_tables.c -lm
+ *   ./gen_lab_tables >lab_tables.h
+ *
+ * All tables are Q15 (32768 = 1.0).
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#define LAB_ONE 32768.0
+#define LAB_F_BITS 12
+
+/* sRGB (D65) to XYZ */
+static const double srgb_to_xyz[3][3] =
+{
+  { 0.4124564, 0.3575761, 0.1804375 },
+  { 0.2126729, 0.7151522, 0.0721750 },
+  { 0.0193339, 0.1191920, 0.9503041 }
+};
+
+/**
+ * Convert an sRGB channel value to linear light
+ *
+ * @param value Channel value 0.0-1.0
+ * @return Linear value 0.0-1.0
+ */
+static double srgb_linear(double value)
+{
+  return (value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+}
+
+/**
+ * The CIE L*a*b* companding function
+ *
+ * @param t Ratio to the white point 0.0-1.0
+ * @return f(t)
+ */
+static double lab_f(double t)
+{
+  const double delta = 6.0 / 29.0;
+
+  if (t > delta * delta * delta) return cbrt(t);
+  return t / (3.0 * delta * delta) + 4.0 / 29.0;
+}
+
+int main(void)
+{
+  double white;
+  int i, j;
+
+  printf("/**\n");
+  printf(" * Fixed-point sRGB to CIE L*a*b* tables\n");
+  printf(" * Generated by gen_lab_tables.c - do not edit. All values are Q15.\n");
+  printf(" */\n\n");
+  printf("#ifndef LAB_TABLES_H\n#define LAB_TABLES_H\n\n");
+  printf("#define LAB_F_BITS %d ///< Index bits of lab_f_table\n\n", LAB_F_BITS);
+
+  printf("/** Linear light of each 8-bit sRGB channel value */\n");
+  printf("static const UWORD srgb_to_linear[256] = {");
+  for (i = 0; i < 256; i++)
+  {
+    printf("%s%5ld%s", (i % 8) ? " " : "\n  ",
+           lround(srgb_linear(i / 255.0) * LAB_ONE), (i < 255) ? "," : "");
+  }
+  printf("\n};\n\n");
+
+  printf("/** Linear sRGB to XYZ, each row divided by the D65 white point */\n");
+  printf("static const UWORD linear_to_xyz[3][3] = {\n");
+  for (i = 0; i < 3; i++)
+  {
+    white = srgb_to_xyz[i][0] + srgb_to_xyz[i][1] + srgb_to_xyz[i][2];
+    printf("  {");
+    for (j = 0; j < 3; j++)
+    {
+      printf(" %5ld%s", lround(srgb_to_xyz[i][j] / white * LAB_ONE), (j < 2) ? "," : "");
+    }
+    printf(" }%s\n", (i < 2) ? "," : "");
+  }
+  printf("};\n\n");
+
+  printf("/** f(t) for t = index / %d */\n", 1 << LAB_F_BITS);
+  printf("static const UWORD lab_f_table[%d] = {", (1 << LAB_F_BITS) + 1);
+  for (i = 0; i <= (1 << LAB_F_BITS); i++)
+  {
+    printf("%s%5ld%s", (i % 8) ? " " : "\n  ",
+           lround(lab_f((double)i / (1 << LAB_F_BITS)) * LAB_ONE),
+           (i < (1 << LAB_F_BITS)) ? "," : "");
+  }
+  printf("\n};\n\n#endif\n");
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * Host benchmark of the pen matching metrics
+ *
+ * Builds amiga_color_window.c against the shims in this directory, checks
+ * the fixed-point L*a*b* conversion against a double-precision reference
+ * over the whole sRGB cube and times one palette scan per metric.
+ *
+ * Build and run from this directory:
+ *   make bench
+ *
+ * The accuracy line gives the largest and mean CIE76 difference between
+ * rgb_to_lab and the reference, and the color of the largest. The timing
+ * lines give nanoseconds per scan_palette call against a random palette
+ * of 256 pens, which is what one find_closest_pen call costs.
+ */
+
+#include "../amiga_color_window.c"
+
+/* Defined by ViNCEd_Theme.c, which is not part of this program */
+struct GfxBase *GfxBase = NULL;
+struct IntuitionBase *IntuitionBase = NULL;
+struct Library *DiskfontBase = NULL;
+struct Library *IFFParseBase = NULL;
+
+#include "host_shim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MIN_BENCH_NS 200000000.0  /* Repeat each metric for at least 0.2 s */
+#define MATCH_COLORS 4096         /* Distinct colors matched per round */
+
+static const char *const metric_names[] = { "RGB", "REDMEAN", "LAB" };
+
+/* sRGB (D65) to XYZ, as in gen_lab_tables.c */
+static const double srgb_to_xyz[3][3] =
+{
+  { 0.4124564, 0.3575761, 0.1804375 },
+  { 0.2126729, 0.7151522, 0.0721750 },
+  { 0.0193339, 0.1191920, 0.9503041 }
+};
+
+/**
+ * Nanoseconds from a monotonic clock
+ */
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double srgb_linear(double value)
+{
+  return (value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+}
+
+static double lab_f(double t)
+{
+  const double delta = 6.0 / 29.0;
+
+  if (t > delta * delta * delta) return cbrt(t);
+  return t / (3.0 * delta * delta) + 4.0 / 29.0;
+}
+
+/**
+ * Reference sRGB to L*a*b* in double precision
+ */
+static void reference_lab(int red, int green, int blue, double *lab)
+{
+  double linear[3], f[3], xyz;
+  int i;
+
+  linear[0] = srgb_linear(red / 255.0);
+  linear[1] = srgb_linear(green / 255.0);
+  linear[2] = srgb_linear(blue / 255.0);
+  for (i = 0; i < 3; i++)
+  {
+    xyz = srgb_to_xyz[i][0] * linear[0] + srgb_to_xyz[i][1] * linear[1] +
+          srgb_to_xyz[i][2] * linear[2];
+    f[i] = lab_f(xyz / (srgb_to_xyz[i][0] + srgb_to_xyz[i][1] + srgb_to_xyz[i][2]));
+  }
+  lab[0] = 116.0 * f[1] - 16.0;
+  lab[1] = 500.0 * (f[0] - f[1]);
+  lab[2] = 200.0 * (f[1] - f[2]);
+}
+
+/**
+ * Compare rgb_to_lab with the reference for every 8-bit sRGB color
+ */
+static void check_lab_accuracy(void)
+{
+  double lab[3], error, worst = 0, total = 0;
+  int red, green, blue, worst_rgb[3] = { 0, 0, 0 };
+  WORD fixed[3];
+
+  for (red = 0; red < 256; red++)
+  {
+    for (green = 0; green < 256; green++)
+    {
+      for (blue = 0; blue < 256; blue++)
+      {
+        rgb_to_lab((UBYTE)red, (UBYTE)green, (UBYTE)blue, fixed);
+        reference_lab(red, green, blue, lab);
+        error = sqrt((fixed[0] / 8.0 - lab[0]) * (fixed[0] / 8.0 - lab[0]) +
+                     (fixed[1] / 8.0 - lab[1]) * (fixed[1] / 8.0 - lab[1]) +
+                     (fixed[2] / 8.0 - lab[2]) * (fixed[2] / 8.0 - lab[2]));
+        total += error;
+        if (error > worst)
+        {
+          worst = error;
+          worst_rgb[0] = red;
+          worst_rgb[1] = green;
+          worst_rgb[2] = blue;
+        }
+      }
+    }
+  }
+
+  printf("lab_accuracy\tmax_dE %.2f at (%d,%d,%d)\tmean_dE %.3f\n", worst,
+         worst_rgb[0], worst_rgb[1], worst_rgb[2], total / (256.0 * 256.0 * 256.0));
+}
+
+/**
+ * Time scan_palette with one metric
+ */
+static void bench_metric(ColorMetric metric)
+{
+  static UBYTE colors[MATCH_COLORS][3];
+  ColorSwatchWindow *csw;
+  volatile ULONG sink = 0;
+  ULONG runs = 0, i;
+  double start, elapsed;
+
+  csw = init_color_swatch_window(NULL, NULL, metric);
+  if (!csw)
+  {
+    fprintf(stderr, "init_color_swatch_window failed\n");
+    exit(1);
+  }
+  snapshot_palette(csw);
+
+  srand(7);
+  for (i = 0; i < MATCH_COLORS; i++)
+  {
+    colors[i][0] = (UBYTE)rand();
+    colors[i][1] = (UBYTE)rand();
+    colors[i][2] = (UBYTE)rand();
+  }
+
+  start = now_ns();
+  do
+  {
+    for (i = 0; i < MATCH_COLORS; i++)
+    {
+      sink += scan_palette(csw, colors[i][0], colors[i][1], colors[i][2]);
+    }
+    runs++;
+    elapsed = now_ns() - start;
+  } while (elapsed < MIN_BENCH_NS);
+
+  printf("scan_palette\t%s\t%lu pens\t%.1f ns_per_match\n", metric_names[metric],
+         (ULONG)csw->available_pens, elapsed / ((double)runs * MATCH_COLORS));
+  cleanup_color_swatch_window(csw);
+}
+
+int main(void)
+{
+  int pen, i;
+
+  host_quiet = TRUE;
+  host_screen_depth = 8;
+  srand(3);
+  for (pen = 0; pen < 256; pen++)
+  {
+    for (i = 0; i < 3; i++) host_palette[pen][i] = (ULONG)(rand() & 0xFF) * 0x01010101UL;
+  }
+
+  check_lab_accuracy();
+  bench_metric(METRIC_RGB);
+  bench_metric(METRIC_REDMEAN);
+  bench_metric(METRIC_LAB);
+  return 0;
+}
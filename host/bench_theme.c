@@ -0,0 +1,514 @@
+/**
+ * Host benchmark of the theme parse and preferences update pipeline
+ *
+ * Builds ViNCEd_Theme.c against the shims in this directory and times
+ * classify_line, parse_color_line, read_theme_file and update_prefs_files
+ * over generated theme and preferences files from a few lines up to
+ * several megabytes.
+ * parse_color_component is timed next to convert_to_16bit_rgb, the
+ * strtoul based converter it replaced, on the same components.
+ *
+ * Build and run from this directory:
+ *   make bench
+ *
+ * Output is one tab separated line per case, after a # header line:
+ *   case lines runs ns_per_line allocs_per_run bytes_written_per_run bytes_per_s
+ * Allocations are alloc_mem calls as counted by get_run_stats; bytes
+ * written are everything the shims passed to Write and FPuts. bytes_per_s
+ * is the input text handled per second. In the component cases a line is
+ * one component.
+ * The Makefile builds this with HOST_MMAP, so theme and prefs files are
+ * mapped and their text costs no allocation.
+ */
+
+#define main vinced_main
+#include "../ViNCEd_Theme.c"
+#undef main
+
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MIN_BENCH_NS 200000000.0  /* Repeat each case for at least 0.2 s */
+#define PARSE_LINES 4096          /* Distinct lines in the parse_color_line case */
+#define COMPONENTS 4096           /* Distinct values in the component cases */
+
+static const ULONG corpus_lines[] = { 17, 1000, 50000, 400000 };
+#define CORPUS_SIZES (sizeof(corpus_lines) / sizeof(corpus_lines[0]))
+
+/* Color line layouts found in real theme files */
+static const char *const line_formats[] =
+{
+  "COLOR=LOAD,ANSI,0x%04x,0x%04x,0x%04x",
+  "COLOR=%u,%u,%u",
+  "COLOR=NOLOAD,NOANSI,0x%02x,0x%02x,0x%02x",
+  "COLOR=#%02X%02X%02X",
+  "COLOR=%u%%,%u%%,%u%%"
+};
+#define LINE_FORMATS (sizeof(line_formats) / sizeof(line_formats[0]))
+
+static char work_dir[] = "/tmp/vincedbenchXXXXXX";
+
+/**
+ * Nanoseconds from a monotonic clock
+ */
+static double now_ns(VOID)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Format one color line in a rotating layout with pseudo-random channels
+ */
+static VOID make_color_line(char *line, ULONG n, BOOL cursor)
+{
+  ULONG r = (n * 97 + 13) & 0xFF;
+  ULONG g = (n * 57 + 101) & 0xFF;
+  ULONG b = (n * 31 + 7) & 0xFF;
+  ULONG format = n % LINE_FORMATS;
+  char color[56];
+
+  if (format == 0)
+  {
+    r *= 0x101;
+    g *= 0x101;
+    b *= 0x101;
+  }
+  else if (format == 4)
+  {
+    r = r * 100 / 255;
+    g = g * 100 / 255;
+    b = b * 100 / 255;
+  }
+  sprintf(color, line_formats[format], (unsigned)r, (unsigned)g, (unsigned)b);
+  sprintf(line, "%s%s", cursor ? "CURSOR" : "", color);
+}
+
+/**
+ * The component converter of ViNCEd_Theme 1.0, for comparison
+ * Copied as it was, except that starts_with is spelled out.
+ */
+static UWORD convert_to_16bit_rgb(const UBYTE *input)
+{
+  UBYTE clean_input[32];
+  UBYTE *ptr;
+  ULONG value;
+
+  if (!input) return 0;
+
+  /* Remove whitespace and copy to work buffer */
+  ptr = clean_input;
+  while (*input && ptr < clean_input + sizeof(clean_input) - 1)
+  {
+    if (!isspace(*input))
+    {
+      *ptr++ = *input;
+    }
+    input++;
+  }
+  *ptr = '\0';
+
+  /* Check for hex prefix */
+  if (clean_input[0] == '0' && toupper(clean_input[1]) == 'X')
+  {
+    value = strtoul((char *)clean_input + 2, NULL, 16);
+
+    /* If it's an 8-bit hex value (0x00-0xFF), expand to 16-bit */
+    if (value <= 0xFF)
+    {
+      return (UWORD)((value << 8) | value);
+    }
+    else
+    {
+      /* Already 16-bit, use as-is */
+      return (UWORD)(value & 0xFFFF);
+    }
+  }
+
+  /* Check if it contains a decimal point (floating point) */
+  if (strchr((char *)clean_input, '.'))
+  {
+    /* Simple integer-only floating point parsing for 0.0-1.0 range */
+    char *dot_pos = strchr((char *)clean_input, '.');
+    ULONG int_part = 0;
+    ULONG frac_part = 0;
+    ULONG divisor = 1;
+    char *frac_start = dot_pos + 1;
+    char *p = frac_start;
+
+    /* Get integer part */
+    if (dot_pos > (char *)clean_input) {
+      int_part = atol((char *)clean_input);
+    }
+
+    /* Get fractional part and divisor */
+    while (*p && (*p >= '0' && *p <= '9')) {
+      frac_part = frac_part * 10 + (*p - '0');
+      divisor *= 10;
+      p++;
+    }
+
+    /* Convert to 16-bit value */
+    if (int_part >= 1) {
+      return 0xFFFF;  /* 1.0 or greater */
+    } else {
+      /* Calculate fractional value * 65535 */
+      value = (frac_part * 65535UL) / divisor;
+      return (UWORD)value;
+    }
+  }
+
+  /* Integer 0-255 */
+  value = atol((char *)clean_input);
+  if (value > 255) value = 255;
+
+  /* Convert 8-bit to 16-bit by duplicating high byte */
+  return (UWORD)((value << 8) | value);
+}
+
+/**
+ * Format one color component in a rotating layout
+ * Percentages are left out, as convert_to_16bit_rgb does not know them.
+ */
+static VOID make_component(char *text, ULONG n)
+{
+  ULONG v = (n * 97 + 13) & 0xFF;
+
+  switch (n % 4)
+  {
+    case 0: sprintf(text, "0x%04lx", v * 0x101); break;
+    case 1: sprintf(text, "%lu", v); break;
+    case 2: sprintf(text, "0x%02lx", v); break;
+    default: sprintf(text, "0.%03lu", v * 999 / 255); break;
+  }
+}
+
+/**
+ * Write a theme file of the given number of lines
+ * Comment lines come first so read_theme_file scans the whole file before
+ * it reaches the color block.
+ */
+static VOID write_theme_corpus(const char *path, ULONG lines, ULONG seed)
+{
+  FILE *file = fopen(path, "w");
+  char line[64];
+  ULONG i;
+
+  for (i = 17; i < lines; i++)
+  {
+    fprintf(file, "; Generated filler line %lu of a theme benchmark corpus\n", i);
+  }
+  make_color_line(line, seed, TRUE);
+  fprintf(file, "%s\n", line);
+  for (i = 0; i < 16; i++)
+  {
+    make_color_line(line, seed + i + 1, FALSE);
+    fprintf(file, "%s\n", line);
+  }
+  fclose(file);
+}
+
+/**
+ * Write a preferences file of the given number of lines
+ * With canonical set the color lines have the width format_color_line
+ * produces, so an update patches them in place; otherwise the whole file
+ * is rebuilt.
+ */
+static VOID write_prefs_corpus(const char *path, ULONG lines, BOOL canonical)
+{
+  FILE *file = fopen(path, "w");
+  ULONG i;
+
+  for (i = 17; i < lines; i++)
+  {
+    fprintf(file, "KEYMAP%lu=0x%08lx\n", i, i * 2654435761UL);
+  }
+  for (i = 0; i < 17; i++)
+  {
+    if (canonical)
+    {
+      fprintf(file, "%sCOLOR=NOLOAD,NOANSI,0x0000,0x0000,0x%04lx\n", i ? "" : "CURSOR", i);
+    }
+    else
+    {
+      fprintf(file, "%sCOLOR=0,0,%lu\n", i ? "" : "CURSOR", i);
+    }
+  }
+  fclose(file);
+}
+
+/**
+ * Size of a file in bytes
+ */
+static ULONG file_size(const char *path)
+{
+  struct stat st;
+
+  return stat(path, &st) == 0 ? (ULONG)st.st_size : 0;
+}
+
+/**
+ * Print one result line
+ *
+ * @param bytes Bytes written over all runs
+ * @param input Bytes of input text handled by one run
+ */
+static VOID report(const char *name, ULONG lines, ULONG runs, double ns,
+                   const RunStats *before, const RunStats *after, ULONG bytes, ULONG input)
+{
+  printf("%s\t%lu\t%lu\t%.1f\t%.1f\t%.0f\t%.0f\n", name, lines, runs,
+         ns / ((double)runs * lines),
+         (double)(after->alloc_count - before->alloc_count) / runs,
+         (double)bytes / runs, (double)input * runs * 1e9 / ns);
+}
+
+/**
+ * classify_line over a preferences corpus in memory
+ * Every line is classified where it lies and the scan moves on to the
+ * next newline, as build_prefs_output does.
+ */
+static VOID bench_classify(ULONG lines)
+{
+  char path[256];
+  RunStats before, after;
+  volatile ULONG sink = 0;
+  ULONG runs = 0, size, offset;
+  const UBYTE *line, *end;
+  UBYTE *text;
+  FILE *file;
+  double start, elapsed;
+
+  sprintf(path, "%s/classify%lu", work_dir, lines);
+  write_prefs_corpus(path, lines, FALSE);
+  size = file_size(path);
+  text = malloc(size + 1);
+  file = fopen(path, "rb");
+  if (!text || !file || fread(text, 1, size, file) != size)
+  {
+    fprintf(stderr, "could not read %s\n", path);
+    exit(1);
+  }
+  fclose(file);
+  text[size] = '\0';
+  end = text + size;
+
+  get_run_stats(&before);
+  start = now_ns();
+  do
+  {
+    for (line = text; line < end; line++)
+    {
+      sink += classify_line(line, &offset);
+      while (line < end && *line != '\n') line++;
+    }
+    runs++;
+    elapsed = now_ns() - start;
+  } while (elapsed < MIN_BENCH_NS);
+  get_run_stats(&after);
+
+  free(text);
+  unlink(path);
+  report("classify_line", lines, runs, elapsed, &before, &after, 0, size);
+}
+
+/**
+ * parse_color_line over lines already in memory
+ */
+static VOID bench_parse(VOID)
+{
+  static char lines[PARSE_LINES][64];
+  RunStats before, after;
+  ColorRecord record;
+  LineKind kind;
+  ULONG runs = 0, input = 0, i;
+  double start, elapsed;
+
+  for (i = 0; i < PARSE_LINES; i++)
+  {
+    make_color_line(lines[i], i, (BOOL)(i % 17 == 0));
+    input += strlen(lines[i]);
+  }
+
+  get_run_stats(&before);
+  start = now_ns();
+  do
+  {
+    for (i = 0; i < PARSE_LINES; i++)
+    {
+      if (!parse_color_line((UBYTE *)lines[i], &kind, &record, NULL, NULL))
+      {
+        fprintf(stderr, "parse_color_line rejected '%s'\n", lines[i]);
+        exit(1);
+      }
+    }
+    runs++;
+    elapsed = now_ns() - start;
+  } while (elapsed < MIN_BENCH_NS);
+  get_run_stats(&after);
+
+  report("parse_color_line", PARSE_LINES, runs, elapsed, &before, &after, 0, input);
+}
+
+/**
+ * parse_color_component and convert_to_16bit_rgb over the same components
+ */
+static VOID bench_component(BOOL old)
+{
+  static char components[COMPONENTS][16];
+  static ULONG lengths[COMPONENTS];
+  RunStats before, after;
+  volatile ULONG sink = 0;
+  ULONG runs = 0, input = 0, error_pos, i;
+  UWORD value;
+  double start, elapsed;
+
+  for (i = 0; i < COMPONENTS; i++)
+  {
+    make_component(components[i], i);
+    lengths[i] = strlen(components[i]);
+    input += lengths[i];
+  }
+
+  get_run_stats(&before);
+  start = now_ns();
+  do
+  {
+    for (i = 0; i < COMPONENTS; i++)
+    {
+      if (old)
+      {
+        value = convert_to_16bit_rgb((UBYTE *)components[i]);
+      }
+      else if (!parse_color_component((UBYTE *)components[i], lengths[i], &value, &error_pos))
+      {
+        fprintf(stderr, "parse_color_component rejected '%s'\n", components[i]);
+        exit(1);
+      }
+      sink += value;
+    }
+    runs++;
+    elapsed = now_ns() - start;
+  } while (elapsed < MIN_BENCH_NS);
+  get_run_stats(&after);
+
+  report(old ? "convert_to_16bit_rgb" : "parse_color_component", COMPONENTS, runs, elapsed,
+         &before, &after, 0, input);
+}
+
+/**
+ * read_theme_file over one theme corpus
+ */
+static VOID bench_read(ULONG lines)
+{
+  char path[256];
+  RunStats before, after;
+  ColorList colors;
+  ULONG runs = 0, input;
+  double start, elapsed;
+
+  sprintf(path, "%s/theme%lu", work_dir, lines);
+  write_theme_corpus(path, lines, lines);
+  input = file_size(path);
+  init_color_list(&colors);
+
+  get_run_stats(&before);
+  start = now_ns();
+  do
+  {
+    if (!read_theme_file((UBYTE *)path, &colors, NULL))
+    {
+      fprintf(stderr, "read_theme_file failed on %s\n", path);
+      exit(1);
+    }
+    runs++;
+    elapsed = now_ns() - start;
+  } while (elapsed < MIN_BENCH_NS);
+  get_run_stats(&after);
+
+  free_color_list(&colors);
+  unlink(path);
+  report("read_theme_file", lines, runs, elapsed, &before, &after, 0, input);
+}
+
+/**
+ * update_prefs_files over one preferences corpus
+ * Two themes are applied in turn so every run has colors to change. Only
+ * the update is timed; the rewrite case recreates its input untimed.
+ */
+static VOID bench_update(ULONG lines, BOOL canonical)
+{
+  char path[256], theme_path[256];
+  const UBYTE *paths[1];
+  RunStats before, after;
+  ColorList themes[2];
+  ULONG runs = 0, bytes = 0, input, i;
+  double elapsed = 0, start;
+
+  sprintf(path, "%s/prefs%lu", work_dir, lines);
+  for (i = 0; i < 2; i++)
+  {
+    sprintf(theme_path, "%s/update%lu", work_dir, i);
+    write_theme_corpus(theme_path, 17, i * 40 + 3);
+    init_color_list(&themes[i]);
+    if (!read_theme_file((UBYTE *)theme_path, &themes[i], NULL)) exit(1);
+    unlink(theme_path);
+  }
+  paths[0] = (UBYTE *)path;
+  write_prefs_corpus(path, lines, canonical);
+  input = file_size(path);
+
+  get_run_stats(&before);
+  do
+  {
+    ULONG written;
+
+    if (!canonical && runs) write_prefs_corpus(path, lines, FALSE);
+    written = host_bytes_written;
+    start = now_ns();
+    if (!update_prefs_files(paths, 1, &themes[runs & 1], 0))
+    {
+      fprintf(stderr, "update_prefs_files failed on %s\n", path);
+      exit(1);
+    }
+    elapsed += now_ns() - start;
+    bytes += host_bytes_written - written;
+    runs++;
+  } while (elapsed < MIN_BENCH_NS);
+  get_run_stats(&after);
+
+  for (i = 0; i < 2; i++) free_color_list(&themes[i]);
+  unlink(path);
+  report(canonical ? "update_prefs_patch" : "update_prefs_rewrite", lines, runs, elapsed,
+         &before, &after, bytes, input);
+}
+
+int main(VOID)
+{
+  ULONG i;
+
+  if (!mkdtemp(work_dir))
+  {
+    perror("mkdtemp");
+    return 1;
+  }
+  host_quiet = TRUE;
+
+  printf("# case\tlines\truns\tns_per_line\tallocs_per_run\tbytes_written_per_run\tbytes_per_s\n");
+  for (i = 0; i < CORPUS_SIZES; i++) bench_classify(corpus_lines[i]);
+  bench_parse();
+  bench_component(TRUE);
+  bench_component(FALSE);
+  for (i = 0; i < CORPUS_SIZES; i++) bench_read(corpus_lines[i]);
+  for (i = 0; i < CORPUS_SIZES; i++) bench_update(corpus_lines[i], TRUE);
+  for (i = 0; i < CORPUS_SIZES; i++) bench_update(corpus_lines[i], FALSE);
+
+  rmdir(work_dir);
+  return 0;
+}
@@ -0,0 +1,650 @@
+/**
+ * exec.library, dos.library and timer.device on top of the C library
+ *
+ * Files are stdio streams, locks carry a path, and the EClock is the host
+ * monotonic clock scaled to the PAL EClock rate. Just enough of each call
+ * is implemented for the sources in the parent directory to run.
+ */
+
+#define _GNU_SOURCE               /* FNM_CASEFOLD */
+
+#include "host_shim.h"
+
+#include <exec/types.h>
+#include <dos/dos.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOST_ECLOCK_RATE 709379   /* PAL EClock ticks per second */
+
+ULONG host_alloc_calls = 0;
+ULONG host_free_calls = 0;
+ULONG host_bytes_written = 0;
+ULONG host_library_opens = 0;
+ULONG host_library_closes = 0;
+ULONG host_files_mapped = 0;
+BOOL host_quiet = FALSE;
+
+struct Library *SysBase = NULL;
+struct Library *DOSBase = NULL;
+
+static LONG io_error = 0;
+static struct Library fake_library;
+
+/* Path a Lock refers to */
+typedef struct HostLock
+{
+  char path[512];
+} HostLock;
+
+/* State of a MatchFirst/MatchNext scan over one directory */
+static DIR *match_dir = NULL;
+static char match_dir_path[512];
+static char match_pattern[256];
+
+/**
+ * Map errno to the nearest dos.library error code
+ */
+static LONG dos_error(int error)
+{
+  switch (error)
+  {
+    case ENOENT: return ERROR_OBJECT_NOT_FOUND;
+    case ENOMEM: return ERROR_NO_FREE_STORE;
+    default: return ERROR_OBJECT_IN_USE;
+  }
+}
+
+/**
+ * Fill a FileInfoBlock from stat data
+ */
+static VOID fill_fib(struct FileInfoBlock *fib, const char *path, const struct stat *st)
+{
+  const char *name = strrchr(path, '/');
+
+  fib->fib_DirEntryType = S_ISDIR(st->st_mode) ? 2 : -3;
+  fib->fib_EntryType = fib->fib_DirEntryType;
+  fib->fib_Size = (LONG)st->st_size;
+  fib->fib_Date.ds_Days = (LONG)(st->st_mtime / 86400);
+  fib->fib_Date.ds_Minute = (LONG)((st->st_mtime % 86400) / 60);
+  fib->fib_Date.ds_Tick = (LONG)((st->st_mtime % 60) * 50);
+  strncpy(fib->fib_FileName, name ? name + 1 : path, sizeof(fib->fib_FileName) - 1);
+  fib->fib_FileName[sizeof(fib->fib_FileName) - 1] = '\0';
+}
+
+/* exec.library */
+
+APTR AllocMem(ULONG size, ULONG flags)
+{
+  host_alloc_calls++;
+  return calloc(1, size ? size : 1);
+}
+
+void FreeMem(APTR mem, ULONG size)
+{
+  host_free_calls++;
+  free(mem);
+}
+
+APTR AllocVec(ULONG size, ULONG flags)
+{
+  host_alloc_calls++;
+  return calloc(1, size ? size : 1);
+}
+
+void FreeVec(APTR mem)
+{
+  if (mem) host_free_calls++;
+  free(mem);
+}
+
+void CopyMem(const void *source, void *dest, ULONG size)
+{
+  memcpy(dest, source, size);
+}
+
+ULONG SetSignal(ULONG new_signals, ULONG mask)
+{
+  return 0;
+}
+
+struct MsgPort *CreateMsgPort(void)
+{
+  return calloc(1, sizeof(struct MsgPort));
+}
+
+void DeleteMsgPort(struct MsgPort *port)
+{
+  free(port);
+}
+
+struct IORequest *CreateIORequest(struct MsgPort *port, ULONG size)
+{
+  return calloc(1, size);
+}
+
+void DeleteIORequest(struct IORequest *request)
+{
+  free(request);
+}
+
+BYTE OpenDevice(CONST_STRPTR name, ULONG unit, struct IORequest *request, ULONG flags)
+{
+  request->io_Device = (struct Device *)&fake_library;
+  return 0;
+}
+
+void CloseDevice(struct IORequest *request)
+{
+}
+
+struct Library *OpenLibrary(CONST_STRPTR name, ULONG version)
+{
+  host_library_opens++;
+  return &fake_library;
+}
+
+void CloseLibrary(struct Library *library)
+{
+  if (library) host_library_closes++;
+}
+
+/* timer.device */
+
+ULONG ReadEClock(struct EClockVal *clock)
+{
+  struct timespec now;
+  unsigned long long ticks;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  ticks = (unsigned long long)now.tv_sec * HOST_ECLOCK_RATE +
+          (unsigned long long)now.tv_nsec * HOST_ECLOCK_RATE / 1000000000ULL;
+  clock->ev_hi = (ULONG)(ticks >> 32);
+  clock->ev_lo = (ULONG)(ticks & 0xFFFFFFFFUL);
+  return HOST_ECLOCK_RATE;
+}
+
+/* dos.library: files */
+
+BPTR Open(CONST_STRPTR name, LONG mode)
+{
+  FILE *file;
+
+  if (mode == MODE_NEWFILE)
+  {
+    file = fopen(name, "w+b");
+  }
+  else
+  {
+    file = fopen(name, "r+b");
+    if (!file && errno != ENOENT) file = fopen(name, "rb");
+    if (!file && mode == MODE_READWRITE) file = fopen(name, "w+b");
+  }
+
+  if (!file)
+  {
+    io_error = dos_error(errno);
+    return 0;
+  }
+  return (BPTR)file;
+}
+
+LONG Close(BPTR file)
+{
+  return fclose((FILE *)file) == 0;
+}
+
+LONG Read(BPTR file, APTR buffer, LONG length)
+{
+  size_t got = fread(buffer, 1, (size_t)length, (FILE *)file);
+
+  if (got == 0 && ferror((FILE *)file))
+  {
+    io_error = dos_error(errno);
+    return -1;
+  }
+  return (LONG)got;
+}
+
+LONG Write(BPTR file, const void *buffer, LONG length)
+{
+  size_t put = fwrite(buffer, 1, (size_t)length, (FILE *)file);
+
+  host_bytes_written += (ULONG)put;
+  return (LONG)put;
+}
+
+LONG Seek(BPTR file, LONG position, LONG mode)
+{
+  long old = ftell((FILE *)file);
+  int whence = mode == OFFSET_BEGINNING ? SEEK_SET : (mode == OFFSET_END ? SEEK_END : SEEK_CUR);
+
+  if (fseek((FILE *)file, position, whence)) return -1;
+  return (LONG)old;
+}
+
+LONG SetFileSize(BPTR file, LONG position, LONG mode)
+{
+  FILE *stream = (FILE *)file;
+
+  fflush(stream);
+  if (mode == OFFSET_CURRENT) position += (LONG)ftell(stream);
+  if (ftruncate(fileno(stream), position)) return -1;
+  return position;
+}
+
+STRPTR FGets(BPTR file, STRPTR buffer, ULONG length)
+{
+  return fgets(buffer, (int)length, (FILE *)file);
+}
+
+LONG FPuts(BPTR file, CONST_STRPTR string)
+{
+  host_bytes_written += (ULONG)strlen(string);
+  return fputs(string, (FILE *)file) < 0;
+}
+
+LONG Flush(BPTR file)
+{
+  return fflush((FILE *)file) == 0;
+}
+
+LONG Printf(CONST_STRPTR format, ...)
+{
+  va_list args;
+
+  if (host_quiet) return 0;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  return 0;
+}
+
+LONG FPrintf(BPTR file, CONST_STRPTR format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  vfprintf((FILE *)file, format, args);
+  va_end(args);
+  return 0;
+}
+
+LONG PutStr(CONST_STRPTR string)
+{
+  if (!host_quiet) fputs(string, stdout);
+  return 0;
+}
+
+void PrintFault(LONG code, CONST_STRPTR header)
+{
+  if (!host_quiet) printf("%s: error %ld\n", header ? header : "", code);
+}
+
+BPTR Output(void)
+{
+  return (BPTR)stdout;
+}
+
+LONG IsInteractive(BPTR file)
+{
+  return isatty(fileno((FILE *)file));
+}
+
+LONG IoErr(void)
+{
+  return io_error;
+}
+
+void SetIoErr(LONG code)
+{
+  io_error = code;
+}
+
+/* dos.library: names, locks and dates */
+
+LONG Rename(CONST_STRPTR old_name, CONST_STRPTR new_name)
+{
+  if (rename(old_name, new_name) == 0) return TRUE;
+  io_error = dos_error(errno);
+  return FALSE;
+}
+
+LONG DeleteFile(CONST_STRPTR name)
+{
+  if (unlink(name) == 0) return TRUE;
+  io_error = dos_error(errno);
+  return FALSE;
+}
+
+BPTR Lock(CONST_STRPTR name, LONG mode)
+{
+  struct stat st;
+  HostLock *lock;
+
+  if (stat(name, &st))
+  {
+    io_error = dos_error(errno);
+    return 0;
+  }
+  lock = malloc(sizeof(HostLock));
+  strncpy(lock->path, name, sizeof(lock->path) - 1);
+  lock->path[sizeof(lock->path) - 1] = '\0';
+  return (BPTR)lock;
+}
+
+void UnLock(BPTR lock)
+{
+  free((void *)lock);
+}
+
+LONG SameLock(BPTR lock1, BPTR lock2)
+{
+  struct stat st1, st2;
+
+  if (stat(((HostLock *)lock1)->path, &st1) || stat(((HostLock *)lock2)->path, &st2))
+  {
+    return LOCK_DIFFERENT;
+  }
+  if (st1.st_dev != st2.st_dev) return LOCK_DIFFERENT;
+  return (st1.st_ino == st2.st_ino) ? LOCK_SAME : LOCK_SAME_VOLUME;
+}
+
+LONG Examine(BPTR lock, struct FileInfoBlock *fib)
+{
+  struct stat st;
+
+  if (stat(((HostLock *)lock)->path, &st)) return FALSE;
+  fill_fib(fib, ((HostLock *)lock)->path, &st);
+  return TRUE;
+}
+
+LONG ExamineFH(BPTR file, struct FileInfoBlock *fib)
+{
+  struct stat st;
+
+  fflush((FILE *)file);
+  if (fstat(fileno((FILE *)file), &st)) return FALSE;
+  if (!S_ISREG(st.st_mode)) return FALSE;
+  fill_fib(fib, "", &st);
+  return TRUE;
+}
+
+APTR AllocDosObject(ULONG type, const struct TagItem *tags)
+{
+  return calloc(1, sizeof(struct FileInfoBlock));
+}
+
+void FreeDosObject(ULONG type, APTR object)
+{
+  free(object);
+}
+
+LONG AddPart(STRPTR dir, CONST_STRPTR file, ULONG size)
+{
+  size_t length = strlen(dir);
+  BOOL separator = (BOOL)(length > 0 && dir[length - 1] != ':' && dir[length - 1] != '/');
+
+  if (length + separator + strlen(file) + 1 > size) return FALSE;
+  if (separator) strcat(dir, "/");
+  strcat(dir, file);
+  return TRUE;
+}
+
+STRPTR FilePart(CONST_STRPTR path)
+{
+  const char *name = strrchr(path, '/');
+
+  if (!name) name = strrchr(path, ':');
+  return (STRPTR)(name ? name + 1 : path);
+}
+
+LONG CompareDates(const struct DateStamp *date1, const struct DateStamp *date2)
+{
+  if (date1->ds_Days != date2->ds_Days) return date2->ds_Days - date1->ds_Days;
+  if (date1->ds_Minute != date2->ds_Minute) return date2->ds_Minute - date1->ds_Minute;
+  return date2->ds_Tick - date1->ds_Tick;
+}
+
+struct DateStamp *DateStamp(struct DateStamp *date)
+{
+  time_t now = time(NULL);
+
+  date->ds_Days = (LONG)(now / 86400);
+  date->ds_Minute = (LONG)((now % 86400) / 60);
+  date->ds_Tick = (LONG)((now % 60) * 50);
+  return date;
+}
+
+LONG SetFileDate(CONST_STRPTR name, const struct DateStamp *date)
+{
+  return TRUE;
+}
+
+/* File mapping for load_text_file in builds with HOST_MMAP */
+
+UBYTE *host_map_file(const char *path, ULONG *size, ULONG *map_size)
+{
+  long page = sysconf(_SC_PAGESIZE);
+  struct stat st;
+  UBYTE *base;
+  int fd = open(path, O_RDONLY);
+
+  if (fd < 0) return NULL;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+  {
+    close(fd);
+    return NULL;
+  }
+
+  /* Anonymous pages under the file keep the byte after it for the NUL */
+  *map_size = ((ULONG)st.st_size + page) / page * page;
+  base = mmap(NULL, *map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base != MAP_FAILED &&
+      mmap(base, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+  {
+    munmap(base, *map_size);
+    base = MAP_FAILED;
+  }
+  close(fd);
+  if (base == MAP_FAILED) return NULL;
+
+  *size = (ULONG)st.st_size;
+  host_files_mapped++;
+  return base;
+}
+
+void host_unmap_file(UBYTE *buffer, ULONG map_size)
+{
+  munmap(buffer, map_size);
+}
+
+/* dos.library: command line, set by host_set_arguments */
+
+#define HOST_MAX_ITEMS 32         /* Most items in a ReadArgs template */
+
+static int host_argc = 0;
+static char **host_argv = NULL;
+static struct RDArgs host_rdargs;
+static STRPTR multi_args[HOST_MAX_ITEMS + 1];
+
+void host_set_arguments(int argc, char **argv)
+{
+  host_argc = argc;
+  host_argv = argv;
+}
+
+/**
+ * Split a template into item names and their first modifier letter
+ */
+static LONG parse_template(CONST_STRPTR template, char names[][32], char *modifiers)
+{
+  LONG count = 0;
+  size_t length;
+  const char *slash;
+
+  while (*template && count < HOST_MAX_ITEMS)
+  {
+    length = strcspn(template, ",");
+    slash = memchr(template, '/', length);
+    snprintf(names[count], 32, "%.*s", (int)(slash ? (size_t)(slash - template) : length), template);
+    modifiers[count] = slash ? (char)toupper((unsigned char)slash[1]) : 0;
+    count++;
+    template += length;
+    if (*template == ',') template++;
+  }
+  return count;
+}
+
+/**
+ * ReadArgs for /S, /K, /M and plain items, as "KEY value", "KEY=value"
+ * or by position
+ */
+struct RDArgs *ReadArgs(CONST_STRPTR template, LONG *array, struct RDArgs *args)
+{
+  char names[HOST_MAX_ITEMS][32], modifiers[HOST_MAX_ITEMS];
+  LONG count = parse_template(template, names, modifiers);
+  LONG multi_count = 0, item, multi = -1;
+  char *arg, *equals;
+  size_t length;
+  int i;
+
+  for (item = 0; item < count; item++)
+  {
+    if (modifiers[item] == 'M') multi = item;
+  }
+
+  for (i = 1; i < host_argc; i++)
+  {
+    arg = host_argv[i];
+    equals = strchr(arg, '=');
+    length = equals ? (size_t)(equals - arg) : strlen(arg);
+    for (item = 0; item < count; item++)
+    {
+      if (strlen(names[item]) == length && strncasecmp(names[item], arg, length) == 0) break;
+    }
+
+    if (item < count && modifiers[item] == 'S')
+    {
+      array[item] = TRUE;
+    }
+    else if (item < count && modifiers[item] == 'K')
+    {
+      if (equals) array[item] = (LONG)(equals + 1);
+      else if (i + 1 < host_argc) array[item] = (LONG)host_argv[++i];
+      else return NULL;
+    }
+    else
+    {
+      // A positional argument fills the first free plain item, then /M
+      for (item = 0; item < count; item++)
+      {
+        if (modifiers[item] == 0 && !array[item]) break;
+      }
+      if (item < count) array[item] = (LONG)arg;
+      else if (multi >= 0 && multi_count < HOST_MAX_ITEMS) multi_args[multi_count++] = (STRPTR)arg;
+      else return NULL;
+    }
+  }
+
+  if (multi >= 0 && multi_count)
+  {
+    multi_args[multi_count] = NULL;
+    array[multi] = (LONG)multi_args;
+  }
+  return &host_rdargs;
+}
+
+void FreeArgs(struct RDArgs *args)
+{
+}
+
+/* dos.library: patterns, with #? and ? mapped to the host * and ? */
+
+static VOID host_pattern(CONST_STRPTR pattern, char *buffer, size_t size)
+{
+  size_t out = 0;
+
+  while (*pattern && out + 1 < size)
+  {
+    if (pattern[0] == '#' && pattern[1] == '?')
+    {
+      buffer[out++] = '*';
+      pattern += 2;
+    }
+    else
+    {
+      buffer[out++] = *pattern++;
+    }
+  }
+  buffer[out] = '\0';
+}
+
+LONG ParsePatternNoCase(CONST_STRPTR pattern, STRPTR buffer, LONG length)
+{
+  host_pattern(pattern, buffer, (size_t)length);
+  return strpbrk(buffer, "*?[") ? 1 : 0;
+}
+
+LONG MatchPatternNoCase(CONST_STRPTR pattern, CONST_STRPTR string)
+{
+  return fnmatch(pattern, string, FNM_CASEFOLD) == 0;
+}
+
+static LONG match_fill(struct AnchorPath *anchor, const char *path)
+{
+  struct stat st;
+
+  if (stat(path, &st)) return ERROR_OBJECT_NOT_FOUND;
+  strncpy((char *)anchor->ap_Buf, path, anchor->ap_Strlen - 1);
+  fill_fib(&anchor->ap_Info, path, &st);
+  return 0;
+}
+
+LONG MatchNext(struct AnchorPath *anchor)
+{
+  struct dirent *entry;
+  char path[1024];
+
+  if (!match_dir) return ERROR_NO_MORE_ENTRIES;
+  while ((entry = readdir(match_dir)) != NULL)
+  {
+    if (entry->d_name[0] == '.') continue;
+    if (fnmatch(match_pattern, entry->d_name, FNM_CASEFOLD)) continue;
+    snprintf(path, sizeof(path), "%s%s", match_dir_path, entry->d_name);
+    return match_fill(anchor, path);
+  }
+  return ERROR_NO_MORE_ENTRIES;
+}
+
+LONG MatchFirst(CONST_STRPTR pattern, struct AnchorPath *anchor)
+{
+  const char *name = FilePart(pattern);
+  size_t dir_length = (size_t)(name - pattern);
+
+  host_pattern(name, match_pattern, sizeof(match_pattern));
+  if (!strpbrk(match_pattern, "*?[")) return match_fill(anchor, pattern);
+
+  memcpy(match_dir_path, pattern, dir_length);
+  match_dir_path[dir_length] = '\0';
+  match_dir = opendir(dir_length ? match_dir_path : ".");
+  if (!match_dir) return ERROR_OBJECT_NOT_FOUND;
+  return MatchNext(anchor);
+}
+
+void MatchEnd(struct AnchorPath *anchor)
+{
+  if (match_dir) closedir(match_dir);
+  match_dir = NULL;
+}
@@ -0,0 +1,404 @@
+/**
+ * graphics, intuition, diskfont and iffparse stand-ins that draw nothing
+ *
+ * The screen is a 640x512 public screen with a settable depth, palette
+ * and font height. Drawing calls only update the counters in host_shim.h,
+ * so tests can see how much work the window code asks for. Tests feed the
+ * window IDCMP messages through host_move_mouse and host_queue_message.
+ */
+
+#include "host_shim.h"
+
+#include <exec/types.h>
+#include <graphics/gfx.h>
+#include <intuition/intuition.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_SCREEN_WIDTH 640
+#define HOST_SCREEN_HEIGHT 512
+#define HOST_FONT_WIDTH 8
+#define HOST_QUEUE_SIZE 256
+
+ULONG host_fills = 0;
+ULONG host_blits = 0;
+ULONG host_blit_area = 0;
+ULONG host_window_moves = 0;
+ULONG host_pens_obtained = 0;
+ULONG host_pens_released = 0;
+UWORD host_screen_depth = 8;
+UWORD host_font_height = 8;
+ULONG host_palette[256][3];
+BOOL host_defer_window_moves = FALSE;
+
+static struct BitMap screen_bitmap;
+static struct ColorMap screen_colormap;
+static struct TextFont screen_font;
+static struct Screen screen;
+static struct RastPort window_rastport;
+static struct Window window;
+static struct MsgPort window_port;
+static BOOL pen_in_use[256];
+static struct IntuiMessage message_queue[HOST_QUEUE_SIZE];
+static ULONG queue_head = 0, queue_tail = 0;
+static BOOL window_move_pending = FALSE;
+static WORD pending_left, pending_top;
+
+/* Input from tests */
+
+void host_move_mouse(WORD x, WORD y)
+{
+  screen.MouseX = x;
+  screen.MouseY = y;
+  window.MouseX = x - window.LeftEdge;
+  window.MouseY = y - window.TopEdge;
+}
+
+void host_queue_message(ULONG idcmp_class, UWORD code)
+{
+  struct IntuiMessage *message;
+
+  if (queue_tail - queue_head >= HOST_QUEUE_SIZE)
+  {
+    fprintf(stderr, "host_queue_message: queue full\n");
+    exit(1);
+  }
+  message = &message_queue[queue_tail++ % HOST_QUEUE_SIZE];
+  memset(message, 0, sizeof(*message));
+  message->Class = idcmp_class;
+  message->Code = code;
+  message->MouseX = window.MouseX;
+  message->MouseY = window.MouseY;
+  message->IDCMPWindow = &window;
+}
+
+void host_apply_window_moves(void)
+{
+  if (!window_move_pending) return;
+  window_move_pending = FALSE;
+  window.LeftEdge = pending_left;
+  window.TopEdge = pending_top;
+  host_move_mouse(screen.MouseX, screen.MouseY);
+}
+
+/* exec.library message ports; only the window port gets messages */
+
+struct Message *GetMsg(struct MsgPort *port)
+{
+  if (port != &window_port || queue_head == queue_tail) return NULL;
+  return (struct Message *)&message_queue[queue_head++ % HOST_QUEUE_SIZE];
+}
+
+void ReplyMsg(struct Message *message)
+{
+}
+
+struct Message *WaitPort(struct MsgPort *port)
+{
+  if (port != &window_port) return NULL;
+
+  // Nothing left to replay: the user closes the window instead of hanging
+  if (queue_head == queue_tail) host_queue_message(IDCMP_CLOSEWINDOW, 0);
+  return (struct Message *)&message_queue[queue_head % HOST_QUEUE_SIZE];
+}
+
+/* graphics.library */
+
+void SetAPen(struct RastPort *rp, ULONG pen)
+{
+}
+
+void SetBPen(struct RastPort *rp, ULONG pen)
+{
+}
+
+void SetDrMd(struct RastPort *rp, ULONG mode)
+{
+}
+
+void RectFill(struct RastPort *rp, LONG x0, LONG y0, LONG x1, LONG y1)
+{
+  host_fills++;
+}
+
+void Move(struct RastPort *rp, LONG x, LONG y)
+{
+}
+
+void Draw(struct RastPort *rp, LONG x, LONG y)
+{
+}
+
+LONG Text(struct RastPort *rp, CONST_STRPTR string, ULONG count)
+{
+  return 0;
+}
+
+WORD TextLength(struct RastPort *rp, CONST_STRPTR string, ULONG count)
+{
+  return (WORD)(count * HOST_FONT_WIDTH);
+}
+
+ULONG TextFit(struct RastPort *rp, CONST_STRPTR string, ULONG count, struct TextExtent *extent,
+              struct TextExtent *constraint, LONG direction, ULONG width, ULONG height)
+{
+  return count * HOST_FONT_WIDTH <= width ? count : width / HOST_FONT_WIDTH;
+}
+
+void SetFont(struct RastPort *rp, struct TextFont *font)
+{
+  rp->Font = font;
+}
+
+void CloseFont(struct TextFont *font)
+{
+}
+
+void GetRGB32(struct ColorMap *cm, ULONG first, ULONG count, ULONG *table)
+{
+  ULONG i;
+
+  for (i = 0; i < count; i++)
+  {
+    table[i * 3] = host_palette[first + i][0];
+    table[i * 3 + 1] = host_palette[first + i][1];
+    table[i * 3 + 2] = host_palette[first + i][2];
+  }
+}
+
+void SetRGB32(struct ViewPort *vp, ULONG pen, ULONG red, ULONG green, ULONG blue)
+{
+  host_palette[pen][0] = red;
+  host_palette[pen][1] = green;
+  host_palette[pen][2] = blue;
+}
+
+void LoadRGB32(struct ViewPort *vp, const ULONG *table)
+{
+  ULONG count, first, i;
+
+  while ((count = table[0] >> 16) != 0)
+  {
+    first = table[0] & 0xFFFF;
+    for (i = 0; i < count; i++)
+    {
+      SetRGB32(vp, first + i, table[1 + i * 3], table[2 + i * 3], table[3 + i * 3]);
+    }
+    table += 1 + count * 3;
+  }
+}
+
+LONG ObtainBestPenA(struct ColorMap *cm, ULONG red, ULONG green, ULONG blue, struct TagItem *tags)
+{
+  ULONG pen;
+
+  /* Pens below 16 belong to Workbench */
+  for (pen = 16; pen < (1UL << host_screen_depth); pen++)
+  {
+    if (!pen_in_use[pen])
+    {
+      pen_in_use[pen] = TRUE;
+      SetRGB32(NULL, pen, red, green, blue);
+      host_pens_obtained++;
+      return (LONG)pen;
+    }
+  }
+  return -1;
+}
+
+void ReleasePen(struct ColorMap *cm, ULONG pen)
+{
+  if (!pen_in_use[pen])
+  {
+    fprintf(stderr, "ReleasePen: pen %lu was not obtained\n", pen);
+    exit(1);
+  }
+  pen_in_use[pen] = FALSE;
+  host_pens_released++;
+}
+
+ULONG GetDisplayInfoData(APTR handle, UBYTE *buffer, ULONG size, ULONG tag, ULONG id)
+{
+  return 0;
+}
+
+ULONG GetVPModeID(struct ViewPort *vp)
+{
+  return 0;
+}
+
+struct BitMap *AllocBitMap(ULONG width, ULONG height, ULONG depth, ULONG flags,
+                           struct BitMap *friend_bitmap)
+{
+  struct BitMap *bm = calloc(1, sizeof(struct BitMap));
+
+  if (bm)
+  {
+    bm->Rows = (UWORD)height;
+    bm->Depth = (UBYTE)depth;
+  }
+  return bm;
+}
+
+void FreeBitMap(struct BitMap *bm)
+{
+  free(bm);
+}
+
+ULONG GetBitMapAttr(struct BitMap *bm, ULONG attribute)
+{
+  return attribute == BMA_DEPTH ? bm->Depth : 0;
+}
+
+void InitRastPort(struct RastPort *rp)
+{
+  memset(rp, 0, sizeof(struct RastPort));
+}
+
+void ClipBlit(struct RastPort *src, LONG src_x, LONG src_y, struct RastPort *dest, LONG dest_x, LONG dest_y,
+              LONG width, LONG height, ULONG minterm)
+{
+  host_blits++;
+  host_blit_area += (ULONG)(width * height);
+}
+
+void WaitBlit(void)
+{
+}
+
+void ScrollRaster(struct RastPort *rp, LONG dx, LONG dy, LONG x0, LONG y0, LONG x1, LONG y1)
+{
+}
+
+/* intuition.library */
+
+struct Screen *LockPubScreen(CONST_STRPTR name)
+{
+  screen_bitmap.Depth = (UBYTE)host_screen_depth;
+  screen.Width = HOST_SCREEN_WIDTH;
+  screen.Height = HOST_SCREEN_HEIGHT;
+  screen.RastPort.BitMap = &screen_bitmap;
+  screen.ViewPort.ColorMap = &screen_colormap;
+  screen_font.tf_YSize = host_font_height;
+  screen_font.tf_Baseline = (UWORD)(host_font_height - 2);
+  screen.RastPort.Font = &screen_font;
+  return &screen;
+}
+
+void UnlockPubScreen(CONST_STRPTR name, struct Screen *locked)
+{
+}
+
+struct Window *OpenWindowTags(struct NewWindow *new_window, ...)
+{
+  va_list tags;
+  ULONG tag, data;
+
+  memset(&window, 0, sizeof(window));
+  queue_head = queue_tail = 0;
+  window_move_pending = FALSE;
+  va_start(tags, new_window);
+  // Tags and values are passed as 32-bit ints; on the stack the upper half
+  // of each 64-bit slot is garbage
+  while ((tag = va_arg(tags, ULONG) & 0xFFFFFFFFUL) != TAG_DONE)
+  {
+    data = va_arg(tags, ULONG) & 0xFFFFFFFFUL;
+    if (tag == WA_Left) window.LeftEdge = (WORD)data;
+    if (tag == WA_Top) window.TopEdge = (WORD)data;
+    if (tag == WA_Width) window.Width = (WORD)data;
+    if (tag == WA_Height) window.Height = (WORD)data;
+  }
+  va_end(tags);
+
+  /* WA_AutoAdjust moves a window onto the screen but cannot shrink it */
+  if (window.Width > screen.Width || window.Height > screen.Height) return NULL;
+  if (window.LeftEdge + window.Width > screen.Width) window.LeftEdge = screen.Width - window.Width;
+  if (window.TopEdge + window.Height > screen.Height) window.TopEdge = screen.Height - window.Height;
+
+  window.RPort = &window_rastport;
+  window.UserPort = &window_port;
+  window.WScreen = &screen;
+  return &window;
+}
+
+void CloseWindow(struct Window *closed)
+{
+}
+
+void ChangeWindowBox(struct Window *moved, LONG left, LONG top, LONG width, LONG height)
+{
+  host_window_moves++;
+  pending_left = (WORD)left;
+  pending_top = (WORD)top;
+  window_move_pending = TRUE;
+  if (!host_defer_window_moves) host_apply_window_moves();
+}
+
+void MoveWindow(struct Window *moved, LONG dx, LONG dy)
+{
+  ChangeWindowBox(moved, moved->LeftEdge + dx, moved->TopEdge + dy, moved->Width, moved->Height);
+}
+
+void BeginRefresh(struct Window *refreshed)
+{
+}
+
+void EndRefresh(struct Window *refreshed, LONG complete)
+{
+}
+
+void RefreshGList(struct Gadget *gadgets, struct Window *refreshed, void *requester, LONG count)
+{
+}
+
+void ModifyIDCMP(struct Window *changed, ULONG flags)
+{
+}
+
+/* diskfont.library */
+
+struct TextFont *OpenDiskFont(struct TextAttr *attr)
+{
+  return &screen_font;
+}
+
+/* iffparse.library; there is never a font preferences file */
+
+struct IFFHandle *AllocIFF(void)
+{
+  return NULL;
+}
+
+void InitIFFasDOS(struct IFFHandle *iff)
+{
+}
+
+LONG OpenIFF(struct IFFHandle *iff, LONG mode)
+{
+  return 1;
+}
+
+LONG PropChunk(struct IFFHandle *iff, LONG type, LONG id)
+{
+  return 1;
+}
+
+LONG ParseIFF(struct IFFHandle *iff, LONG control)
+{
+  return 1;
+}
+
+struct StoredProperty *FindProp(struct IFFHandle *iff, LONG type, LONG id)
+{
+  return NULL;
+}
+
+void CloseIFF(struct IFFHandle *iff)
+{
+}
+
+void FreeIFF(struct IFFHandle *iff)
+{
+}
@@ -0,0 +1,42 @@
+/**
+ * Counters kept by the host shims, for the benchmarks and tests in this
+ * directory
+ */
+
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <exec/types.h>
+
+/* dos_shim.c */
+extern ULONG host_alloc_calls;            /* AllocMem and AllocVec calls */
+extern ULONG host_free_calls;             /* FreeMem and FreeVec calls */
+extern ULONG host_bytes_written;          /* Bytes passed to Write and FPuts */
+extern ULONG host_library_opens;          /* OpenLibrary calls that succeeded */
+extern ULONG host_library_closes;         /* CloseLibrary calls */
+extern BOOL host_quiet;                   /* TRUE to drop Printf output */
+extern ULONG host_files_mapped;           /* Files load_text_file mapped with HOST_MMAP */
+void host_set_arguments(int argc, char **argv);  /* Command line ReadArgs parses */
+
+/* dos_shim.c file mapping: copy-on-write pages, with a zero byte after the file */
+UBYTE *host_map_file(const char *path, ULONG *size, ULONG *map_size);
+void host_unmap_file(UBYTE *buffer, ULONG map_size);
+
+/* gfx_shim.c */
+extern ULONG host_fills;                  /* RectFill calls */
+extern ULONG host_blits;                  /* ClipBlit calls */
+extern ULONG host_blit_area;              /* Pixels copied by ClipBlit */
+extern ULONG host_window_moves;           /* ChangeWindowBox calls */
+extern ULONG host_pens_obtained;          /* ObtainBestPenA calls that got a pen */
+extern ULONG host_pens_released;          /* ReleasePen calls */
+extern UWORD host_screen_depth;           /* Depth of the screen LockPubScreen returns */
+extern UWORD host_font_height;            /* Height of the screen font */
+extern ULONG host_palette[256][3];        /* Screen palette as 32-bit GetRGB32 values */
+extern BOOL host_defer_window_moves;      /* TRUE to hold ChangeWindowBox until host_apply_window_moves */
+
+/* gfx_shim.c input to the window */
+void host_move_mouse(WORD x, WORD y);     /* Put the pointer at a screen position */
+void host_queue_message(ULONG idcmp_class, UWORD code);  /* Send an IDCMP message at the pointer */
+void host_apply_window_moves(void);       /* Carry out a held ChangeWindowBox */
+
+#endif
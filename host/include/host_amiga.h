@@ -0,0 +1,315 @@
+/**
+ * Minimal AmigaOS declarations for building the sources on a host
+ *
+ * Every system header the sources include maps to this one file. Only the
+ * types, constants and functions the sources use are declared, with the
+ * NDK names and field names but host sizes; nothing here is binary
+ * compatible with the real includes. The functions are implemented by
+ * dos_shim.c and gfx_shim.c.
+ */
+
+#ifndef HOST_AMIGA_H
+#define HOST_AMIGA_H
+
+#include <stddef.h>
+
+/* exec/types.h */
+typedef unsigned char UBYTE;
+typedef signed char BYTE;
+typedef unsigned short UWORD;
+typedef short WORD;
+typedef unsigned long ULONG;
+typedef long LONG;
+typedef short BOOL;
+typedef void VOID;
+typedef void *APTR;
+typedef char *STRPTR;
+typedef const char *CONST_STRPTR;
+typedef long BPTR;
+typedef unsigned char TEXT;
+typedef ULONG Tag;
+typedef float FLOAT;
+
+#define TRUE 1
+#define FALSE 0
+#define CONST const
+
+/* exec/memory.h */
+#define MEMF_ANY 0
+#define MEMF_PUBLIC (1L << 0)
+#define MEMF_CHIP (1L << 1)
+#define MEMF_CLEAR (1L << 16)
+
+/* exec/nodes.h, exec/lists.h, exec/ports.h, exec/io.h, exec/libraries.h */
+struct Node { struct Node *ln_Succ, *ln_Pred; UBYTE ln_Type; BYTE ln_Pri; char *ln_Name; };
+struct MinNode { struct MinNode *mln_Succ, *mln_Pred; };
+struct List { struct Node *lh_Head, *lh_Tail, *lh_TailPred; UBYTE lh_Type, l_pad; };
+struct MinList { struct MinNode *mlh_Head, *mlh_Tail, *mlh_TailPred; };
+struct Message { struct Node mn_Node; struct MsgPort *mn_ReplyPort; UWORD mn_Length; };
+struct MsgPort { struct Node mp_Node; UBYTE mp_Flags; UBYTE mp_SigBit; void *mp_SigTask; struct List mp_MsgList; };
+struct IORequest { struct Message io_Message; struct Device *io_Device; struct Unit *io_Unit;
+                   UWORD io_Command; UBYTE io_Flags; BYTE io_Error; };
+struct Library { struct Node lib_Node; UWORD lib_Version; };
+struct Device { struct Library dd_Library; };
+
+#define IOERR_OK 0
+#define SIGBREAKF_CTRL_C (1L << 12)
+
+/* utility/tagitem.h */
+struct TagItem { Tag ti_Tag; ULONG ti_Data; };
+
+#define TAG_DONE 0
+#define TAG_END 0
+#define TAG_USER (1UL << 31)
+
+/* devices/timer.h */
+struct EClockVal { ULONG ev_hi; ULONG ev_lo; };
+struct AmiTimeval { ULONG tv_secs; ULONG tv_micro; };
+struct timerequest { struct IORequest tr_node; struct AmiTimeval tr_time; };
+
+#define UNIT_MICROHZ 0
+#define UNIT_ECLOCK 2
+#define TIMERNAME "timer.device"
+
+/* dos/dos.h, dos/dosasl.h, dos/rdargs.h */
+struct DateStamp { LONG ds_Days; LONG ds_Minute; LONG ds_Tick; };
+struct FileInfoBlock { LONG fib_DiskKey; LONG fib_DirEntryType; char fib_FileName[108];
+                       LONG fib_Protection; LONG fib_EntryType; LONG fib_Size; LONG fib_NumBlocks;
+                       struct DateStamp fib_Date; char fib_Comment[80]; };
+struct AnchorPath { void *ap_Base, *ap_Last; LONG ap_BreakBits; LONG ap_FoundBreak;
+                    BYTE ap_Flags; BYTE ap_Reserved; WORD ap_Strlen;
+                    struct FileInfoBlock ap_Info; UBYTE ap_Buf[1]; };
+struct RDArgs { int unused; };
+
+#define MODE_READWRITE 1004
+#define MODE_OLDFILE 1005
+#define MODE_NEWFILE 1006
+#define OFFSET_BEGINNING -1
+#define OFFSET_CURRENT 0
+#define OFFSET_END 1
+#define SHARED_LOCK -2
+#define ACCESS_READ -2
+#define EXCLUSIVE_LOCK -1
+#define LOCK_DIFFERENT -1
+#define LOCK_SAME 0
+#define LOCK_SAME_VOLUME 1
+#define DOS_FIB 2
+#define RETURN_OK 0
+#define RETURN_WARN 5
+#define RETURN_ERROR 10
+#define RETURN_FAIL 20
+#define ERROR_NO_FREE_STORE 103
+#define ERROR_OBJECT_IN_USE 202
+#define ERROR_OBJECT_NOT_FOUND 205
+#define ERROR_NO_MORE_ENTRIES 232
+#define ERROR_BREAK 304
+
+/* graphics */
+struct TextAttr { STRPTR ta_Name; UWORD ta_YSize; UBYTE ta_Style; UBYTE ta_Flags; };
+struct TextFont { struct Message tf_Message; UWORD tf_YSize; UBYTE tf_Style; UBYTE tf_Flags;
+                  UWORD tf_XSize; UWORD tf_Baseline; };
+struct TextExtent { UWORD te_Width; UWORD te_Height; WORD te_Extent[4]; };
+struct BitMap { UWORD BytesPerRow; UWORD Rows; UBYTE Flags; UBYTE Depth; UWORD pad; void *Planes[8]; };
+struct Layer { int unused; };
+struct RastPort { struct Layer *Layer; struct BitMap *BitMap; struct TextFont *Font; };
+struct ColorMap { UBYTE Flags; UBYTE Type; UWORD Count; };
+struct ViewPort { struct ColorMap *ColorMap; };
+struct Rectangle { WORD MinX, MinY, MaxX, MaxY; };
+struct Point { WORD x, y; };
+struct DisplayInfo { ULONG PropertyFlags; struct Point Resolution; };
+struct GfxBase { struct Library LibNode; };
+
+#define JAM1 0
+#define JAM2 1
+#define BMF_CLEAR (1L << 0)
+#define BMF_DISPLAYABLE (1L << 1)
+#define BMF_MINPLANES (1L << 4)
+#define BMA_DEPTH 4
+#define DTAG_DISP 0x80000000
+#define OBP_Precision 0x84000000
+#define OBP_FailIfBad 0x84000001
+#define PRECISION_EXACT -1
+#define PRECISION_IMAGE 0
+
+/* intuition */
+struct NewWindow;
+struct Screen { struct Screen *NextScreen; WORD LeftEdge, TopEdge, Width, Height; WORD MouseY, MouseX;
+                struct ViewPort ViewPort; struct RastPort RastPort; struct TextAttr *Font; };
+struct Window { WORD LeftEdge, TopEdge, Width, Height; WORD MouseY, MouseX; struct RastPort *RPort;
+                struct MsgPort *UserPort; struct Screen *WScreen; struct Gadget *FirstGadget; };
+struct Gadget { struct Gadget *NextGadget; WORD LeftEdge, TopEdge, Width, Height;
+                UWORD Flags, Activation, GadgetType; APTR GadgetRender, SelectRender; void *GadgetText;
+                LONG MutualExclude; APTR SpecialInfo; UWORD GadgetID; APTR UserData; };
+struct IntuiMessage { struct Message ExecMessage; ULONG Class; UWORD Code; UWORD Qualifier; APTR IAddress;
+                      WORD MouseX, MouseY; ULONG Seconds, Micros; struct Window *IDCMPWindow; };
+struct IntuitionBase { struct Library LibNode; };
+
+#define WFLG_REPORTMOUSE 0x00000200
+#define WFLG_SIMPLE_REFRESH 0x00000040
+#define WFLG_BORDERLESS 0x00000800
+#define WFLG_ACTIVATE 0x00001000
+#define WFLG_RMBTRAP 0x00010000
+#define IDCMP_NEWSIZE 0x00000002
+#define IDCMP_REFRESHWINDOW 0x00000004
+#define IDCMP_MOUSEBUTTONS 0x00000008
+#define IDCMP_MOUSEMOVE 0x00000010
+#define IDCMP_GADGETDOWN 0x00000020
+#define IDCMP_CLOSEWINDOW 0x00000200
+#define IDCMP_RAWKEY 0x00000400
+#define IDCMP_ACTIVEWINDOW 0x00040000
+#define IDCMP_INTUITICKS 0x00400000
+#define IDCMP_CHANGEWINDOW 0x02000000
+#define GTYP_WDRAGGING 0x0030
+#define GFLG_GADGHNONE 0x0003
+#define GACT_IMMEDIATE 0x0002
+#define SELECTDOWN 0x68
+#define SELECTUP 0xE8
+#define IEQUALIFIER_LSHIFT 0x0001
+#define IEQUALIFIER_RSHIFT 0x0002
+#define IEQUALIFIER_LCOMMAND 0x0040
+#define IEQUALIFIER_RCOMMAND 0x0080
+#define WA_Left 0x80000064
+#define WA_Top 0x80000065
+#define WA_Width 0x80000066
+#define WA_Height 0x80000067
+#define WA_IDCMP 0x8000006A
+#define WA_Flags 0x8000006B
+#define WA_Gadgets 0x8000006C
+#define WA_Title 0x8000006E
+#define WA_InnerWidth 0x80000076
+#define WA_InnerHeight 0x80000077
+#define WA_PubScreen 0x80000079
+#define WA_MouseQueue 0x8000007E
+
+/* libraries/iffparse.h, prefs/font.h */
+struct IFFHandle { ULONG iff_Stream; ULONG iff_Flags; LONG iff_Depth; };
+struct StoredProperty { LONG sp_Size; APTR sp_Data; };
+struct FontPrefs { LONG fp_Reserved[3]; UWORD fp_Reserved2; UWORD fp_Type; UBYTE fp_FrontPen;
+                   UBYTE fp_BackPen; UBYTE fp_DrawMode; struct TextAttr fp_TextAttr; BYTE fp_Name[32]; };
+
+#define MAKE_ID(a, b, c, d) ((ULONG)(a) << 24 | (ULONG)(b) << 16 | (ULONG)(c) << 8 | (ULONG)(d))
+#define IFFF_READ 0
+#define IFFPARSE_SCAN 0
+
+/* Library bases */
+extern struct Library *SysBase, *DOSBase, *DiskfontBase, *IFFParseBase;
+extern struct GfxBase *GfxBase;
+extern struct IntuitionBase *IntuitionBase;
+
+/* exec.library */
+APTR AllocMem(ULONG size, ULONG flags);
+void FreeMem(APTR mem, ULONG size);
+APTR AllocVec(ULONG size, ULONG flags);
+void FreeVec(APTR mem);
+void CopyMem(const void *source, void *dest, ULONG size);
+struct Message *GetMsg(struct MsgPort *port);
+void ReplyMsg(struct Message *message);
+struct Message *WaitPort(struct MsgPort *port);
+struct MsgPort *CreateMsgPort(void);
+void DeleteMsgPort(struct MsgPort *port);
+struct IORequest *CreateIORequest(struct MsgPort *port, ULONG size);
+void DeleteIORequest(struct IORequest *request);
+BYTE OpenDevice(CONST_STRPTR name, ULONG unit, struct IORequest *request, ULONG flags);
+void CloseDevice(struct IORequest *request);
+struct Library *OpenLibrary(CONST_STRPTR name, ULONG version);
+void CloseLibrary(struct Library *library);
+ULONG SetSignal(ULONG new_signals, ULONG mask);
+
+/* timer.device */
+ULONG ReadEClock(struct EClockVal *clock);
+
+/* dos.library */
+BPTR Open(CONST_STRPTR name, LONG mode);
+LONG Close(BPTR file);
+LONG Read(BPTR file, APTR buffer, LONG length);
+LONG Write(BPTR file, const void *buffer, LONG length);
+LONG Seek(BPTR file, LONG position, LONG mode);
+LONG SetFileSize(BPTR file, LONG position, LONG mode);
+STRPTR FGets(BPTR file, STRPTR buffer, ULONG length);
+LONG FPuts(BPTR file, CONST_STRPTR string);
+LONG Flush(BPTR file);
+LONG Printf(CONST_STRPTR format, ...);
+LONG FPrintf(BPTR file, CONST_STRPTR format, ...);
+LONG PutStr(CONST_STRPTR string);
+void PrintFault(LONG code, CONST_STRPTR header);
+BPTR Output(void);
+LONG IsInteractive(BPTR file);
+LONG IoErr(void);
+void SetIoErr(LONG code);
+LONG Rename(CONST_STRPTR old_name, CONST_STRPTR new_name);
+LONG DeleteFile(CONST_STRPTR name);
+BPTR Lock(CONST_STRPTR name, LONG mode);
+void UnLock(BPTR lock);
+LONG SameLock(BPTR lock1, BPTR lock2);
+LONG Examine(BPTR lock, struct FileInfoBlock *fib);
+LONG ExamineFH(BPTR file, struct FileInfoBlock *fib);
+APTR AllocDosObject(ULONG type, const struct TagItem *tags);
+void FreeDosObject(ULONG type, APTR object);
+LONG AddPart(STRPTR dir, CONST_STRPTR file, ULONG size);
+STRPTR FilePart(CONST_STRPTR path);
+LONG CompareDates(const struct DateStamp *date1, const struct DateStamp *date2);
+struct DateStamp *DateStamp(struct DateStamp *date);
+LONG SetFileDate(CONST_STRPTR name, const struct DateStamp *date);
+struct RDArgs *ReadArgs(CONST_STRPTR template, LONG *array, struct RDArgs *args);
+void FreeArgs(struct RDArgs *args);
+LONG MatchFirst(CONST_STRPTR pattern, struct AnchorPath *anchor);
+LONG MatchNext(struct AnchorPath *anchor);
+void MatchEnd(struct AnchorPath *anchor);
+LONG ParsePatternNoCase(CONST_STRPTR pattern, STRPTR buffer, LONG length);
+LONG MatchPatternNoCase(CONST_STRPTR pattern, CONST_STRPTR string);
+
+/* graphics.library */
+void SetAPen(struct RastPort *rp, ULONG pen);
+void SetBPen(struct RastPort *rp, ULONG pen);
+void SetDrMd(struct RastPort *rp, ULONG mode);
+void RectFill(struct RastPort *rp, LONG x0, LONG y0, LONG x1, LONG y1);
+void Move(struct RastPort *rp, LONG x, LONG y);
+void Draw(struct RastPort *rp, LONG x, LONG y);
+LONG Text(struct RastPort *rp, CONST_STRPTR string, ULONG count);
+WORD TextLength(struct RastPort *rp, CONST_STRPTR string, ULONG count);
+ULONG TextFit(struct RastPort *rp, CONST_STRPTR string, ULONG count, struct TextExtent *extent,
+              struct TextExtent *constraint, LONG direction, ULONG width, ULONG height);
+void SetFont(struct RastPort *rp, struct TextFont *font);
+void CloseFont(struct TextFont *font);
+void GetRGB32(struct ColorMap *cm, ULONG first, ULONG count, ULONG *table);
+void SetRGB32(struct ViewPort *vp, ULONG pen, ULONG red, ULONG green, ULONG blue);
+void LoadRGB32(struct ViewPort *vp, const ULONG *table);
+LONG ObtainBestPenA(struct ColorMap *cm, ULONG red, ULONG green, ULONG blue, struct TagItem *tags);
+void ReleasePen(struct ColorMap *cm, ULONG pen);
+ULONG GetDisplayInfoData(APTR handle, UBYTE *buffer, ULONG size, ULONG tag, ULONG id);
+ULONG GetVPModeID(struct ViewPort *vp);
+struct BitMap *AllocBitMap(ULONG width, ULONG height, ULONG depth, ULONG flags, struct BitMap *friend_bitmap);
+void FreeBitMap(struct BitMap *bm);
+ULONG GetBitMapAttr(struct BitMap *bm, ULONG attribute);
+void InitRastPort(struct RastPort *rp);
+void ClipBlit(struct RastPort *src, LONG src_x, LONG src_y, struct RastPort *dest, LONG dest_x, LONG dest_y,
+              LONG width, LONG height, ULONG minterm);
+void WaitBlit(void);
+void ScrollRaster(struct RastPort *rp, LONG dx, LONG dy, LONG x0, LONG y0, LONG x1, LONG y1);
+
+/* intuition.library */
+struct Screen *LockPubScreen(CONST_STRPTR name);
+void UnlockPubScreen(CONST_STRPTR name, struct Screen *screen);
+struct Window *OpenWindowTags(struct NewWindow *new_window, ...);
+void CloseWindow(struct Window *window);
+void ChangeWindowBox(struct Window *window, LONG left, LONG top, LONG width, LONG height);
+void MoveWindow(struct Window *window, LONG dx, LONG dy);
+void BeginRefresh(struct Window *window);
+void EndRefresh(struct Window *window, LONG complete);
+void RefreshGList(struct Gadget *gadgets, struct Window *window, void *requester, LONG count);
+void ModifyIDCMP(struct Window *window, ULONG flags);
+
+/* diskfont.library */
+struct TextFont *OpenDiskFont(struct TextAttr *attr);
+
+/* iffparse.library */
+struct IFFHandle *AllocIFF(void);
+void InitIFFasDOS(struct IFFHandle *iff);
+LONG OpenIFF(struct IFFHandle *iff, LONG mode);
+LONG PropChunk(struct IFFHandle *iff, LONG type, LONG id);
+LONG ParseIFF(struct IFFHandle *iff, LONG control);
+struct StoredProperty *FindProp(struct IFFHandle *iff, LONG type, LONG id);
+void CloseIFF(struct IFFHandle *iff);
+void FreeIFF(struct IFFHandle *iff);
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Library opens of each ViNCEd_Theme command line path
+ *
+ * Runs the real main of ViNCEd_Theme.c with the arguments of each path,
+ * in a scratch directory that stands in for ENV:, and counts the
+ * OpenLibrary and CloseLibrary calls the shims see. Windows are closed as
+ * soon as they wait for input.
+ *
+ * Build and run from this directory:
+ *   make opens
+ *
+ * dos.library and exec.library are opened by the startup code and are not
+ * counted. LIVE opens no library, as it only writes to the console, and is
+ * left out so a run from a terminal does not recolor it.
+ */
+
+#define main vinced_main
+#include "../ViNCEd_Theme.c"
+#undef main
+
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static char work_dir[] = "/tmp/vincedopensXXXXXX";
+
+/* One command line path; the arguments follow the program name */
+typedef struct OpenPath
+{
+  const char *name;
+  char *args[4];
+} OpenPath;
+
+static OpenPath paths[] =
+{
+  { "USE", { "dark", "USE", NULL } },
+  { "CHECK", { "dark", "CHECK", NULL } },
+  { "DIFF", { "dark", "DIFF", NULL } },
+  { "VIEW", { "dark", "VIEW", NULL } },
+  { "VIEW gallery", { "dark", "light", "VIEW", NULL } }
+};
+#define PATH_COUNT (sizeof(paths) / sizeof(paths[0]))
+
+/**
+ * Write a theme file of the 16 colors and a cursor color
+ */
+static VOID write_theme(const char *name, ULONG base)
+{
+  FILE *file = fopen(name, "w");
+  ULONG i;
+
+  fprintf(file, "CURSORCOLOR=%lu,%lu,%lu\n", base, base, base);
+  for (i = 0; i < 16; i++)
+  {
+    fprintf(file, "COLOR=%lu,%lu,%lu\n", (base + i * 13) & 0xFF, (base + i * 29) & 0xFF,
+            (base + i * 47) & 0xFF);
+  }
+  fclose(file);
+}
+
+int main(VOID)
+{
+  ULONG opens, closes, i;
+  char *argv[6];
+  int argc, result;
+
+  if (!mkdtemp(work_dir) || chdir(work_dir) != 0)
+  {
+    perror(work_dir);
+    return 1;
+  }
+  write_theme("dark", 16);
+  write_theme("light", 200);
+  host_quiet = TRUE;
+
+  printf("# path\tlibrary_opens\tlibrary_closes\treturn_code\n");
+  for (i = 0; i < PATH_COUNT; i++)
+  {
+    argv[0] = "ViNCEd_Theme";
+    for (argc = 1; paths[i].args[argc - 1]; argc++) argv[argc] = paths[i].args[argc - 1];
+    argv[argc] = NULL;
+    host_set_arguments(argc, argv);
+
+    opens = host_library_opens;
+    closes = host_library_closes;
+    result = vinced_main();
+    printf("%s\t%lu\t%lu\t%d\n", paths[i].name, host_library_opens - opens,
+           host_library_closes - closes, result);
+  }
+
+  unlink("dark");
+  unlink("light");
+  unlink("ENV:ViNCEd.prefs");
+  chdir("/");
+  rmdir(work_dir);
+  return 0;
+}
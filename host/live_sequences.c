@@ -0,0 +1,124 @@
+/**
+ * Test of the control sequences LIVE sends to the console
+ *
+ * Builds ViNCEd_Theme.c against the shims in this directory, reads a theme
+ * with read_theme_file and compares the bytes of build_live_sequences with
+ * the sequences written out by hand.
+ *
+ * Build and run from this directory:
+ *   make check
+ *
+ * The theme mixes the input formats, so the test also covers the 8-bit to
+ * 16-bit conversion the sequences carry. On a mismatch both byte strings
+ * are printed with escapes made visible.
+ */
+
+#define main vinced_main
+#include "../ViNCEd_Theme.c"
+#undef main
+
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static char work_dir[] = "/tmp/vincedliveXXXXXX";
+
+static const char theme[] =
+  "; Cursor first, as in ENV:ViNCEd.prefs\n"
+  "CURSORCOLOR=0xFFFF,0x8000,0x0000\n"
+  "COLOR=0,0,0\n"
+  "COLOR=255,255,255\n"
+  "COLOR=#FF8000\n"
+  "COLOR=LOAD,ANSI,0x1234,0x5678,0x9ABC\n"
+  "COLOR=NOLOAD,NOANSI,0x0001,0x0010,0x0100\n"
+  "COLOR=100%,50%,0%\n"
+  "COLOR=0x10,0x20,0x30\n"
+  "COLOR=1,2,3\n"
+  "COLOR=0xAAAA,0xBBBB,0xCCCC\n"
+  "COLOR=0xDDDD,0xEEEE,0xFFFF\n"
+  "COLOR=0x0000,0x0000,0x0001\n"
+  "COLOR=0x8000,0x8000,0x8000\n"
+  "COLOR=#102030\n"
+  "COLOR=#FFFFFF\n"
+  "COLOR=0x7FFF,0x0000,0xFFFF\n"
+  "COLOR=0x4242,0x4242,0x4242\n";
+
+static const char expected[] =
+  "\033]12;rgb:ffff/8000/0000\007"
+  "\033]4;0;rgb:0000/0000/0000\007"
+  "\033]4;1;rgb:ffff/ffff/ffff\007"
+  "\033]4;2;rgb:ffff/8080/0000\007"
+  "\033]4;3;rgb:1234/5678/9abc\007"
+  "\033]4;4;rgb:0001/0010/0100\007"
+  "\033]4;5;rgb:ffff/8000/0000\007"
+  "\033]4;6;rgb:1010/2020/3030\007"
+  "\033]4;7;rgb:0101/0202/0303\007"
+  "\033]4;8;rgb:aaaa/bbbb/cccc\007"
+  "\033]4;9;rgb:dddd/eeee/ffff\007"
+  "\033]4;10;rgb:0000/0000/0001\007"
+  "\033]4;11;rgb:8000/8000/8000\007"
+  "\033]4;12;rgb:1010/2020/3030\007"
+  "\033]4;13;rgb:ffff/ffff/ffff\007"
+  "\033]4;14;rgb:7fff/0000/ffff\007"
+  "\033]4;15;rgb:4242/4242/4242\007";
+
+/**
+ * Print bytes with ESC and BEL made visible
+ */
+static VOID print_visible(const char *label, const UBYTE *bytes, ULONG length)
+{
+  ULONG i;
+
+  printf("%s ", label);
+  for (i = 0; i < length; i++)
+  {
+    if (bytes[i] == 033) printf("<ESC>");
+    else if (bytes[i] == 007) printf("<BEL>\n    ");
+    else putchar(bytes[i]);
+  }
+  printf("\n");
+}
+
+int main(VOID)
+{
+  UBYTE buffer[LIVE_BUFFER_SIZE];
+  ColorList colors;
+  ULONG length;
+  FILE *file;
+  BOOL same;
+
+  if (!mkdtemp(work_dir) || chdir(work_dir) != 0)
+  {
+    perror(work_dir);
+    return 1;
+  }
+  file = fopen("theme", "w");
+  fputs(theme, file);
+  fclose(file);
+  host_quiet = TRUE;
+
+  init_color_list(&colors);
+  if (!read_theme_file((const UBYTE *)"theme", &colors, NULL))
+  {
+    printf("live_sequences: read_theme_file failed\n");
+    return 1;
+  }
+
+  length = build_live_sequences(&colors, buffer);
+  same = (BOOL)(length == sizeof(expected) - 1 && memcmp(buffer, expected, length) == 0);
+  if (!same)
+  {
+    print_visible("got", buffer, length);
+    print_visible("expected", (const UBYTE *)expected, sizeof(expected) - 1);
+  }
+  printf("live_sequences: %lu bytes for %lu entries, %s\n", length, colors.count,
+         same ? "as expected" : "MISMATCH");
+
+  free_color_list(&colors);
+  unlink("theme");
+  chdir("/");
+  rmdir(work_dir);
+  return same ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/**
+ * Test of the nearest pen search of the swatch window
+ *
+ * Builds amiga_color_window.c against the shims in this directory and
+ * matches colors against a palette of 256 pens with find_closest_pen.
+ *
+ * Build and run from this directory:
+ *   make check
+ *
+ * A color that is in the palette must get a pen of exactly that color with
+ * every metric, also when a pen a few steps away sits in the same 8-step
+ * cell and is nearer its center. Every other color must get a pen no further
+ * away than any pen of the palette.
+ */
+
+#include "../amiga_color_window.c"
+
+/* Defined by ViNCEd_Theme.c, which is not part of this program */
+struct GfxBase *GfxBase = NULL;
+struct IntuitionBase *IntuitionBase = NULL;
+struct Library *DiskfontBase = NULL;
+struct Library *IFFParseBase = NULL;
+
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RANDOM_COLORS 2000  /* Colors not in the palette matched per metric */
+
+static const char *const metric_names[] = { "RGB", "REDMEAN", "LAB" };
+
+/**
+ * Set a pen of the shim screen to an 8-bit color
+ */
+static void set_pen(int pen, int red, int green, int blue)
+{
+  host_palette[pen][0] = (ULONG)red * 0x01010101UL;
+  host_palette[pen][1] = (ULONG)green * 0x01010101UL;
+  host_palette[pen][2] = (ULONG)blue * 0x01010101UL;
+}
+
+/**
+ * Distance of a color to a pen of the palette snapshot
+ */
+static ULONG pen_distance(ColorSwatchWindow *csw, const UBYTE *rgb, int pen)
+{
+  WORD lab[3];
+
+  rgb_to_lab(rgb[0], rgb[1], rgb[2], lab);
+  return metric_distance(csw, rgb, lab, csw->palette[pen], csw->palette_lab[pen]);
+}
+
+/**
+ * Match every palette color and a set of random colors with one metric
+ *
+ * @return Number of failed matches
+ */
+static int check_metric(ColorMetric metric)
+{
+  ColorSwatchWindow *csw;
+  UBYTE rgb[3];
+  ULONG best;
+  int failures = 0, pen, i, c;
+  UBYTE found;
+
+  csw = init_color_swatch_window(NULL, NULL, metric);
+  if (!csw)
+  {
+    fprintf(stderr, "init_color_swatch_window failed\n");
+    exit(1);
+  }
+  snapshot_palette(csw);
+
+  for (pen = 0; pen < 256; pen++)
+  {
+    for (c = 0; c < 3; c++) rgb[c] = csw->palette[pen][c];
+    found = find_closest_pen(csw, rgb[0], rgb[1], rgb[2]);
+    if (pen_distance(csw, rgb, found) != 0)
+    {
+      printf("%s: (%d,%d,%d) of pen %d matched pen %d (%d,%d,%d)\n", metric_names[metric],
+             rgb[0], rgb[1], rgb[2], pen, found, csw->palette[found][0],
+             csw->palette[found][1], csw->palette[found][2]);
+      failures++;
+    }
+  }
+
+  srand(5);
+  for (i = 0; i < RANDOM_COLORS; i++)
+  {
+    for (c = 0; c < 3; c++) rgb[c] = (UBYTE)rand();
+    best = 0xFFFFFFFF;
+    for (pen = 0; pen < 256; pen++)
+    {
+      if (pen_distance(csw, rgb, pen) < best) best = pen_distance(csw, rgb, pen);
+    }
+    found = find_closest_pen(csw, rgb[0], rgb[1], rgb[2]);
+    if (pen_distance(csw, rgb, found) != best)
+    {
+      printf("%s: (%d,%d,%d) matched pen %d at %lu, the nearest is at %lu\n",
+             metric_names[metric], rgb[0], rgb[1], rgb[2], found,
+             pen_distance(csw, rgb, found), best);
+      failures++;
+    }
+  }
+
+  cleanup_color_swatch_window(csw);
+  return failures;
+}
+
+int main(void)
+{
+  int failures = 0, pen;
+
+  host_quiet = TRUE;
+  host_screen_depth = 8;
+
+  // Near neighbours in one cell, whose center is nearer the second
+  set_pen(0, 0, 0, 0);
+  set_pen(1, 5, 5, 5);
+  set_pen(2, 250, 250, 250);
+  set_pen(3, 255, 255, 255);
+  set_pen(4, 0, 0, 3);
+  srand(9);
+  for (pen = 5; pen < 256; pen++) set_pen(pen, rand() & 0xFF, rand() & 0xFF, rand() & 0xFF);
+
+  failures += check_metric(METRIC_RGB);
+  failures += check_metric(METRIC_REDMEAN);
+  failures += check_metric(METRIC_LAB);
+
+  printf("pen_match: 256 pens, %d palette and random colors per metric, %d failures\n",
+         256 + RANDOM_COLORS, failures);
+  return failures ? 1 : 0;
+}
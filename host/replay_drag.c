@@ -0,0 +1,114 @@
+/**
+ * Replay of a window drag through the swatch window's event handler
+ *
+ * Opens the color swatch window on the shim screen and drags it by its
+ * border. Every wakeup of the handler finds a queue of mouse moves, and
+ * ChangeWindowBox is held back the way Intuition defers it, so part of
+ * each queue was sent while the previous move was still outstanding and is
+ * relative to where the window used to be.
+ *
+ * Build and run from this directory:
+ *   make replay
+ *
+ * Once the handler has run and its move is done, the window must sit at
+ * the pointer less the point it was grabbed at. The output gives the
+ * mouse moves sent, the ChangeWindowBox calls they cost and the largest
+ * distance from that position.
+ */
+
+#include "../amiga_color_window.c"
+
+/* Defined by ViNCEd_Theme.c, which is not part of this program */
+struct GfxBase *GfxBase = NULL;
+struct IntuitionBase *IntuitionBase = NULL;
+struct Library *DiskfontBase = NULL;
+struct Library *IFFParseBase = NULL;
+
+#include "host_shim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WAKEUPS 20          /* Times the handler runs during the drag */
+#define MOVES_PER_WAKEUP 10 /* Mouse moves queued for each wakeup */
+#define GRAB_X 1            /* Where in the window the border is grabbed */
+#define GRAB_Y 1
+
+static WORD mouse_x, mouse_y;
+static LONG worst = 0;
+
+/**
+ * Move the pointer by a step and send the window a mouse move
+ */
+static void move_mouse(WORD dx, WORD dy)
+{
+  mouse_x += dx;
+  mouse_y += dy;
+  host_move_mouse(mouse_x, mouse_y);
+  host_queue_message(IDCMP_MOUSEMOVE, 0);
+}
+
+/**
+ * Compare the window with where the pointer says it should be
+ */
+static void check_position(ColorSwatchWindow *csw)
+{
+  LONG dx = csw->window->LeftEdge - (mouse_x - GRAB_X);
+  LONG dy = csw->window->TopEdge - (mouse_y - GRAB_Y);
+
+  if (dx < 0) dx = -dx;
+  if (dy < 0) dy = -dy;
+  if (dx > worst) worst = dx;
+  if (dy > worst) worst = dy;
+}
+
+int main(void)
+{
+  ColorSwatchWindow *csw;
+  ULONG moves_sent = 0;
+  int wakeup, i;
+
+  host_quiet = TRUE;
+  csw = init_color_swatch_window(NULL, NULL, METRIC_REDMEAN);
+  if (!csw)
+  {
+    fprintf(stderr, "init_color_swatch_window failed\n");
+    return 1;
+  }
+
+  ChangeWindowBox(csw->window, 40, 30, csw->window->Width, csw->window->Height);
+  host_defer_window_moves = TRUE;
+  host_window_moves = 0;
+
+  mouse_x = csw->window->LeftEdge + GRAB_X;
+  mouse_y = csw->window->TopEdge + GRAB_Y;
+  host_move_mouse(mouse_x, mouse_y);
+  host_queue_message(IDCMP_MOUSEBUTTONS, SELECTDOWN);
+  handle_events(csw);
+
+  for (wakeup = 0; wakeup < WAKEUPS; wakeup++)
+  {
+    for (i = 0; i < MOVES_PER_WAKEUP / 2; i++) move_mouse(2, 1);
+    handle_events(csw);
+
+    // Intuition is still busy with that move while the mouse keeps going
+    for (i = 0; i < MOVES_PER_WAKEUP / 2; i++) move_mouse(2, 1);
+    host_apply_window_moves();
+    handle_events(csw);
+    host_apply_window_moves();
+    check_position(csw);
+    moves_sent += MOVES_PER_WAKEUP;
+  }
+
+  host_queue_message(IDCMP_MOUSEBUTTONS, SELECTUP);
+  handle_events(csw);
+  host_apply_window_moves();
+  check_position(csw);
+
+  printf("mouse moves %lu, ChangeWindowBox calls %lu, window at %d,%d for pointer %d,%d, "
+         "largest offset %ld\n", moves_sent, host_window_moves, csw->window->LeftEdge,
+         csw->window->TopEdge, mouse_x, mouse_y, worst);
+
+  cleanup_color_swatch_window(csw);
+  return worst ? 1 : 0;
+}
@@ -0,0 +1,571 @@
+/**
+ * Fixed-point sRGB to CIE L*a*b* tables
+ * Generated by gen_lab_tables.c - do not edit. All values are Q15.
+ */
+
+#ifndef LAB_TABLES_H
+#define LAB_TABLES_H
+
+#define LAB_F_BITS 12 ///< Index bits of lab_f_table
+
+/** Linear light of each 8-bit sRGB channel value */
+static const UWORD srgb_to_linear[256] = {
+      0,    10,    20,    30,    40,    50,    60,    70,
+     80,    90,    99,   110,   120,   132,   144,   157,
+    170,   184,   198,   213,   229,   246,   263,   281,
+    299,   319,   338,   359,   381,   403,   425,   449,
+    473,   498,   524,   551,   578,   606,   635,   665,
+    695,   727,   759,   792,   825,   860,   895,   931,
+    969,  1006,  1045,  1085,  1125,  1167,  1209,  1252,
+   1296,  1341,  1386,  1433,  1481,  1529,  1578,  1629,
+   1680,  1732,  1785,  1839,  1894,  1950,  2007,  2065,
+   2123,  2183,  2244,  2306,  2368,  2432,  2496,  2562,
+   2629,  2696,  2765,  2834,  2905,  2977,  3049,  3123,
+   3198,  3273,  3350,  3428,  3507,  3587,  3668,  3750,
+   3833,  3917,  4002,  4089,  4176,  4264,  4354,  4444,
+   4536,  4629,  4723,  4818,  4914,  5011,  5109,  5209,
+   5309,  5411,  5514,  5618,  5723,  5829,  5936,  6045,
+   6155,  6265,  6377,  6490,  6605,  6720,  6837,  6954,
+   7073,  7193,  7315,  7437,  7561,  7686,  7812,  7939,
+   8068,  8197,  8328,  8460,  8593,  8728,  8864,  9001,
+   9139,  9278,  9419,  9561,  9704,  9848,  9994, 10141,
+  10289, 10438, 10589, 10741, 10894, 11048, 11204, 11361,
+  11519, 11679, 11839, 12001, 12165, 12329, 12495, 12663,
+  12831, 13001, 13172, 13344, 13518, 13693, 13870, 14047,
+  14226, 14407, 14588, 14771, 14956, 15141, 15328, 15517,
+  15706, 15897, 16090, 16284, 16479, 16675, 16873, 17072,
+  17273, 17474, 17678, 17882, 18088, 18296, 18504, 18715,
+  18926, 19139, 19353, 19569, 19786, 20005, 20225, 20446,
+  20669, 20893, 21118, 21345, 21574, 21803, 22035, 22267,
+  22501, 22737, 22974, 23212, 23452, 23693, 23936, 24180,
+  24425, 24672, 24921, 25171, 25422, 25675, 25929, 26185,
+  26442, 26701, 26961, 27223, 27486, 27750, 28016, 28284,
+  28553, 28823, 29095, 29369, 29644, 29920, 30198, 30478,
+  30759, 31041, 31325, 31611, 31898, 32186, 32476, 32768
+};
+
+/** Linear sRGB to XYZ, each row divided by the D65 white point */
+static const UWORD linear_to_xyz[3][3] = {
+  { 14220, 12328,  6221 },
+  {  6969, 23434,  2365 },
+  {   582,  3587, 28599 }
+};
+
+/** f(t) for t = index / 4096 */
+static const UWORD lab_f_table[4097] = {
+   4520,  4582,  4644,  4707,  4769,  4831,  4894,  4956,
+   5018,  5080,  5143,  5205,  5267,  5330,  5392,  5454,
+   5516,  5579,  5641,  5703,  5766,  5828,  5890,  5953,
+   6015,  6077,  6139,  6202,  6264,  6326,  6389,  6451,
+   6513,  6576,  6638,  6700,  6762,  6824,  6885,  6945,
+   7004,  7062,  7119,  7175,  7230,  7285,  7338,  7391,
+   7443,  7494,  7545,  7595,  7644,  7693,  7741,  7788,
+   7835,  7882,  7928,  7973,  8018,  8062,  8106,  8149,
+   8192,  8234,  8276,  8318,  8359,  8400,  8440,  8480,
+   8520,  8559,  8598,  8637,  8675,  8713,  8750,  8788,
+   8825,  8861,  8897,  8934,  8969,  9005,  9040,  9075,
+   9109,  9144,  9178,  9212,  9245,  9279,  9312,  9345,
+   9377,  9410,  9442,  9474,  9506,  9538,  9569,  9600,
+   9631,  9662,  9692,  9723,  9753,  9783,  9813,  9842,
+   9872,  9901,  9930,  9959,  9988, 10017, 10045, 10073,
+  10102, 10130, 10157, 10185, 10213, 10240, 10267, 10294,
+  10321, 10348, 10375, 10401, 10428, 10454, 10480, 10506,
+  10532, 10558, 10583, 10609, 10634, 10659, 10685, 10710,
+  10735, 10759, 10784, 10809, 10833, 10857, 10882, 10906,
+  10930, 10954, 10978, 11001, 11025, 11048, 11072, 11095,
+  11118, 11141, 11164, 11187, 11210, 11233, 11256, 11278,
+  11301, 11323, 11345, 11367, 11390, 11412, 11434, 11455,
+  11477, 11499, 11520, 11542, 11563, 11585, 11606, 11627,
+  11648, 11670, 11691, 11711, 11732, 11753, 11774, 11794,
+  11815, 11835, 11856, 11876, 11896, 11917, 11937, 11957,
+  11977, 11997, 12017, 12036, 12056, 12076, 12095, 12115,
+  12134, 12154, 12173, 12192, 12212, 12231, 12250, 12269,
+  12288, 12307, 12326, 12345, 12363, 12382, 12401, 12419,
+  12438, 12456, 12475, 12493, 12511, 12530, 12548, 12566,
+  12584, 12602, 12620, 12638, 12656, 12674, 12692, 12710,
+  12727, 12745, 12762, 12780, 12798, 12815, 12832, 12850,
+  12867, 12884, 12902, 12919, 12936, 12953, 12970, 12987,
+  13004, 13021, 13038, 13055, 13071, 13088, 13105, 13121,
+  13138, 13155, 13171, 13188, 13204, 13220, 13237, 13253,
+  13269, 13286, 13302, 13318, 13334, 13350, 13366, 13382,
+  13398, 13414, 13430, 13446, 13462, 13478, 13493, 13509,
+  13525, 13540, 13556, 13571, 13587, 13603, 13618, 13633,
+  13649, 13664, 13679, 13695, 13710, 13725, 13740, 13756,
+  13771, 13786, 13801, 13816, 13831, 13846, 13861, 13876,
+  13890, 13905, 13920, 13935, 13950, 13964, 13979, 13994,
+  14008, 14023, 14037, 14052, 14066, 14081, 14095, 14110,
+  14124, 14138, 14153, 14167, 14181, 14195, 14209, 14224,
+  14238, 14252, 14266, 14280, 14294, 14308, 14322, 14336,
+  14350, 14364, 14378, 14392, 14405, 14419, 14433, 14447,
+  14460, 14474, 14488, 14501, 14515, 14528, 14542, 14556,
+  14569, 14583, 14596, 14609, 14623, 14636, 14650, 14663,
+  14676, 14689, 14703, 14716, 14729, 14742, 14755, 14769,
+  14782, 14795, 14808, 14821, 14834, 14847, 14860, 14873,
+  14886, 14899, 14912, 14925, 14937, 14950, 14963, 14976,
+  14989, 15001, 15014, 15027, 15039, 15052, 15065, 15077,
+  15090, 15102, 15115, 15127, 15140, 15152, 15165, 15177,
+  15190, 15202, 15215, 15227, 15239, 15252, 15264, 15276,
+  15288, 15301, 15313, 15325, 15337, 15349, 15362, 15374,
+  15386, 15398, 15410, 15422, 15434, 15446, 15458, 15470,
+  15482, 15494, 15506, 15518, 15530, 15541, 15553, 15565,
+  15577, 15589, 15600, 15612, 15624, 15636, 15647, 15659,
+  15671, 15682, 15694, 15706, 15717, 15729, 15740, 15752,
+  15763, 15775, 15786, 15798, 15809, 15821, 15832, 15844,
+  15855, 15866, 15878, 15889, 15901, 15912, 15923, 15934,
+  15946, 15957, 15968, 15979, 15991, 16002, 16013, 16024,
+  16035, 16046, 16058, 16069, 16080, 16091, 16102, 16113,
+  16124, 16135, 16146, 16157, 16168, 16179, 16190, 16201,
+  16212, 16222, 16233, 16244, 16255, 16266, 16277, 16287,
+  16298, 16309, 16320, 16330, 16341, 16352, 16363, 16373,
+  16384, 16395, 16405, 16416, 16427, 16437, 16448, 16458,
+  16469, 16479, 16490, 16501, 16511, 16522, 16532, 16542,
+  16553, 16563, 16574, 16584, 16595, 16605, 16615, 16626,
+  16636, 16646, 16657, 16667, 16677, 16688, 16698, 16708,
+  16718, 16729, 16739, 16749, 16759, 16770, 16780, 16790,
+  16800, 16810, 16820, 16830, 16840, 16851, 16861, 16871,
+  16881, 16891, 16901, 16911, 16921, 16931, 16941, 16951,
+  16961, 16971, 16981, 16991, 17001, 17010, 17020, 17030,
+  17040, 17050, 17060, 17070, 17079, 17089, 17099, 17109,
+  17119, 17128, 17138, 17148, 17158, 17167, 17177, 17187,
+  17196, 17206, 17216, 17225, 17235, 17245, 17254, 17264,
+  17274, 17283, 17293, 17302, 17312, 17321, 17331, 17340,
+  17350, 17359, 17369, 17378, 17388, 17397, 17407, 17416,
+  17426, 17435, 17445, 17454, 17463, 17473, 17482, 17491,
+  17501, 17510, 17519, 17529, 17538, 17547, 17557, 17566,
+  17575, 17585, 17594, 17603, 17612, 17622, 17631, 17640,
+  17649, 17658, 17667, 17677, 17686, 17695, 17704, 17713,
+  17722, 17731, 17741, 17750, 17759, 17768, 17777, 17786,
+  17795, 17804, 17813, 17822, 17831, 17840, 17849, 17858,
+  17867, 17876, 17885, 17894, 17903, 17912, 17921, 17930,
+  17939, 17947, 17956, 17965, 17974, 17983, 17992, 18001,
+  18009, 18018, 18027, 18036, 18045, 18053, 18062, 18071,
+  18080, 18089, 18097, 18106, 18115, 18123, 18132, 18141,
+  18150, 18158, 18167, 18176, 18184, 18193, 18202, 18210,
+  18219, 18227, 18236, 18245, 18253, 18262, 18270, 18279,
+  18288, 18296, 18305, 18313, 18322, 18330, 18339, 18347,
+  18356, 18364, 18373, 18381, 18390, 18398, 18407, 18415,
+  18424, 18432, 18440, 18449, 18457, 18466, 18474, 18482,
+  18491, 18499, 18508, 18516, 18524, 18533, 18541, 18549,
+  18558, 18566, 18574, 18582, 18591, 18599, 18607, 18616,
+  18624, 18632, 18640, 18649, 18657, 18665, 18673, 18681,
+  18690, 18698, 18706, 18714, 18722, 18731, 18739, 18747,
+  18755, 18763, 18771, 18779, 18788, 18796, 18804, 18812,
+  18820, 18828, 18836, 18844, 18852, 18860, 18868, 18876,
+  18884, 18892, 18900, 18908, 18916, 18924, 18932, 18940,
+  18948, 18956, 18964, 18972, 18980, 18988, 18996, 19004,
+  19012, 19020, 19028, 19036, 19044, 19051, 19059, 19067,
+  19075, 19083, 19091, 19099, 19107, 19114, 19122, 19130,
+  19138, 19146, 19153, 19161, 19169, 19177, 19185, 19192,
+  19200, 19208, 19216, 19223, 19231, 19239, 19247, 19254,
+  19262, 19270, 19278, 19285, 19293, 19301, 19308, 19316,
+  19324, 19331, 19339, 19347, 19354, 19362, 19370, 19377,
+  19385, 19392, 19400, 19408, 19415, 19423, 19430, 19438,
+  19446, 19453, 19461, 19468, 19476, 19483, 19491, 19498,
+  19506, 19514, 19521, 19529, 19536, 19544, 19551, 19559,
+  19566, 19573, 19581, 19588, 19596, 19603, 19611, 19618,
+  19626, 19633, 19641, 19648, 19655, 19663, 19670, 19678,
+  19685, 19692, 19700, 19707, 19714, 19722, 19729, 19737,
+  19744, 19751, 19759, 19766, 19773, 19781, 19788, 19795,
+  19802, 19810, 19817, 19824, 19832, 19839, 19846, 19853,
+  19861, 19868, 19875, 19882, 19890, 19897, 19904, 19911,
+  19919, 19926, 19933, 19940, 19947, 19955, 19962, 19969,
+  19976, 19983, 19991, 19998, 20005, 20012, 20019, 20026,
+  20033, 20041, 20048, 20055, 20062, 20069, 20076, 20083,
+  20090, 20097, 20105, 20112, 20119, 20126, 20133, 20140,
+  20147, 20154, 20161, 20168, 20175, 20182, 20189, 20196,
+  20203, 20210, 20217, 20224, 20231, 20238, 20245, 20252,
+  20259, 20266, 20273, 20280, 20287, 20294, 20301, 20308,
+  20315, 20322, 20329, 20336, 20343, 20349, 20356, 20363,
+  20370, 20377, 20384, 20391, 20398, 20405, 20412, 20418,
+  20425, 20432, 20439, 20446, 20453, 20459, 20466, 20473,
+  20480, 20487, 20494, 20500, 20507, 20514, 20521, 20528,
+  20534, 20541, 20548, 20555, 20562, 20568, 20575, 20582,
+  20589, 20595, 20602, 20609, 20616, 20622, 20629, 20636,
+  20643, 20649, 20656, 20663, 20669, 20676, 20683, 20689,
+  20696, 20703, 20710, 20716, 20723, 20730, 20736, 20743,
+  20750, 20756, 20763, 20769, 20776, 20783, 20789, 20796,
+  20803, 20809, 20816, 20822, 20829, 20836, 20842, 20849,
+  20855, 20862, 20869, 20875, 20882, 20888, 20895, 20901,
+  20908, 20914, 20921, 20928, 20934, 20941, 20947, 20954,
+  20960, 20967, 20973, 20980, 20986, 20993, 20999, 21006,
+  21012, 21019, 21025, 21032, 21038, 21045, 21051, 21057,
+  21064, 21070, 21077, 21083, 21090, 21096, 21103, 21109,
+  21115, 21122, 21128, 21135, 21141, 21148, 21154, 21160,
+  21167, 21173, 21179, 21186, 21192, 21199, 21205, 21211,
+  21218, 21224, 21230, 21237, 21243, 21249, 21256, 21262,
+  21268, 21275, 21281, 21287, 21294, 21300, 21306, 21313,
+  21319, 21325, 21332, 21338, 21344, 21350, 21357, 21363,
+  21369, 21376, 21382, 21388, 21394, 21401, 21407, 21413,
+  21419, 21426, 21432, 21438, 21444, 21450, 21457, 21463,
+  21469, 21475, 21482, 21488, 21494, 21500, 21506, 21513,
+  21519, 21525, 21531, 21537, 21543, 21550, 21556, 21562,
+  21568, 21574, 21580, 21587, 21593, 21599, 21605, 21611,
+  21617, 21623, 21629, 21636, 21642, 21648, 21654, 21660,
+  21666, 21672, 21678, 21684, 21690, 21697, 21703, 21709,
+  21715, 21721, 21727, 21733, 21739, 21745, 21751, 21757,
+  21763, 21769, 21775, 21781, 21787, 21793, 21799, 21805,
+  21812, 21818, 21824, 21830, 21836, 21842, 21848, 21854,
+  21860, 21866, 21872, 21878, 21883, 21889, 21895, 21901,
+  21907, 21913, 21919, 21925, 21931, 21937, 21943, 21949,
+  21955, 21961, 21967, 21973, 21979, 21985, 21991, 21997,
+  22002, 22008, 22014, 22020, 22026, 22032, 22038, 22044,
+  22050, 22056, 22061, 22067, 22073, 22079, 22085, 22091,
+  22097, 22103, 22108, 22114, 22120, 22126, 22132, 22138,
+  22143, 22149, 22155, 22161, 22167, 22173, 22178, 22184,
+  22190, 22196, 22202, 22208, 22213, 22219, 22225, 22231,
+  22237, 22242, 22248, 22254, 22260, 22265, 22271, 22277,
+  22283, 22289, 22294, 22300, 22306, 22312, 22317, 22323,
+  22329, 22335, 22340, 22346, 22352, 22357, 22363, 22369,
+  22375, 22380, 22386, 22392, 22397, 22403, 22409, 22415,
+  22420, 22426, 22432, 22437, 22443, 22449, 22454, 22460,
+  22466, 22471, 22477, 22483, 22488, 22494, 22500, 22505,
+  22511, 22517, 22522, 22528, 22534, 22539, 22545, 22551,
+  22556, 22562, 22567, 22573, 22579, 22584, 22590, 22596,
+  22601, 22607, 22612, 22618, 22624, 22629, 22635, 22640,
+  22646, 22651, 22657, 22663, 22668, 22674, 22679, 22685,
+  22690, 22696, 22702, 22707, 22713, 22718, 22724, 22729,
+  22735, 22740, 22746, 22751, 22757, 22763, 22768, 22774,
+  22779, 22785, 22790, 22796, 22801, 22807, 22812, 22818,
+  22823, 22829, 22834, 22840, 22845, 22851, 22856, 22862,
+  22867, 22873, 22878, 22883, 22889, 22894, 22900, 22905,
+  22911, 22916, 22922, 22927, 22933, 22938, 22943, 22949,
+  22954, 22960, 22965, 22971, 22976, 22981, 22987, 22992,
+  22998, 23003, 23009, 23014, 23019, 23025, 23030, 23036,
+  23041, 23046, 23052, 23057, 23062, 23068, 23073, 23079,
+  23084, 23089, 23095, 23100, 23105, 23111, 23116, 23122,
+  23127, 23132, 23138, 23143, 23148, 23154, 23159, 23164,
+  23170, 23175, 23180, 23186, 23191, 23196, 23202, 23207,
+  23212, 23218, 23223, 23228, 23233, 23239, 23244, 23249,
+  23255, 23260, 23265, 23271, 23276, 23281, 23286, 23292,
+  23297, 23302, 23308, 23313, 23318, 23323, 23329, 23334,
+  23339, 23344, 23350, 23355, 23360, 23365, 23371, 23376,
+  23381, 23386, 23392, 23397, 23402, 23407, 23412, 23418,
+  23423, 23428, 23433, 23439, 23444, 23449, 23454, 23459,
+  23465, 23470, 23475, 23480, 23485, 23491, 23496, 23501,
+  23506, 23511, 23516, 23522, 23527, 23532, 23537, 23542,
+  23547, 23553, 23558, 23563, 23568, 23573, 23578, 23584,
+  23589, 23594, 23599, 23604, 23609, 23614, 23620, 23625,
+  23630, 23635, 23640, 23645, 23650, 23655, 23661, 23666,
+  23671, 23676, 23681, 23686, 23691, 23696, 23701, 23706,
+  23712, 23717, 23722, 23727, 23732, 23737, 23742, 23747,
+  23752, 23757, 23762, 23767, 23773, 23778, 23783, 23788,
+  23793, 23798, 23803, 23808, 23813, 23818, 23823, 23828,
+  23833, 23838, 23843, 23848, 23853, 23858, 23863, 23868,
+  23873, 23878, 23883, 23889, 23894, 23899, 23904, 23909,
+  23914, 23919, 23924, 23929, 23934, 23939, 23944, 23949,
+  23954, 23959, 23964, 23969, 23973, 23978, 23983, 23988,
+  23993, 23998, 24003, 24008, 24013, 24018, 24023, 24028,
+  24033, 24038, 24043, 24048, 24053, 24058, 24063, 24068,
+  24073, 24078, 24083, 24088, 24092, 24097, 24102, 24107,
+  24112, 24117, 24122, 24127, 24132, 24137, 24142, 24147,
+  24152, 24156, 24161, 24166, 24171, 24176, 24181, 24186,
+  24191, 24196, 24201, 24205, 24210, 24215, 24220, 24225,
+  24230, 24235, 24240, 24244, 24249, 24254, 24259, 24264,
+  24269, 24274, 24278, 24283, 24288, 24293, 24298, 24303,
+  24308, 24312, 24317, 24322, 24327, 24332, 24337, 24341,
+  24346, 24351, 24356, 24361, 24366, 24370, 24375, 24380,
+  24385, 24390, 24395, 24399, 24404, 24409, 24414, 24419,
+  24423, 24428, 24433, 24438, 24443, 24447, 24452, 24457,
+  24462, 24466, 24471, 24476, 24481, 24486, 24490, 24495,
+  24500, 24505, 24509, 24514, 24519, 24524, 24529, 24533,
+  24538, 24543, 24548, 24552, 24557, 24562, 24567, 24571,
+  24576, 24581, 24585, 24590, 24595, 24600, 24604, 24609,
+  24614, 24619, 24623, 24628, 24633, 24637, 24642, 24647,
+  24652, 24656, 24661, 24666, 24670, 24675, 24680, 24685,
+  24689, 24694, 24699, 24703, 24708, 24713, 24717, 24722,
+  24727, 24731, 24736, 24741, 24745, 24750, 24755, 24760,
+  24764, 24769, 24774, 24778, 24783, 24788, 24792, 24797,
+  24801, 24806, 24811, 24815, 24820, 24825, 24829, 24834,
+  24839, 24843, 24848, 24853, 24857, 24862, 24866, 24871,
+  24876, 24880, 24885, 24890, 24894, 24899, 24903, 24908,
+  24913, 24917, 24922, 24927, 24931, 24936, 24940, 24945,
+  24950, 24954, 24959, 24963, 24968, 24973, 24977, 24982,
+  24986, 24991, 24995, 25000, 25005, 25009, 25014, 25018,
+  25023, 25028, 25032, 25037, 25041, 25046, 25050, 25055,
+  25059, 25064, 25069, 25073, 25078, 25082, 25087, 25091,
+  25096, 25100, 25105, 25110, 25114, 25119, 25123, 25128,
+  25132, 25137, 25141, 25146, 25150, 25155, 25159, 25164,
+  25168, 25173, 25177, 25182, 25186, 25191, 25196, 25200,
+  25205, 25209, 25214, 25218, 25223, 25227, 25232, 25236,
+  25241, 25245, 25250, 25254, 25259, 25263, 25267, 25272,
+  25276, 25281, 25285, 25290, 25294, 25299, 25303, 25308,
+  25312, 25317, 25321, 25326, 25330, 25335, 25339, 25343,
+  25348, 25352, 25357, 25361, 25366, 25370, 25375, 25379,
+  25384, 25388, 25392, 25397, 25401, 25406, 25410, 25415,
+  25419, 25423, 25428, 25432, 25437, 25441, 25446, 25450,
+  25454, 25459, 25463, 25468, 25472, 25477, 25481, 25485,
+  25490, 25494, 25499, 25503, 25507, 25512, 25516, 25521,
+  25525, 25529, 25534, 25538, 25543, 25547, 25551, 25556,
+  25560, 25564, 25569, 25573, 25578, 25582, 25586, 25591,
+  25595, 25599, 25604, 25608, 25613, 25617, 25621, 25626,
+  25630, 25634, 25639, 25643, 25647, 25652, 25656, 25660,
+  25665, 25669, 25674, 25678, 25682, 25687, 25691, 25695,
+  25700, 25704, 25708, 25713, 25717, 25721, 25726, 25730,
+  25734, 25739, 25743, 25747, 25751, 25756, 25760, 25764,
+  25769, 25773, 25777, 25782, 25786, 25790, 25795, 25799,
+  25803, 25807, 25812, 25816, 25820, 25825, 25829, 25833,
+  25838, 25842, 25846, 25850, 25855, 25859, 25863, 25868,
+  25872, 25876, 25880, 25885, 25889, 25893, 25897, 25902,
+  25906, 25910, 25915, 25919, 25923, 25927, 25932, 25936,
+  25940, 25944, 25949, 25953, 25957, 25961, 25966, 25970,
+  25974, 25978, 25983, 25987, 25991, 25995, 26000, 26004,
+  26008, 26012, 26016, 26021, 26025, 26029, 26033, 26038,
+  26042, 26046, 26050, 26054, 26059, 26063, 26067, 26071,
+  26076, 26080, 26084, 26088, 26092, 26097, 26101, 26105,
+  26109, 26113, 26118, 26122, 26126, 26130, 26134, 26139,
+  26143, 26147, 26151, 26155, 26159, 26164, 26168, 26172,
+  26176, 26180, 26185, 26189, 26193, 26197, 26201, 26205,
+  26210, 26214, 26218, 26222, 26226, 26230, 26235, 26239,
+  26243, 26247, 26251, 26255, 26260, 26264, 26268, 26272,
+  26276, 26280, 26284, 26289, 26293, 26297, 26301, 26305,
+  26309, 26313, 26318, 26322, 26326, 26330, 26334, 26338,
+  26342, 26346, 26351, 26355, 26359, 26363, 26367, 26371,
+  26375, 26379, 26384, 26388, 26392, 26396, 26400, 26404,
+  26408, 26412, 26416, 26420, 26425, 26429, 26433, 26437,
+  26441, 26445, 26449, 26453, 26457, 26461, 26466, 26470,
+  26474, 26478, 26482, 26486, 26490, 26494, 26498, 26502,
+  26506, 26510, 26514, 26519, 26523, 26527, 26531, 26535,
+  26539, 26543, 26547, 26551, 26555, 26559, 26563, 26567,
+  26571, 26575, 26579, 26584, 26588, 26592, 26596, 26600,
+  26604, 26608, 26612, 26616, 26620, 26624, 26628, 26632,
+  26636, 26640, 26644, 26648, 26652, 26656, 26660, 26664,
+  26668, 26672, 26676, 26680, 26684, 26688, 26692, 26697,
+  26701, 26705, 26709, 26713, 26717, 26721, 26725, 26729,
+  26733, 26737, 26741, 26745, 26749, 26753, 26757, 26761,
+  26765, 26769, 26773, 26777, 26781, 26785, 26789, 26793,
+  26797, 26801, 26805, 26809, 26813, 26816, 26820, 26824,
+  26828, 26832, 26836, 26840, 26844, 26848, 26852, 26856,
+  26860, 26864, 26868, 26872, 26876, 26880, 26884, 26888,
+  26892, 26896, 26900, 26904, 26908, 26912, 26916, 26920,
+  26924, 26928, 26931, 26935, 26939, 26943, 26947, 26951,
+  26955, 26959, 26963, 26967, 26971, 26975, 26979, 26983,
+  26987, 26991, 26994, 26998, 27002, 27006, 27010, 27014,
+  27018, 27022, 27026, 27030, 27034, 27038, 27042, 27045,
+  27049, 27053, 27057, 27061, 27065, 27069, 27073, 27077,
+  27081, 27085, 27088, 27092, 27096, 27100, 27104, 27108,
+  27112, 27116, 27120, 27124, 27127, 27131, 27135, 27139,
+  27143, 27147, 27151, 27155, 27159, 27162, 27166, 27170,
+  27174, 27178, 27182, 27186, 27190, 27193, 27197, 27201,
+  27205, 27209, 27213, 27217, 27220, 27224, 27228, 27232,
+  27236, 27240, 27244, 27248, 27251, 27255, 27259, 27263,
+  27267, 27271, 27274, 27278, 27282, 27286, 27290, 27294,
+  27298, 27301, 27305, 27309, 27313, 27317, 27321, 27324,
+  27328, 27332, 27336, 27340, 27344, 27347, 27351, 27355,
+  27359, 27363, 27367, 27370, 27374, 27378, 27382, 27386,
+  27389, 27393, 27397, 27401, 27405, 27409, 27412, 27416,
+  27420, 27424, 27428, 27431, 27435, 27439, 27443, 27447,
+  27450, 27454, 27458, 27462, 27466, 27469, 27473, 27477,
+  27481, 27485, 27488, 27492, 27496, 27500, 27504, 27507,
+  27511, 27515, 27519, 27522, 27526, 27530, 27534, 27538,
+  27541, 27545, 27549, 27553, 27556, 27560, 27564, 27568,
+  27571, 27575, 27579, 27583, 27587, 27590, 27594, 27598,
+  27602, 27605, 27609, 27613, 27617, 27620, 27624, 27628,
+  27632, 27635, 27639, 27643, 27647, 27650, 27654, 27658,
+  27662, 27665, 27669, 27673, 27677, 27680, 27684, 27688,
+  27691, 27695, 27699, 27703, 27706, 27710, 27714, 27718,
+  27721, 27725, 27729, 27732, 27736, 27740, 27744, 27747,
+  27751, 27755, 27759, 27762, 27766, 27770, 27773, 27777,
+  27781, 27785, 27788, 27792, 27796, 27799, 27803, 27807,
+  27810, 27814, 27818, 27822, 27825, 27829, 27833, 27836,
+  27840, 27844, 27847, 27851, 27855, 27858, 27862, 27866,
+  27870, 27873, 27877, 27881, 27884, 27888, 27892, 27895,
+  27899, 27903, 27906, 27910, 27914, 27917, 27921, 27925,
+  27928, 27932, 27936, 27939, 27943, 27947, 27950, 27954,
+  27958, 27961, 27965, 27969, 27972, 27976, 27980, 27983,
+  27987, 27991, 27994, 27998, 28002, 28005, 28009, 28013,
+  28016, 28020, 28024, 28027, 28031, 28034, 28038, 28042,
+  28045, 28049, 28053, 28056, 28060, 28064, 28067, 28071,
+  28074, 28078, 28082, 28085, 28089, 28093, 28096, 28100,
+  28104, 28107, 28111, 28114, 28118, 28122, 28125, 28129,
+  28132, 28136, 28140, 28143, 28147, 28151, 28154, 28158,
+  28161, 28165, 28169, 28172, 28176, 28179, 28183, 28187,
+  28190, 28194, 28197, 28201, 28205, 28208, 28212, 28215,
+  28219, 28223, 28226, 28230, 28233, 28237, 28241, 28244,
+  28248, 28251, 28255, 28259, 28262, 28266, 28269, 28273,
+  28276, 28280, 28284, 28287, 28291, 28294, 28298, 28302,
+  28305, 28309, 28312, 28316, 28319, 28323, 28327, 28330,
+  28334, 28337, 28341, 28344, 28348, 28351, 28355, 28359,
+  28362, 28366, 28369, 28373, 28376, 28380, 28384, 28387,
+  28391, 28394, 28398, 28401, 28405, 28408, 28412, 28415,
+  28419, 28423, 28426, 28430, 28433, 28437, 28440, 28444,
+  28447, 28451, 28454, 28458, 28461, 28465, 28469, 28472,
+  28476, 28479, 28483, 28486, 28490, 28493, 28497, 28500,
+  28504, 28507, 28511, 28514, 28518, 28521, 28525, 28528,
+  28532, 28536, 28539, 28543, 28546, 28550, 28553, 28557,
+  28560, 28564, 28567, 28571, 28574, 28578, 28581, 28585,
+  28588, 28592, 28595, 28599, 28602, 28606, 28609, 28613,
+  28616, 28620, 28623, 28627, 28630, 28634, 28637, 28641,
+  28644, 28648, 28651, 28655, 28658, 28662, 28665, 28669,
+  28672, 28675, 28679, 28682, 28686, 28689, 28693, 28696,
+  28700, 28703, 28707, 28710, 28714, 28717, 28721, 28724,
+  28728, 28731, 28735, 28738, 28741, 28745, 28748, 28752,
+  28755, 28759, 28762, 28766, 28769, 28773, 28776, 28780,
+  28783, 28786, 28790, 28793, 28797, 28800, 28804, 28807,
+  28811, 28814, 28818, 28821, 28824, 28828, 28831, 28835,
+  28838, 28842, 28845, 28849, 28852, 28855, 28859, 28862,
+  28866, 28869, 28873, 28876, 28879, 28883, 28886, 28890,
+  28893, 28897, 28900, 28903, 28907, 28910, 28914, 28917,
+  28921, 28924, 28927, 28931, 28934, 28938, 28941, 28945,
+  28948, 28951, 28955, 28958, 28962, 28965, 28968, 28972,
+  28975, 28979, 28982, 28986, 28989, 28992, 28996, 28999,
+  29003, 29006, 29009, 29013, 29016, 29020, 29023, 29026,
+  29030, 29033, 29037, 29040, 29043, 29047, 29050, 29054,
+  29057, 29060, 29064, 29067, 29070, 29074, 29077, 29081,
+  29084, 29087, 29091, 29094, 29098, 29101, 29104, 29108,
+  29111, 29114, 29118, 29121, 29125, 29128, 29131, 29135,
+  29138, 29141, 29145, 29148, 29152, 29155, 29158, 29162,
+  29165, 29168, 29172, 29175, 29178, 29182, 29185, 29189,
+  29192, 29195, 29199, 29202, 29205, 29209, 29212, 29215,
+  29219, 29222, 29225, 29229, 29232, 29236, 29239, 29242,
+  29246, 29249, 29252, 29256, 29259, 29262, 29266, 29269,
+  29272, 29276, 29279, 29282, 29286, 29289, 29292, 29296,
+  29299, 29302, 29306, 29309, 29312, 29316, 29319, 29322,
+  29326, 29329, 29332, 29336, 29339, 29342, 29346, 29349,
+  29352, 29356, 29359, 29362, 29366, 29369, 29372, 29376,
+  29379, 29382, 29386, 29389, 29392, 29395, 29399, 29402,
+  29405, 29409, 29412, 29415, 29419, 29422, 29425, 29429,
+  29432, 29435, 29438, 29442, 29445, 29448, 29452, 29455,
+  29458, 29462, 29465, 29468, 29471, 29475, 29478, 29481,
+  29485, 29488, 29491, 29495, 29498, 29501, 29504, 29508,
+  29511, 29514, 29518, 29521, 29524, 29527, 29531, 29534,
+  29537, 29541, 29544, 29547, 29550, 29554, 29557, 29560,
+  29564, 29567, 29570, 29573, 29577, 29580, 29583, 29586,
+  29590, 29593, 29596, 29599, 29603, 29606, 29609, 29613,
+  29616, 29619, 29622, 29626, 29629, 29632, 29635, 29639,
+  29642, 29645, 29648, 29652, 29655, 29658, 29661, 29665,
+  29668, 29671, 29674, 29678, 29681, 29684, 29687, 29691,
+  29694, 29697, 29700, 29704, 29707, 29710, 29713, 29717,
+  29720, 29723, 29726, 29730, 29733, 29736, 29739, 29743,
+  29746, 29749, 29752, 29756, 29759, 29762, 29765, 29768,
+  29772, 29775, 29778, 29781, 29785, 29788, 29791, 29794,
+  29798, 29801, 29804, 29807, 29810, 29814, 29817, 29820,
+  29823, 29827, 29830, 29833, 29836, 29839, 29843, 29846,
+  29849, 29852, 29855, 29859, 29862, 29865, 29868, 29872,
+  29875, 29878, 29881, 29884, 29888, 29891, 29894, 29897,
+  29900, 29904, 29907, 29910, 29913, 29916, 29920, 29923,
+  29926, 29929, 29932, 29936, 29939, 29942, 29945, 29948,
+  29952, 29955, 29958, 29961, 29964, 29967, 29971, 29974,
+  29977, 29980, 29983, 29987, 29990, 29993, 29996, 29999,
+  30003, 30006, 30009, 30012, 30015, 30018, 30022, 30025,
+  30028, 30031, 30034, 30037, 30041, 30044, 30047, 30050,
+  30053, 30056, 30060, 30063, 30066, 30069, 30072, 30075,
+  30079, 30082, 30085, 30088, 30091, 30094, 30098, 30101,
+  30104, 30107, 30110, 30113, 30117, 30120, 30123, 30126,
+  30129, 30132, 30136, 30139, 30142, 30145, 30148, 30151,
+  30154, 30158, 30161, 30164, 30167, 30170, 30173, 30176,
+  30180, 30183, 30186, 30189, 30192, 30195, 30198, 30202,
+  30205, 30208, 30211, 30214, 30217, 30220, 30224, 30227,
+  30230, 30233, 30236, 30239, 30242, 30245, 30249, 30252,
+  30255, 30258, 30261, 30264, 30267, 30270, 30274, 30277,
+  30280, 30283, 30286, 30289, 30292, 30295, 30299, 30302,
+  30305, 30308, 30311, 30314, 30317, 30320, 30324, 30327,
+  30330, 30333, 30336, 30339, 30342, 30345, 30348, 30352,
+  30355, 30358, 30361, 30364, 30367, 30370, 30373, 30376,
+  30379, 30383, 30386, 30389, 30392, 30395, 30398, 30401,
+  30404, 30407, 30410, 30414, 30417, 30420, 30423, 30426,
+  30429, 30432, 30435, 30438, 30441, 30444, 30448, 30451,
+  30454, 30457, 30460, 30463, 30466, 30469, 30472, 30475,
+  30478, 30481, 30485, 30488, 30491, 30494, 30497, 30500,
+  30503, 30506, 30509, 30512, 30515, 30518, 30522, 30525,
+  30528, 30531, 30534, 30537, 30540, 30543, 30546, 30549,
+  30552, 30555, 30558, 30561, 30564, 30568, 30571, 30574,
+  30577, 30580, 30583, 30586, 30589, 30592, 30595, 30598,
+  30601, 30604, 30607, 30610, 30613, 30616, 30620, 30623,
+  30626, 30629, 30632, 30635, 30638, 30641, 30644, 30647,
+  30650, 30653, 30656, 30659, 30662, 30665, 30668, 30671,
+  30674, 30677, 30681, 30684, 30687, 30690, 30693, 30696,
+  30699, 30702, 30705, 30708, 30711, 30714, 30717, 30720,
+  30723, 30726, 30729, 30732, 30735, 30738, 30741, 30744,
+  30747, 30750, 30753, 30756, 30759, 30762, 30765, 30768,
+  30771, 30775, 30778, 30781, 30784, 30787, 30790, 30793,
+  30796, 30799, 30802, 30805, 30808, 30811, 30814, 30817,
+  30820, 30823, 30826, 30829, 30832, 30835, 30838, 30841,
+  30844, 30847, 30850, 30853, 30856, 30859, 30862, 30865,
+  30868, 30871, 30874, 30877, 30880, 30883, 30886, 30889,
+  30892, 30895, 30898, 30901, 30904, 30907, 30910, 30913,
+  30916, 30919, 30922, 30925, 30928, 30931, 30934, 30937,
+  30940, 30943, 30946, 30949, 30952, 30955, 30958, 30961,
+  30964, 30967, 30970, 30973, 30976, 30979, 30982, 30985,
+  30988, 30991, 30994, 30997, 31000, 31003, 31006, 31009,
+  31012, 31015, 31017, 31020, 31023, 31026, 31029, 31032,
+  31035, 31038, 31041, 31044, 31047, 31050, 31053, 31056,
+  31059, 31062, 31065, 31068, 31071, 31074, 31077, 31080,
+  31083, 31086, 31089, 31092, 31095, 31098, 31101, 31104,
+  31107, 31109, 31112, 31115, 31118, 31121, 31124, 31127,
+  31130, 31133, 31136, 31139, 31142, 31145, 31148, 31151,
+  31154, 31157, 31160, 31163, 31166, 31169, 31171, 31174,
+  31177, 31180, 31183, 31186, 31189, 31192, 31195, 31198,
+  31201, 31204, 31207, 31210, 31213, 31216, 31219, 31221,
+  31224, 31227, 31230, 31233, 31236, 31239, 31242, 31245,
+  31248, 31251, 31254, 31257, 31260, 31263, 31265, 31268,
+  31271, 31274, 31277, 31280, 31283, 31286, 31289, 31292,
+  31295, 31298, 31301, 31304, 31306, 31309, 31312, 31315,
+  31318, 31321, 31324, 31327, 31330, 31333, 31336, 31339,
+  31341, 31344, 31347, 31350, 31353, 31356, 31359, 31362,
+  31365, 31368, 31371, 31373, 31376, 31379, 31382, 31385,
+  31388, 31391, 31394, 31397, 31400, 31403, 31405, 31408,
+  31411, 31414, 31417, 31420, 31423, 31426, 31429, 31432,
+  31434, 31437, 31440, 31443, 31446, 31449, 31452, 31455,
+  31458, 31461, 31463, 31466, 31469, 31472, 31475, 31478,
+  31481, 31484, 31487, 31489, 31492, 31495, 31498, 31501,
+  31504, 31507, 31510, 31513, 31515, 31518, 31521, 31524,
+  31527, 31530, 31533, 31536, 31538, 31541, 31544, 31547,
+  31550, 31553, 31556, 31559, 31561, 31564, 31567, 31570,
+  31573, 31576, 31579, 31582, 31584, 31587, 31590, 31593,
+  31596, 31599, 31602, 31605, 31607, 31610, 31613, 31616,
+  31619, 31622, 31625, 31627, 31630, 31633, 31636, 31639,
+  31642, 31645, 31647, 31650, 31653, 31656, 31659, 31662,
+  31665, 31667, 31670, 31673, 31676, 31679, 31682, 31685,
+  31687, 31690, 31693, 31696, 31699, 31702, 31705, 31707,
+  31710, 31713, 31716, 31719, 31722, 31724, 31727, 31730,
+  31733, 31736, 31739, 31742, 31744, 31747, 31750, 31753,
+  31756, 31759, 31761, 31764, 31767, 31770, 31773, 31776,
+  31778, 31781, 31784, 31787, 31790, 31793, 31795, 31798,
+  31801, 31804, 31807, 31810, 31812, 31815, 31818, 31821,
+  31824, 31827, 31829, 31832, 31835, 31838, 31841, 31843,
+  31846, 31849, 31852, 31855, 31858, 31860, 31863, 31866,
+  31869, 31872, 31875, 31877, 31880, 31883, 31886, 31889,
+  31891, 31894, 31897, 31900, 31903, 31905, 31908, 31911,
+  31914, 31917, 31920, 31922, 31925, 31928, 31931, 31934,
+  31936, 31939, 31942, 31945, 31948, 31950, 31953, 31956,
+  31959, 31962, 31964, 31967, 31970, 31973, 31976, 31978,
+  31981, 31984, 31987, 31990, 31992, 31995, 31998, 32001,
+  32004, 32006, 32009, 32012, 32015, 32018, 32020, 32023,
+  32026, 32029, 32032, 32034, 32037, 32040, 32043, 32046,
+  32048, 32051, 32054, 32057, 32059, 32062, 32065, 32068,
+  32071, 32073, 32076, 32079, 32082, 32085, 32087, 32090,
+  32093, 32096, 32098, 32101, 32104, 32107, 32110, 32112,
+  32115, 32118, 32121, 32123, 32126, 32129, 32132, 32134,
+  32137, 32140, 32143, 32146, 32148, 32151, 32154, 32157,
+  32159, 32162, 32165, 32168, 32171, 32173, 32176, 32179,
+  32182, 32184, 32187, 32190, 32193, 32195, 32198, 32201,
+  32204, 32206, 32209, 32212, 32215, 32217, 32220, 32223,
+  32226, 32228, 32231, 32234, 32237, 32240, 32242, 32245,
+  32248, 32251, 32253, 32256, 32259, 32262, 32264, 32267,
+  32270, 32273, 32275, 32278, 32281, 32284, 32286, 32289,
+  32292, 32295, 32297, 32300, 32303, 32306, 32308, 32311,
+  32314, 32316, 32319, 32322, 32325, 32327, 32330, 32333,
+  32336, 32338, 32341, 32344, 32347, 32349, 32352, 32355,
+  32358, 32360, 32363, 32366, 32368, 32371, 32374, 32377,
+  32379, 32382, 32385, 32388, 32390, 32393, 32396, 32399,
+  32401, 32404, 32407, 32409, 32412, 32415, 32418, 32420,
+  32423, 32426, 32428, 32431, 32434, 32437, 32439, 32442,
+  32445, 32448, 32450, 32453, 32456, 32458, 32461, 32464,
+  32467, 32469, 32472, 32475, 32477, 32480, 32483, 32486,
+  32488, 32491, 32494, 32496, 32499, 32502, 32505, 32507,
+  32510, 32513, 32515, 32518, 32521, 32524, 32526, 32529,
+  32532, 32534, 32537, 32540, 32542, 32545, 32548, 32551,
+  32553, 32556, 32559, 32561, 32564, 32567, 32569, 32572,
+  32575, 32578, 32580, 32583, 32586, 32588, 32591, 32594,
+  32596, 32599, 32602, 32605, 32607, 32610, 32613, 32615,
+  32618, 32621, 32623, 32626, 32629, 32631, 32634, 32637,
+  32639, 32642, 32645, 32648, 32650, 32653, 32656, 32658,
+  32661, 32664, 32666, 32669, 32672, 32674, 32677, 32680,
+  32682, 32685, 32688, 32690, 32693, 32696, 32699, 32701,
+  32704, 32707, 32709, 32712, 32715, 32717, 32720, 32723,
+  32725, 32728, 32731, 32733, 32736, 32739, 32741, 32744,
+  32747, 32749, 32752, 32755, 32757, 32760, 32763, 32765,
+  32768
+};
+
+#endif
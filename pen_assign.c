@@ -0,0 +1,346 @@
+#include "pen_assign.h"
+
+#include <string.h>
+
+/**
+ * @brief State of the branch and bound search
+ */
+typedef struct {
+  const PenProblem *problem;      ///< Problem being solved
+  BYTE load[ASSIGN_MAX_PENS];     ///< Loads chosen so far, by free pen slot
+  BYTE best_load[ASSIGN_MAX_PENS]; ///< Loads of the best complete assignment
+  ULONG best_cost;                ///< Total error of the best complete assignment
+  ULONG nodes;                    ///< Search nodes visited
+  UWORD open_loads;               ///< Colors the current node may still load
+} PenSearch;
+
+/**
+ * @brief Error of each color using only the pens that can never be reprogrammed
+ * @param problem Pointer to PenProblem structure
+ * @param error Receives the error of each color
+ */
+static void fixed_pen_error(const PenProblem *problem, ULONG *error)
+{
+  BOOL is_free[ASSIGN_MAX_PENS];
+  int c, p;
+
+  memset(is_free, 0, sizeof(is_free));
+  for (p = 0; p < problem->free_count; p++) {
+    is_free[problem->free_pens[p]] = TRUE;
+  }
+
+  for (c = 0; c < ASSIGN_COLORS; c++) {
+    error[c] = 0xFFFFFFFF;
+    for (p = 0; p < problem->pen_count; p++) {
+      if (!is_free[p] && problem->cost[c][p] < error[c]) {
+        error[c] = problem->cost[c][p];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Total error left after adding one pen color to a partial assignment
+ * @param error Error of each color with the pens decided so far
+ * @param cost Error of each color with the new pen, as a column stride
+ * @param stride Distance between the entries of cost
+ * @param next Receives the error of each color with the new pen, or NULL
+ * @return Reduction of the total error
+ */
+static ULONG pen_gain(const ULONG *error, const ULONG *cost, int stride, ULONG *next)
+{
+  ULONG gain = 0;
+  ULONG value;
+  int c;
+
+  for (c = 0; c < ASSIGN_COLORS; c++) {
+    value = *cost;
+    if (value < error[c]) {
+      gain += error[c] - value;
+    }
+    else {
+      value = error[c];
+    }
+    if (next) next[c] = value;
+    cost += stride;
+  }
+
+  return gain;
+}
+
+/**
+ * @brief Optimistic total error of any completion of a partial assignment
+ * Two bounds, both of which never exceed the true best completion: every
+ * remaining option added at once, and the total minus the largest gains
+ * the remaining slots could take one option each. Gains never grow as pens
+ * are added, so the second bound holds.
+ * @param search Pointer to PenSearch structure
+ * @param error Error of each color with the pens decided so far
+ * @param total Sum of error
+ * @param slot First free pen slot still undecided
+ * @param gains Gains of the options open at this node
+ * @param gain_count Number of entries in gains, sorted largest first
+ * @return Lower bound of the total error
+ */
+static ULONG lower_bound(PenSearch *search, const ULONG *error, ULONG total, int slot,
+                         const ULONG *gains, int gain_count)
+{
+  const PenProblem *problem = search->problem;
+  ULONG all_options = 0;
+  ULONG best_gains = 0;
+  ULONG best;
+  int c, j, l;
+
+  // Every remaining option at once
+  for (c = 0; c < ASSIGN_COLORS; c++) {
+    best = error[c];
+    for (j = slot; j < problem->free_count && best; j++) {
+      if (problem->cost[c][problem->free_pens[j]] < best) {
+        best = problem->cost[c][problem->free_pens[j]];
+      }
+    }
+    for (l = 0; l < ASSIGN_COLORS && best; l++) {
+      if ((search->open_loads & (1 << l)) && problem->load_cost[c][l] < best) {
+        best = problem->load_cost[c][l];
+      }
+    }
+    all_options += best;
+  }
+
+  // One option per remaining slot
+  for (j = 0; j < problem->free_count - slot && j < gain_count; j++) {
+    best_gains += gains[j];
+  }
+  if (best_gains > total) best_gains = total;
+
+  return (all_options > total - best_gains) ? all_options : total - best_gains;
+}
+
+/**
+ * @brief Decides the free pen in one slot and searches the slots after it
+ * Loaded colors are taken in increasing order, since loading the same
+ * colors into the same pens in another order gives the same error. The
+ * options are tried largest gain first so good assignments are found early.
+ * @param search Pointer to PenSearch structure
+ * @param error Error of each color with the pens decided so far
+ * @param slot Free pen slot to decide
+ * @param last_load Highest color loaded so far, or -1
+ */
+static void search_slot(PenSearch *search, const ULONG *error, int slot, int last_load)
+{
+  const PenProblem *problem = search->problem;
+  ULONG next[ASSIGN_COLORS];
+  ULONG gains[ASSIGN_COLORS + ASSIGN_MAX_PENS];
+  ULONG slot_gains[ASSIGN_COLORS + 1];
+  BYTE options[ASSIGN_COLORS + 1];
+  UWORD open_loads = search->open_loads;
+  ULONG total = 0;
+  ULONG gain;
+  int gain_count = 0;
+  int option_count = 0;
+  int c, i, j, l;
+
+  if (problem->node_limit && search->nodes >= problem->node_limit) return;
+  search->nodes++;
+
+  for (c = 0; c < ASSIGN_COLORS; c++) {
+    total += error[c];
+  }
+
+  if (slot == problem->free_count) {
+    if (total < search->best_cost) {
+      search->best_cost = total;
+      memcpy(search->best_load, search->load, sizeof(search->load));
+    }
+    return;
+  }
+
+  // Gains of keeping each remaining pen and of each color still loadable
+  search->open_loads = 0;
+  for (l = last_load + 1; l < ASSIGN_COLORS; l++) {
+    if (problem->loadable & (1 << l)) search->open_loads |= 1 << l;
+  }
+
+  for (j = slot; j < problem->free_count; j++) {
+    gain = pen_gain(error, &problem->cost[0][problem->free_pens[j]], ASSIGN_MAX_PENS, NULL);
+    if (j == slot) {
+      options[option_count] = ASSIGN_NO_LOAD;
+      slot_gains[option_count++] = gain;
+    }
+    gains[gain_count++] = gain;
+  }
+  for (l = last_load + 1; l < ASSIGN_COLORS; l++) {
+    if (!(search->open_loads & (1 << l))) continue;
+    gain = pen_gain(error, &problem->load_cost[0][l], ASSIGN_COLORS, NULL);
+    options[option_count] = (BYTE)l;
+    slot_gains[option_count++] = gain;
+    gains[gain_count++] = gain;
+  }
+
+  // Largest gains first; keeping the pen stays ahead on ties
+  for (i = 1; i < gain_count; i++) {
+    gain = gains[i];
+    for (j = i; j > 0 && gains[j - 1] < gain; j--) gains[j] = gains[j - 1];
+    gains[j] = gain;
+  }
+  for (i = 1; i < option_count; i++) {
+    BYTE option = options[i];
+    gain = slot_gains[i];
+    for (j = i; j > 0 && slot_gains[j - 1] < gain; j--) {
+      slot_gains[j] = slot_gains[j - 1];
+      options[j] = options[j - 1];
+    }
+    slot_gains[j] = gain;
+    options[j] = option;
+  }
+
+  if (lower_bound(search, error, total, slot, gains, gain_count) < search->best_cost) {
+    for (i = 0; i < option_count; i++) {
+      l = options[i];
+      if (l == ASSIGN_NO_LOAD) {
+        // A pen that helps no color is only worth keeping if nothing more
+        // is loaded; otherwise loading it instead is never worse
+        pen_gain(error, &problem->cost[0][problem->free_pens[slot]], ASSIGN_MAX_PENS, next);
+        search->load[slot] = ASSIGN_NO_LOAD;
+        search_slot(search, next, slot + 1,
+                    slot_gains[i] ? last_load : ASSIGN_COLORS - 1);
+      }
+      else {
+        pen_gain(error, &problem->load_cost[0][l], ASSIGN_COLORS, next);
+        search->load[slot] = (BYTE)l;
+        search_slot(search, next, slot + 1, l);
+      }
+    }
+  }
+
+  search->load[slot] = ASSIGN_NO_LOAD;
+  search->open_loads = open_loads;
+}
+
+/**
+ * @brief Total error of a complete choice of loads
+ * @param problem Pointer to PenProblem structure
+ * @param fixed Error of each color with the pens that are never reprogrammed
+ * @param load Load of each free pen slot, or ASSIGN_NO_LOAD
+ * @return Sum of the errors of all colors
+ */
+static ULONG assignment_cost(const PenProblem *problem, const ULONG *fixed, const BYTE *load)
+{
+  ULONG total = 0;
+  ULONG best, cost;
+  int c, j;
+
+  for (c = 0; c < ASSIGN_COLORS; c++) {
+    best = fixed[c];
+    for (j = 0; j < problem->free_count; j++) {
+      cost = (load[j] == ASSIGN_NO_LOAD) ? problem->cost[c][problem->free_pens[j]] :
+                                           problem->load_cost[c][load[j]];
+      if (cost < best) best = cost;
+    }
+    total += best;
+  }
+
+  return total;
+}
+
+/**
+ * @brief Finds a good first assignment by changing one free pen at a time
+ * Gives the exact search a tight bound to prune with from the start.
+ * @param search Pointer to PenSearch structure
+ * @param fixed Error of each color with the pens that are never reprogrammed
+ */
+static void improve_by_swaps(PenSearch *search, const ULONG *fixed)
+{
+  const PenProblem *problem = search->problem;
+  BYTE load[ASSIGN_MAX_PENS];
+  UWORD used = 0;
+  ULONG cost;
+  BOOL improved = TRUE;
+  int j, l, old;
+
+  memset(load, ASSIGN_NO_LOAD, sizeof(load));
+  search->best_cost = assignment_cost(problem, fixed, load);
+
+  while (improved) {
+    improved = FALSE;
+
+    for (j = 0; j < problem->free_count; j++) {
+      old = load[j];
+
+      for (l = ASSIGN_NO_LOAD; l < ASSIGN_COLORS; l++) {
+        if (l == old) continue;
+        if (l != ASSIGN_NO_LOAD && (!(problem->loadable & (1 << l)) || (used & (1 << l)))) continue;
+
+        load[j] = (BYTE)l;
+        cost = assignment_cost(problem, fixed, load);
+        if (cost < search->best_cost) {
+          search->best_cost = cost;
+          if (old != ASSIGN_NO_LOAD) used &= ~(1 << old);
+          if (l != ASSIGN_NO_LOAD) used |= 1 << l;
+          old = l;
+          improved = TRUE;
+        }
+        load[j] = (BYTE)old;
+      }
+    }
+  }
+
+  memset(search->best_load, ASSIGN_NO_LOAD, sizeof(search->best_load));
+  for (j = 0; j < problem->free_count; j++) {
+    search->best_load[j] = load[j];
+  }
+}
+
+/**
+ * @brief Finds the pen assignment with the lowest total error
+ * Each free pen either keeps its color or is loaded with one loadable
+ * color; every color is then drawn with the closest pen, so colors share
+ * pens wherever that costs least. The search is exact unless it reaches
+ * node_limit, in which case the best assignment found so far is returned;
+ * that is never worse than the one pen at a time improvement it starts
+ * from. At least one pen must be left out of free_pens.
+ * @param problem Pointer to PenProblem structure
+ * @param result Receives the assignment
+ */
+void solve_pen_assignment(const PenProblem *problem, PenAssignment *result)
+{
+  PenSearch search;
+  ULONG error[ASSIGN_COLORS];
+  ULONG best;
+  int c, p, j;
+
+  search.problem = problem;
+  search.best_cost = 0xFFFFFFFF;
+  search.nodes = 0;
+  search.open_loads = 0;
+  memset(search.load, ASSIGN_NO_LOAD, sizeof(search.load));
+  memset(search.best_load, ASSIGN_NO_LOAD, sizeof(search.best_load));
+
+  fixed_pen_error(problem, error);
+  improve_by_swaps(&search, error);
+  search_slot(&search, error, 0, -1);
+
+  // Loads by pen number
+  memset(result->load, ASSIGN_NO_LOAD, sizeof(result->load));
+  for (j = 0; j < problem->free_count; j++) {
+    result->load[problem->free_pens[j]] = search.best_load[j];
+  }
+
+  // Closest pen for each color under the chosen loads
+  for (c = 0; c < ASSIGN_COLORS; c++) {
+    best = 0xFFFFFFFF;
+    result->pen[c] = 0;
+    for (p = 0; p < problem->pen_count; p++) {
+      ULONG cost = (result->load[p] == ASSIGN_NO_LOAD) ?
+                   problem->cost[c][p] : problem->load_cost[c][result->load[p]];
+      if (cost < best) {
+        best = cost;
+        result->pen[c] = (UBYTE)p;
+      }
+    }
+  }
+
+  result->total_cost = search.best_cost;
+  result->nodes = search.nodes;
+  result->exact = (BOOL)(!problem->node_limit || search.nodes < problem->node_limit);
+}
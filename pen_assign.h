@@ -0,0 +1,36 @@
+#ifndef PEN_ASSIGN_H
+#define PEN_ASSIGN_H
+
+#include <exec/types.h>
+
+#define ASSIGN_COLORS 16          ///< Colors in a theme
+#define ASSIGN_MAX_PENS 16        ///< Most pens the solver handles
+#define ASSIGN_NO_LOAD -1         ///< Pen keeps its current color
+
+/**
+ * @brief Costs and constraints of assigning 16 colors to a small screen palette
+ */
+typedef struct {
+  ULONG cost[ASSIGN_COLORS][ASSIGN_MAX_PENS];     ///< Error of drawing color c with pen p as it is
+  ULONG load_cost[ASSIGN_COLORS][ASSIGN_COLORS];  ///< Error of drawing color c with a pen loaded with color l
+  UWORD pen_count;                                ///< Pens on the screen
+  UWORD loadable;                                 ///< Bit mask of colors that may be loaded into a pen
+  UBYTE free_pens[ASSIGN_MAX_PENS];               ///< Pens that may be reprogrammed
+  UWORD free_count;                               ///< Number of entries in free_pens
+  ULONG node_limit;                               ///< Search nodes to visit at most, 0 for no limit
+} PenProblem;
+
+/**
+ * @brief Assignment with the lowest total error
+ */
+typedef struct {
+  UBYTE pen[ASSIGN_COLORS];       ///< Pen each color is drawn with
+  BYTE load[ASSIGN_MAX_PENS];     ///< Color to load into each pen, or ASSIGN_NO_LOAD
+  ULONG total_cost;               ///< Sum of the errors of all colors
+  ULONG nodes;                    ///< Search nodes visited
+  BOOL exact;                     ///< FALSE if node_limit stopped the search early
+} PenAssignment;
+
+void solve_pen_assignment(const PenProblem *problem, PenAssignment *result);
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * Exhaustive check of pen_assign.c
+ *
+ * Solves random pen problems with solve_pen_assignment and compares every
+ * result with a plain enumeration of all assignments. It is a host tool
+ * and not part of the Amiga build; the host Makefile builds and runs it:
+ *
+ *   make -C host check
+ *
+ * A trial count on the command line replaces the default, which is kept
+ * short for make check; host/pen_assign_test 1000 is a longer soak.
+ *
+ * Palettes are either random or like the Workbench default, on 8 pens with
+ * none free or 16 pens with the upper 8 free. A second pass repeats the
+ * problems with a node limit, where the result must still be consistent
+ * and no better than the exhaustive one.
+ */
+
+#include <exec/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pen_assign.h"
+
+#define TRIALS 60            ///< Default trial count
+#define LIMITED_NODES 200  ///< Node limit of the second pass
+
+static PenProblem problem;
+static ULONG exhaustive_best;
+
+/**
+ * Squared RGB distance of two colors
+ */
+static ULONG distance(const int *a, const int *b)
+{
+  ULONG sum = 0;
+  int i;
+
+  for (i = 0; i < 3; i++) sum += (ULONG)((a[i] - b[i]) * (a[i] - b[i]));
+  return sum;
+}
+
+/**
+ * Enumerate every choice for the free pens from slot on
+ * Loaded colors are taken in increasing order, as loading the same set
+ * into other pens gives the same total.
+ *
+ * @param slot Index into free_pens
+ * @param error Error of each color with the pens chosen so far
+ * @param last_load Last color loaded, -1 for none
+ */
+static void enumerate(int slot, const ULONG *error, int last_load)
+{
+  ULONG next[ASSIGN_COLORS], total = 0;
+  int c, l;
+
+  if (slot == problem.free_count)
+  {
+    for (c = 0; c < ASSIGN_COLORS; c++) total += error[c];
+    if (total < exhaustive_best) exhaustive_best = total;
+    return;
+  }
+
+  for (c = 0; c < ASSIGN_COLORS; c++)
+  {
+    next[c] = error[c];
+    if (problem.cost[c][problem.free_pens[slot]] < next[c])
+    {
+      next[c] = problem.cost[c][problem.free_pens[slot]];
+    }
+  }
+  enumerate(slot + 1, next, last_load);
+
+  for (l = last_load + 1; l < ASSIGN_COLORS; l++)
+  {
+    if (!(problem.loadable & (1 << l))) continue;
+    for (c = 0; c < ASSIGN_COLORS; c++)
+    {
+      next[c] = error[c];
+      if (problem.load_cost[c][l] < next[c]) next[c] = problem.load_cost[c][l];
+    }
+    enumerate(slot + 1, next, l);
+  }
+}
+
+/**
+ * Lowest total error of any assignment
+ */
+static ULONG exhaustive_cost(void)
+{
+  ULONG error[ASSIGN_COLORS];
+  BOOL free_pen;
+  int c, p, j;
+
+  for (c = 0; c < ASSIGN_COLORS; c++)
+  {
+    error[c] = 0xFFFFFFFF;
+    for (p = 0; p < problem.pen_count; p++)
+    {
+      free_pen = FALSE;
+      for (j = 0; j < problem.free_count; j++)
+      {
+        if (problem.free_pens[j] == p) free_pen = TRUE;
+      }
+      if (!free_pen && problem.cost[c][p] < error[c]) error[c] = problem.cost[c][p];
+    }
+  }
+
+  exhaustive_best = 0xFFFFFFFF;
+  enumerate(0, error, -1);
+  return exhaustive_best;
+}
+
+/**
+ * Check that an assignment only loads allowed colors and adds up
+ *
+ * @return Total error recomputed from pen and load
+ */
+static ULONG assignment_total(const PenAssignment *result, int trial)
+{
+  ULONG total = 0;
+  int c, p;
+
+  for (c = 0; c < ASSIGN_COLORS; c++)
+  {
+    p = result->pen[c];
+    if (result->load[p] == ASSIGN_NO_LOAD)
+    {
+      total += problem.cost[c][p];
+    }
+    else
+    {
+      if (!(problem.loadable & (1 << result->load[p])))
+      {
+        printf("trial %d: pen %d loaded with color %d, which is not loadable\n",
+               trial, p, result->load[p]);
+        return 0xFFFFFFFF;
+      }
+      total += problem.load_cost[c][result->load[p]];
+    }
+  }
+  return total;
+}
+
+/**
+ * Generate the problem of one trial
+ */
+static void make_problem(int trial)
+{
+  int palette[ASSIGN_MAX_PENS][3], colors[ASSIGN_COLORS][3];
+  int c, p, depth = (trial % 3 == 0) ? 3 : 4;
+
+  problem.pen_count = (UWORD)(1 << depth);
+  problem.free_count = 0;
+  problem.loadable = (UWORD)((trial % 5 == 0) ? 0xFFFF : (rand() & 0xFFFF));
+  problem.node_limit = 0;
+
+  for (p = 0; p < ASSIGN_MAX_PENS; p++)
+  {
+    for (c = 0; c < 3; c++)
+    {
+      palette[p][c] = (trial % 2) ? rand() % 256 : ((p & (1 << c)) ? 170 : 0) + ((p & 8) ? 85 : 0);
+    }
+  }
+  for (c = 0; c < ASSIGN_COLORS; c++)
+  {
+    for (p = 0; p < 3; p++) colors[c][p] = rand() % 256;
+  }
+  for (c = 0; c < ASSIGN_COLORS; c++)
+  {
+    for (p = 0; p < problem.pen_count; p++) problem.cost[c][p] = distance(colors[c], palette[p]);
+    for (p = 0; p < ASSIGN_COLORS; p++) problem.load_cost[c][p] = distance(colors[c], colors[p]);
+  }
+  if (depth == 4)
+  {
+    for (p = 8; p < 16; p++) problem.free_pens[problem.free_count++] = (UBYTE)p;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  PenAssignment result;
+  ULONG best, total, max_nodes = 0, sum_nodes = 0;
+  int trials = (argc > 1) ? atoi(argv[1]) : TRIALS;
+  int trial, failures = 0, limited = 0;
+
+  if (trials < 1) trials = TRIALS;
+  srand(11);
+  for (trial = 0; trial < trials; trial++)
+  {
+    make_problem(trial);
+    best = exhaustive_cost();
+
+    solve_pen_assignment(&problem, &result);
+    total = assignment_total(&result, trial);
+    if (result.total_cost != best || total != best || !result.exact)
+    {
+      printf("trial %d: solver %lu, recomputed %lu, exhaustive %lu\n",
+             trial, result.total_cost, total, best);
+      failures++;
+    }
+    if (result.nodes > max_nodes) max_nodes = result.nodes;
+    sum_nodes += result.nodes;
+
+    problem.node_limit = LIMITED_NODES;
+    solve_pen_assignment(&problem, &result);
+    total = assignment_total(&result, trial);
+    if (result.total_cost < best || total != result.total_cost ||
+        (result.exact && result.total_cost != best))
+    {
+      printf("trial %d with node limit: solver %lu, recomputed %lu, exhaustive %lu\n",
+             trial, result.total_cost, total, best);
+      failures++;
+    }
+    if (!result.exact) limited++;
+  }
+
+  printf("%d trials, %d failures; search nodes average %lu, max %lu; "
+         "%d stopped by a limit of %d nodes\n",
+         trials, failures, sum_nodes / trials, max_nodes, limited, LIMITED_NODES);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,37 @@
+#ifndef THEME_STATS_H
+#define THEME_STATS_H
+
+#include <exec/types.h>
+
+#define MAX_STATS_PHASES 12       /* Phases timed by STATS */
+
+/**
+ * Elapsed time of one phase of a run, for STATS
+ */
+typedef struct PhaseTime
+{
+  const char *name;               /* Phase name */
+  ULONG micros;                   /* Elapsed microseconds */
+} PhaseTime;
+
+/**
+ * Counters collected during a run, as reported by STATS
+ */
+typedef struct RunStats
+{
+  ULONG lines_read;               /* Theme and preferences lines parsed */
+  ULONG lines_rewritten;          /* Preferences lines replaced */
+  ULONG bytes_written;            /* Bytes written to all files */
+  ULONG alloc_count;              /* alloc_mem calls that succeeded */
+  ULONG free_count;               /* free_mem calls */
+  ULONG heap_in_use;              /* Bytes allocated and not yet freed */
+  ULONG peak_heap;                /* Most bytes allocated at once */
+  const PhaseTime *phases;        /* Timed phases in run order */
+  ULONG phase_count;              /* Number of entries in phases */
+  ULONG phases_dropped;           /* Phases that did not fit in phases */
+  ULONG dropped_micros;           /* Total time of the dropped phases */
+} RunStats;
+
+VOID get_run_stats(RunStats *stats);
+
+#endif